@@ -0,0 +1,68 @@
+// Frustum culling pre-pass: every instance whose bounding sphere touches the clip volume is appended to the
+// region of `visible` of its level of detail, and the indirect draw arguments of that level count them.
+
+struct Uniforms {
+    time: f32,
+    zoom: f32,
+    pan: vec2f,
+};
+
+struct CullParams {
+    instanceCount: u32,
+    radius: f32,  // Bounding sphere radius of the mesh around its origin, rotation leaves it unchanged
+    ratio: f32,
+    lodCount: u32,
+    lodScale: f32,  // Pixels per mesh unit at zoom and scale 1 over the tolerated error in pixels
+    lodErrors: vec4f,  // Error of every level in mesh units, see MeshLodSelect
+};
+
+struct Instance {
+    offsetScale: vec4f,
+    rotation: vec4f,
+    color: vec4f,
+};
+
+struct DrawIndexedIndirect {
+    indexCount: u32,
+    instanceCount: atomic<u32>,
+    firstIndex: u32,
+    baseVertex: i32,
+    firstInstance: u32,
+};
+
+@group(0) @binding(0) var<uniform> u: Uniforms;
+@group(0) @binding(1) var<uniform> params: CullParams;
+@group(0) @binding(2) var<storage, read> instances: array<Instance>;
+@group(0) @binding(3) var<storage, read_write> visible: array<Instance>;
+@group(0) @binding(4) var<storage, read_write> draws: array<DrawIndexedIndirect>;
+
+@compute @workgroup_size(64)
+fn cs_main(@builtin(global_invocation_id) id: vec3u) {
+    let i = id.x;
+    if (i >= params.instanceCount) {
+        return;
+    }
+
+    // Same placement as vs_main, the clip volume there is |x| <= 1, |y * ratio| <= 1 and |z| <= 1.
+    let instance = instances[i];
+    let radius = params.radius * instance.offsetScale.w;
+    let center = vec3f((instance.offsetScale.xy - u.pan) * u.zoom, instance.offsetScale.z);
+    let extent = vec3f(1.0, 1.0 / params.ratio, 1.0);
+    let outside = abs(center) - vec3f(radius * u.zoom, radius * u.zoom, radius) > extent;
+    if (any(outside)) {
+        return;
+    }
+
+    // Coarsest level whose error covers at most a pixel, the selection MeshLodSelect makes on the CPU.
+    let pixelsPerUnit = instance.offsetScale.w * u.zoom * params.lodScale;
+    var lod = 0u;
+    for (var level = 1u; level < params.lodCount; level++) {
+        if (params.lodErrors[level] * pixelsPerUnit > 1.0) {
+            break;
+        }
+        lod = level;
+    }
+
+    let slot = atomicAdd(&draws[lod].instanceCount, 1u);
+    visible[lod * params.instanceCount + slot] = instance;
+}
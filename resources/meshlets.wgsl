@@ -0,0 +1,114 @@
+// Meshlet culling pass, run after cull.wgsl: every meshlet of the full mesh seen by at least one instance drawn at
+// level 0 has its indices appended to `clusterIndices`, which the render pass draws for all those instances.
+// A meshlet is seen when its bounding sphere touches the clip volume and, with cone culling on, some of its
+// triangles face the viewer.
+
+struct Uniforms {
+    time: f32,
+    zoom: f32,
+    pan: vec2f,
+};
+
+struct MeshletParams {
+    meshletCount: u32,
+    indexStride: u32,  // Bytes per index of the mesh index buffer, 2 or 4
+    ratio: f32,
+    cones: u32,  // Cull meshlets facing away, only right for closed meshes with outward facing triangles
+};
+
+struct Meshlet {
+    center: vec3f,
+    radius: f32,
+    coneAxis: vec3f,
+    coneCutoff: f32,  // Sine of the cone half angle, above 1 for cones that never face away as a whole
+    firstIndex: u32,
+    indexCount: u32,
+    vertexCount: u32,
+    padding: u32,
+};
+
+struct Instance {
+    offsetScale: vec4f,
+    rotation: vec4f,
+    color: vec4f,
+};
+
+struct DrawIndexedIndirect {
+    indexCount: u32,
+    instanceCount: u32,
+    firstIndex: u32,
+    baseVertex: i32,
+    firstInstance: u32,
+};
+
+struct ClusterDraw {
+    indexCount: atomic<u32>,
+    instanceCount: u32,
+    firstIndex: u32,
+    baseVertex: i32,
+    firstInstance: u32,
+};
+
+@group(0) @binding(0) var<uniform> u: Uniforms;
+@group(0) @binding(1) var<uniform> params: MeshletParams;
+@group(0) @binding(2) var<storage, read> meshlets: array<Meshlet>;
+@group(0) @binding(3) var<storage, read> indices: array<u32>;
+@group(0) @binding(4) var<storage, read> visible: array<Instance>;  // Level 0 region of the culling output
+@group(0) @binding(5) var<storage, read> draws: array<DrawIndexedIndirect>;  // Indirect draws of cull.wgsl
+@group(0) @binding(6) var<storage, read_write> clusterIndices: array<u32>;
+@group(0) @binding(7) var<storage, read_write> clusterDraw: ClusterDraw;
+
+// Mesh space to world space as in vs_main: the animated turn around x, then the instance rotation.
+fn rotate(p: vec3f, q: vec4f) -> vec3f {
+    let cosT = cos(u.time);
+    let sinT = sin(u.time);
+    let turned = vec3f(p.x, p.y * cosT - p.z * sinT, p.y * sinT + p.z * cosT);
+    return turned + 2.0 * cross(q.xyz, cross(q.xyz, turned) + q.w * turned);
+}
+
+fn meshletVisible(meshlet: Meshlet, instance: Instance) -> bool {
+    let scale = instance.offsetScale.w;
+    let world = rotate(meshlet.center, instance.rotation) * scale + instance.offsetScale.xyz;
+    let radius = meshlet.radius * scale;
+    let center = vec3f((world.xy - u.pan) * u.zoom, world.z);
+    let extent = vec3f(1.0, 1.0 / params.ratio, 1.0);
+    if (any(abs(center) - vec3f(radius * u.zoom, radius * u.zoom, radius) > extent)) {
+        return false;
+    }
+
+    // The view looks along +z, a cone within coneCutoff of it only holds back faces.
+    return params.cones == 0u || rotate(meshlet.coneAxis, instance.rotation).z <= meshlet.coneCutoff;
+}
+
+fn indexLoad(i: u32) -> u32 {
+    if (params.indexStride == 4u) {
+        return indices[i];
+    }
+    return (indices[i / 2u] >> ((i % 2u) * 16u)) & 0xffffu;
+}
+
+@compute @workgroup_size(64)
+fn cs_main(@builtin(global_invocation_id) id: vec3u) {
+    let m = id.x;
+    let instanceCount = draws[0].instanceCount;
+    if (m == 0u) {
+        clusterDraw.instanceCount = instanceCount;
+    }
+    if (m >= params.meshletCount) {
+        return;
+    }
+
+    let meshlet = meshlets[m];
+    var seen = false;
+    for (var i = 0u; i < instanceCount && !seen; i++) {
+        seen = meshletVisible(meshlet, visible[i]);
+    }
+    if (!seen) {
+        return;
+    }
+
+    let first = atomicAdd(&clusterDraw.indexCount, meshlet.indexCount);
+    for (var k = 0u; k < meshlet.indexCount; k++) {
+        clusterIndices[first + k] = indexLoad(meshlet.firstIndex + k);
+    }
+}
@@ -1,32 +1,52 @@
 
-@group(0) @binding(0) var<uniform> u_time: f32;
+struct Uniforms {
+    time: f32,
+    zoom: f32,  // View scale and center, shared with the culling pass in cull.wgsl
+    pan: vec2f,
+    positionScale: vec4f,  // Mesh space from quantized positions, identity for Float32x3
+    positionOffset: vec4f,
+};
+
+@group(0) @binding(0) var<uniform> u: Uniforms;
 
 struct VertexInput {
     @location(0) position: vec3f,
     @location(1) color: vec3f,
 };
 
+// xyz offset and uniform scale, rotation quaternion, rgb tint multiplied with the vertex color
+struct InstanceInput {
+    @location(2) offsetScale: vec4f,
+    @location(3) rotation: vec4f,
+    @location(4) color: vec4f,
+};
+
 struct VertexOutput {
     @builtin(position) position: vec4f,
     @location(0) color: vec3f,
 };
 
 @vertex
-fn vs_main(in: VertexInput) -> VertexOutput {
+fn vs_main(in: VertexInput, instance: InstanceInput) -> VertexOutput {
     var out: VertexOutput;
     let ratio = 800.0 / 600.0; // The width and height of the target surface
 
-    let cosT = cos(u_time);
-    let sinT = sin(u_time);
+    let local = in.position * u.positionScale.xyz + u.positionOffset.xyz;
+    let cosT = cos(u.time);
+    let sinT = sin(u.time);
     var position = vec3f(
-        in.position.x,
-        in.position.y * cosT - in.position.z * sinT,
-        in.position.y * sinT + in.position.z * cosT
+        local.x,
+        local.y * cosT - local.z * sinT,
+        local.y * sinT + local.z * cosT
     );
+    let q = instance.rotation;
+    position = position + 2.0 * cross(q.xyz, cross(q.xyz, position) + q.w * position);
+    position = position * instance.offsetScale.w + instance.offsetScale.xyz;
+    position = vec3f((position.xy - u.pan) * u.zoom, position.z);
 
     out.position = vec4f(position.x, position.y * ratio, position.z*0.5 + 0.5, 1.0);
 
-    out.color = in.color;
+    out.color = in.color * instance.color.rgb;
     return out;
 }
 
@@ -9,9 +9,18 @@
 #endif	// WEBGPU_BACKEND_WGPU
 
 #include "Application.hpp"
+#include "../scene/Frustum.hpp"
 #include "logging_macros.h"
 #include "tracy/Tracy.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <span>
+#include <thread>
 #include <vector>
 
 void onWindowResize(GLFWwindow* window, int width, int height) {
@@ -21,6 +30,17 @@ void onWindowResize(GLFWwindow* window, int width, int height) {
 	if (that != nullptr) that->onResize(width, height);
 }
 
+void onWindowRefresh(GLFWwindow* window) {
+	auto that = reinterpret_cast<Application*>(glfwGetWindowUserPointer(window));
+	if (that != nullptr) that->Invalidate();
+}
+
+// Installed before ImGui, which chains to them from its own callbacks.
+void onWindowInput(GLFWwindow* window) {
+	auto that = reinterpret_cast<Application*>(glfwGetWindowUserPointer(window));
+	if (that != nullptr) that->onInput();
+}
+
 Application::Window Application::CreateWindow(int width, int height, const char* title) {
 	ZoneScoped;
 	glfwInit();
@@ -38,6 +58,11 @@ Application::Window Application::CreateWindow(int width, int height, const char*
 
 	glfwSetWindowUserPointer(window.handle, this);
 	glfwSetFramebufferSizeCallback(window.handle, onWindowResize);
+	glfwSetWindowRefreshCallback(window.handle, onWindowRefresh);
+	glfwSetKeyCallback(window.handle, [](GLFWwindow* w, int, int, int, int) { onWindowInput(w); });
+	glfwSetMouseButtonCallback(window.handle, [](GLFWwindow* w, int, int, int) { onWindowInput(w); });
+	glfwSetCursorPosCallback(window.handle, [](GLFWwindow* w, double, double) { onWindowInput(w); });
+	glfwSetScrollCallback(window.handle, [](GLFWwindow* w, double, double) { onWindowInput(w); });
 
 	LOG_TRACE("Window created: %p", (void*)window.handle);
 	LOG_TRACE("  ~  size: %d x %d", window.width, window.height);
@@ -45,32 +70,67 @@ Application::Window Application::CreateWindow(int width, int height, const char*
 	return window;
 }
 
-bool Application::Initialize() {
+bool Application::Initialize(const Options& options) {
 	ZoneScoped;
-	int width = 800;
-	int height = 600;
-	m_window = CreateWindow(width, height, "WebGPU");
+	m_options = options;
+	snprintf(m_meshName, sizeof(m_meshName), "%s", options.mesh.c_str());
+	// A viewer left open idles until the animation is turned on from the GUI.
+	m_animate = !options.onDemand;
+	int width = options.width;
+	int height = options.height;
+
+	m_driver.device = nullptr;
+	m_driver.queue = nullptr;
 
 	WGPUInstance instance = wgpuCreateInstance(nullptr);
 	LOG_TRACE("WebGPU instance created");
 
-	RdSurface rdSurface(glfwCreateWindowWGPUSurface(instance, m_window.handle));
+	if (options.headless) {
+		m_window = {
+			.handle = nullptr,
+			.width = width,
+			.height = height,
+		};
+		m_context.InitializeHeadless(instance, options.forceFallbackAdapter, &m_driver);
+	} else {
+		m_window = CreateWindow(width, height, "WebGPU");
+		RdSurface rdSurface(glfwCreateWindowWGPUSurface(instance, m_window.handle));
+		m_context.Initialize(instance, std::move(rdSurface), &m_driver);
+	}
+	m_context.preferredPresentMode = options.presentMode;
 
-	m_driver = {
-		.device = nullptr,
-		.queue = nullptr,
-	};
+	if (m_driver.device == nullptr) {
+		LOG_ERROR("Failed to initialize the renderer context");
+		return false;
+	}
+	uint32_t maxDimension = m_context.limits.maxTextureDimension2D;
+	if (width <= 0 || height <= 0 || static_cast<uint32_t>(std::max(width, height)) > maxDimension) {
+		LOG_ERROR("Size %d x %d is outside of 1 to %u, the device's texture size limit", width, height, maxDimension);
+		return false;
+	}
 
-	m_context.Initialize(instance, std::move(rdSurface), &m_driver);
 	m_context.ConfigureSurface(width, height, m_driver.device);
+	m_driver.staging.Initialize(m_driver.device, m_driver.queue);
+	m_driver.profiler.Initialize(m_driver.device, m_context.timestampQueries);
+	m_driver.pacer.Initialize(m_driver.device, m_driver.queue, options.maxFramesInFlight);
+	m_jobs.Initialize(options.jobWorkers);
+	// Wakes the on-demand loop once a mesh is ready, like the shader watcher below.
+	m_loader.Initialize(RdAssetLoader::DEFAULT_THREADS, options.headless ? std::function<void()>() : []() { glfwPostEmptyEvent(); });
 
 	InitBuffers();
 	InitPipeline();
 
-	if (!InitGui()) {
+	if (!options.headless && !InitGui()) {
 		return false;
 	}
 
+#ifndef __EMSCRIPTEN__
+	if (!options.headless) {
+		// Wakes the on-demand loop from the watcher thread, glfwPostEmptyEvent is safe to call from any thread.
+		m_driver.ShaderWatchStart([]() { glfwPostEmptyEvent(); });
+	}
+#endif	// __EMSCRIPTEN__
+
 	LOG_INFO("Application initialized");
 	return true;
 }
@@ -101,25 +161,24 @@ bool Application::InitGui() {
 void Application::MainLoop() {
 	FrameMark;
 	ZoneScoped;
-	glfwPollEvents();
-	UpdateGui();
-
-	{
-		ZoneScopedN("Update Buffers");
-		wgpuQueueWriteBuffer(
-				m_driver.queue, m_vertexBuffer, 0, m_vertexData.data(), m_vertexData.size() * sizeof(Vertex)
-		);
-		float currentTime = static_cast<float>(glfwGetTime());
-		wgpuQueueWriteBuffer(m_driver.queue, m_uniformBuffer, 0, &currentTime, sizeof(float));
+	// Waiting before polling keeps the input of this frame from queuing behind frames the GPU has not finished.
+	m_driver.pacer.FrameWait();
+	if (!m_options.headless) {
+		glfwPollEvents();
+		UpdateGui();
 	}
+	UpdatePipeline();
+	AssetsUpdate(m_options.uploadBudget);
+	FrameUpdate();
 
 	WGPUTextureView textureView = m_context.NextTextureView();
 	if (!textureView) {
 		return;
 	}
 
-	WGPUTextureView depthStencilView = m_driver.NextDepthView(m_context.rdSurface);
+	WGPUTextureView depthStencilView = m_context.DepthView();
 	if (!depthStencilView) {
+		wgpuTextureViewRelease(textureView);
 		return;
 	}
 
@@ -128,6 +187,15 @@ void Application::MainLoop() {
 		.label = "My Encoder",
 	};
 	WGPUCommandEncoder encoder = wgpuDeviceCreateCommandEncoder(m_driver.device, &encoderDesc);
+	// Staged uploads land before the culling and render passes read them.
+	m_driver.staging.Flush(encoder);
+	m_driver.profiler.FrameBegin();
+	if (m_culling.Ready()) {
+		m_culling.Dispatch(encoder, m_driver.profiler.ComputePass("GPU Culling Pass"));
+	}
+	if (m_meshletCulling.Ready()) {
+		m_meshletCulling.Dispatch(encoder, m_driver.profiler.ComputePass("GPU Meshlet Culling Pass"));
+	}
 
 	WGPURenderPassColorAttachment colorAttachment = {
 		.nextInChain = nullptr,
@@ -167,20 +235,48 @@ void Application::MainLoop() {
 		.colorAttachments = &colorAttachment,
 		.depthStencilAttachment = &depthStencilAttachment,
 		.occlusionQuerySet = nullptr,
-		.timestampWrites = nullptr,
+		.timestampWrites = m_driver.profiler.RenderPass("GPU Render Pass"),
 	};
 	WGPURenderPassEncoder renderPass = wgpuCommandEncoderBeginRenderPass(encoder, &renderPassDesc);
 
 	{
 		ZoneScopedN("Render Pass");
 
-		wgpuRenderPassEncoderSetPipeline(renderPass, m_pipeline);
-		wgpuRenderPassEncoderSetVertexBuffer(renderPass, 0, m_vertexBuffer, 0, wgpuBufferGetSize(m_vertexBuffer));
-		wgpuRenderPassEncoderSetIndexBuffer(
-				renderPass, m_indexBuffer, WGPUIndexFormat_Uint16, 0, wgpuBufferGetSize(m_indexBuffer)
-		);
-		wgpuRenderPassEncoderSetBindGroup(renderPass, 0, m_bindGroup, 0, nullptr);
-		wgpuRenderPassEncoderDrawIndexed(renderPass, m_indexCount, 1, 0, 0, 0);
+		// Until the first compile finished there is nothing to draw the mesh with, the pass still clears.
+		if (!m_bundles.empty()) {
+			wgpuRenderPassEncoderExecuteBundles(renderPass, m_bundles.size(), m_bundles.data());
+		} else if (m_pipeline != nullptr && m_vertexBuffer != nullptr) {
+			wgpuRenderPassEncoderSetPipeline(renderPass, m_pipeline);
+			wgpuRenderPassEncoderSetVertexBuffer(renderPass, 0, m_vertexBuffer, 0, wgpuBufferGetSize(m_vertexBuffer));
+			wgpuRenderPassEncoderSetIndexBuffer(
+					renderPass, m_indexBuffer, m_indexFormat, 0, wgpuBufferGetSize(m_indexBuffer)
+			);
+			wgpuRenderPassEncoderSetBindGroup(renderPass, 0, m_bindGroup, 0, nullptr);
+			if (m_culling.Ready()) {
+				// With meshlet culling, level 0 is drawn from the meshlets that survived instead.
+				bool meshlets = m_meshletCulling.Ready();
+				m_culling.Draw(renderPass, meshlets ? 1 : 0);
+				if (meshlets) {
+					m_meshletCulling.Draw(renderPass);
+				}
+			} else if (m_cpuCulling) {
+				std::span<const RdMeshLod> lods = LodsActive();
+				uint64_t regionBytes = wgpuBufferGetSize(m_visibleBuffer) / lods.size();
+				for (uint32_t l = 0; l < lods.size(); ++l) {
+					wgpuRenderPassEncoderSetVertexBuffer(renderPass, 1, m_visibleBuffer, l * regionBytes, regionBytes);
+					wgpuRenderPassEncoderDrawIndexed(
+							renderPass, lods[l].indexCount, m_visibleCounts[l], lods[l].firstIndex, 0, 0
+					);
+				}
+			} else {
+				wgpuRenderPassEncoderSetVertexBuffer(
+						renderPass, 1, m_instanceBuffer, 0, wgpuBufferGetSize(m_instanceBuffer)
+				);
+				wgpuRenderPassEncoderDrawIndexed(
+						renderPass, m_lods[0].indexCount, static_cast<uint32_t>(m_instanceData.size()), 0, 0, 0
+				);
+			}
+		}
 
 		// Not sure how to check that FrameBuffer size is valid just in time when imgui has to be rendered.
 		// The FrameBuffer size might change in the middle of the frame, after glfwPollEvents() is called.
@@ -191,7 +287,7 @@ void Application::MainLoop() {
 		// without checking the window size every frame.
 		// I tried storing a skipFrame bool in the class and adding two glfwPollEvents() calls, one to configure
 		// the surface when possible, and the other to check if the FrameBuffer size is valid. But it didn't work.
-		{
+		if (!m_options.headless) {
 			ZoneScopedN("FrameBuffer size check");
 			int currentWidth, currentHeight;
 			glfwGetFramebufferSize(m_window.handle, &currentWidth, &currentHeight);
@@ -203,6 +299,8 @@ void Application::MainLoop() {
 		wgpuRenderPassEncoderEnd(renderPass);
 		wgpuRenderPassEncoderRelease(renderPass);
 
+		m_driver.profiler.Resolve(encoder);
+
 		WGPUCommandBufferDescriptor commandBufferDesc = {
 			.nextInChain = nullptr,
 			.label = "My Command Buffer",
@@ -210,17 +308,42 @@ void Application::MainLoop() {
 		WGPUCommandBuffer commandBuffer = wgpuCommandEncoderFinish(encoder, &commandBufferDesc);
 		wgpuCommandEncoderRelease(encoder);
 
-		wgpuQueueSubmit(m_driver.queue, 1, &commandBuffer);
+		m_driver.pacer.Submit(commandBuffer);
 		wgpuCommandBufferRelease(commandBuffer);
+		m_driver.staging.FrameSubmitted();
+		m_driver.profiler.FrameSubmitted();
 	}
 
 	wgpuTextureViewRelease(textureView);
-	wgpuTextureViewRelease(depthStencilView);
-#ifndef __EMSCRIPTEN__
-	wgpuSurfacePresent(m_context.rdSurface.surface);
-#endif
+	m_context.Present();
+	m_driver.pacer.Presented();
 
 	m_context.Polltick(m_driver.device);
+	if (m_redrawFrames > 0) {
+		--m_redrawFrames;
+	}
+}
+
+// @brief Sleep in glfwWaitEventsTimeout until input, a resize, an edit, a finished compile or load or the animation
+// asks for a frame. While a pipeline compiles the loop wakes up often to poll it, otherwise it only wakes on events:
+// the loader posts one once a mesh is queued, which is then taken by the frame this returns for.
+void Application::RedrawWait() {
+	ZoneScoped;
+	if (!m_options.onDemand || m_options.headless) {
+		return;
+	}
+	while (m_redrawFrames == 0 && !m_animate && isRunning()) {
+		glfwWaitEventsTimeout(m_pipelineRequest != 0 ? PENDING_WAIT_SECONDS : IDLE_WAIT_SECONDS);
+		m_context.Polltick(m_driver.device);
+		UpdatePipeline();
+		if (m_loader.Ready()) {
+			Invalidate();
+		}
+	}
+}
+
+void Application::Invalidate() {
+	m_redrawFrames = REDRAW_FRAMES;
 }
 
 void Application::onResize(const int& width, const int& height) {
@@ -230,13 +353,20 @@ void Application::onResize(const int& width, const int& height) {
 	m_context.ConfigureSurface(width, height, m_driver.device);
 	m_window.width = width;
 	m_window.height = height;
+	m_culling.LodScaleSet(m_driver.staging, LodScale());
+	Invalidate();
+}
+
+void Application::onInput() {
+	m_driver.pacer.InputReceived();
+	Invalidate();
 }
 
 void Application::InitPipeline() {
 	ZoneScoped;
 
-	m_bindGroupLayout = m_driver.BindGroupLayoutCreate();
-	m_bindGroup = m_driver.BindGroupCreate(m_bindGroupLayout, m_uniformBuffer);
+	m_bindGroupLayout = m_driver.BindGroupLayoutCreate(sizeof(FrameUniforms));
+	m_bindGroup = m_driver.BindGroupCreate(m_bindGroupLayout, m_uniformBuffer, sizeof(FrameUniforms));
 
 	WGPUPipelineLayoutDescriptor pipelineLayoutDesc = {
 		.nextInChain = nullptr,
@@ -246,11 +376,40 @@ void Application::InitPipeline() {
 	};
 	m_pipelineLayout = wgpuDeviceCreatePipelineLayout(m_driver.device, &pipelineLayoutDesc);
 
-	m_pipeline = m_driver.PipelineCreate(m_context.rdSurface, m_pipelineLayout);
+	m_pipeline = nullptr;
+	m_pipelineDesc = m_driver.PipelineDescMesh(m_context.rdSurface, m_options.vertexFormat);
+	m_pipelineRequest = m_driver.PipelineRequest(m_pipelineDesc, m_pipelineLayout);
+
+	// Benchmarks measure steady frames, so headless runs wait for the first pipeline instead of drawing without.
+	while (m_options.headless && m_pipelineRequest != 0) {
+		m_context.Polltick(m_driver.device, true);
+		UpdatePipeline();
+	}
 
 	LOG_INFO("Pipeline initialized");
 }
 
+// @brief Recompile when the shader changed on disk and swap in finished compiles.
+// The previous pipeline keeps drawing meanwhile, and stays when the new source fails to compile.
+void Application::UpdatePipeline() {
+	ZoneScoped;
+	for (const std::string& name : m_driver.ShadersChanged()) {
+		if (name == m_pipelineDesc.shader) {
+			LOG_INFO("Shader changed, recompiling: %s", name.c_str());
+			m_pipelineRequest = m_driver.PipelineRequest(m_pipelineDesc, m_pipelineLayout);
+		}
+	}
+
+	WGPURenderPipeline pipeline = nullptr;
+	if (m_pipelineRequest != 0 && m_driver.PipelineReady(m_pipelineRequest, pipeline)) {
+		m_pipelineRequest = 0;
+		if (pipeline != nullptr) {
+			m_pipeline = pipeline;
+			Invalidate();
+		}
+	}
+}
+
 void Application::UpdateGui() {
 	ZoneScoped;
 	ImGui_ImplWGPU_NewFrame();
@@ -262,86 +421,690 @@ void Application::UpdateGui() {
 			char label[64];
 			snprintf(label, sizeof(label), "Vertex %zu", i);
 			if (ImGui::TreeNode(label)) {
-				ImGui::SliderFloat3("Position", &m_vertexData[i].position.x, -1.0f, 1.0f);
-				ImGui::ColorPicker3("Color", &m_vertexData[i].color.r);
+				bool changed = ImGui::SliderFloat3("Position", &m_vertexData[i].position.x, -1.0f, 1.0f);
+				changed |= ImGui::ColorPicker3("Color", &m_vertexData[i].color.r);
+				if (changed) {
+					VertexDataChanged(i, 1);
+				}
 				ImGui::TreePop();
 			}
 		}
 	}
 	ImGui::End();
 
+	if (ImGui::Begin("View")) {
+		ImGui::SliderFloat("Zoom", &m_uniforms.zoom, 0.1f, 10.0f);
+		ImGui::SliderFloat2("Pan", &m_uniforms.pan.x, -1.0f, 1.0f);
+		ImGui::Checkbox("Animate", &m_animate);
+		float lodThreshold = m_options.lodThreshold;
+		if (ImGui::SliderFloat("LOD error (px)", &lodThreshold, 0.0f, 8.0f)) {
+			LodThresholdSet(lodThreshold);
+		}
+		ImGui::InputText("Mesh", m_meshName, sizeof(m_meshName));
+		ImGui::SameLine();
+		if (ImGui::Button("Load")) {
+			MeshRequest(m_meshName);
+		}
+		if (m_meshUpload != nullptr) {
+			ImGui::ProgressBar(static_cast<float>(m_uploadStep) / static_cast<float>(m_meshUpload->steps.size()));
+		}
+	}
+	ImGui::End();
+
 	// Render ImGui
 	ImGui::EndFrame();
 	ImGui::Render();
 }
 
+// @brief Create what the draws need besides the mesh and request the mesh itself, it streams in over the next
+// frames. Headless runs measure a complete mesh, they wait for it instead.
 void Application::InitBuffers() {
 	ZoneScoped;
-	bool loadGeometryQuery = m_driver.GeometryLoad("pyramid.txt", m_vertexData, m_indexData);
-	if (!loadGeometryQuery) {
-		LOG_ERROR("Failed to load geometry");
+	WGPUBufferDescriptor uniformBufferDesc = {
+		.nextInChain = nullptr,
+		.label = "My Uniform Buffer",
+		.usage = WGPUBufferUsage_Uniform | WGPUBufferUsage_CopyDst,
+		.size = sizeof(FrameUniforms),
+		.mappedAtCreation = false,
+	};
+
+	m_uniformBuffer = wgpuDeviceCreateBuffer(m_driver.device, &uniformBufferDesc);
+
+	m_uniforms = {
+		.time = 1.0f,
+		.zoom = 1.0f,
+		.pan = glm::vec2(0.0f),
+		.positionScale = glm::vec4(1.0f, 1.0f, 1.0f, 0.0f),
+		.positionOffset = glm::vec4(0.0f),
+	};
+	wgpuQueueWriteBuffer(m_driver.queue, m_uniformBuffer, 0, &m_uniforms, sizeof(FrameUniforms));
+
+	// No mesh until the loader delivers one, an empty level 0 keeps the culling passes bindable meanwhile.
+	m_vertexBuffer = nullptr;
+	m_indexBuffer = nullptr;
+	m_indexFormat = WGPUIndexFormat_Uint16;
+	m_lods = { { 0, 0, 0.0f } };
+	m_meshRadius = 0.0f;
+
+	if (m_options.culling == Options::Culling::Gpu
+		&& !(m_context.computeCulling && m_culling.Initialize(m_driver, m_uniformBuffer))) {
+		LOG_WARN("GPU culling unavailable, culling instances on the CPU");
+	}
+	if (m_options.meshletCulling
+		&& !(m_culling.pipeline != nullptr && m_meshletCulling.Initialize(m_driver, m_uniformBuffer))) {
+		LOG_WARN("Meshlet culling needs GPU culling, drawing whole meshes");
 	}
 
-	m_indexCount = static_cast<uint32_t>(m_indexData.size());
+	m_instanceBuffer = nullptr;
+	m_visibleBuffer = nullptr;
+	m_visibleIndirect = nullptr;
+	std::fill(std::begin(m_visibleCounts), std::end(m_visibleCounts), 0u);
+	InstancesSet(m_options.instanceCount);
 
-	WGPUBufferDescriptor vertexBufferDesc = {
+	MeshRequest(m_options.mesh);
+	while (m_options.headless && m_loader.Pending() > 0) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		AssetsUpdate(0);
+	}
+
+	LOG_INFO("Buffers initialized");
+}
+
+// @brief Load p_name from the resource directory on the loader threads, it replaces the current mesh once loaded
+void Application::MeshRequest(const std::string& p_name) {
+	ZoneScoped;
+	m_loader.Request({
+		.path = m_driver.ResourcePath(p_name),
+		.vertexFormat = m_options.vertexFormat,
+		.meshlets = m_meshletCulling.pipeline != nullptr,
+	});
+	Invalidate();
+}
+
+// @brief Render thread, once a frame: take the meshes the loader finished and stream the current one.
+// Only the newest of several finished meshes is kept, the others would be replaced before they were drawn.
+void Application::AssetsUpdate(uint64_t p_budget) {
+	ZoneScoped;
+	std::unique_ptr<RdLoadedMesh> newest;
+	while (std::unique_ptr<RdLoadedMesh> mesh = m_loader.Poll()) {
+		if (!mesh->loaded) {
+			LOG_ERROR("Failed to load mesh %s, keeping the current one", mesh->request.path.string().c_str());
+			continue;
+		}
+		newest = std::move(mesh);
+	}
+	if (newest != nullptr) {
+		MeshSet(std::move(newest));
+	}
+	MeshUpload(p_budget);
+	TracyPlot("Asset queue depth", static_cast<int64_t>(m_loader.Pending()));
+}
+
+// @brief Replace the mesh with p_mesh. Its buffers start zeroed and fill in through MeshUpload(), indices not
+// uploaded yet all point at vertex 0, so the draws, culled ones included, run unchanged on the partial mesh.
+void Application::MeshSet(std::unique_ptr<RdLoadedMesh> p_mesh) {
+	ZoneScoped;
+	BundlesRelease();
+	for (WGPUBuffer* buffer : { &m_vertexBuffer, &m_indexBuffer }) {
+		if (*buffer != nullptr) {
+			wgpuBufferRelease(*buffer);
+			*buffer = nullptr;
+		}
+	}
+
+	m_vertexData = std::move(p_mesh->vertices);
+	m_vertexPacked = std::move(p_mesh->vertexBytes);
+	m_vertexDequant = p_mesh->dequant;
+	m_vertexDirty.Clear();
+	m_indexFormat = IndexFormatToWGPU(p_mesh->indices.format);
+	m_lods = std::move(p_mesh->lods);
+	m_meshletIndices = std::move(p_mesh->meshletIndices);
+	m_meshlets = std::move(p_mesh->meshlets);
+	m_meshRadius = p_mesh->radius;
+	m_uniforms.positionScale = glm::vec4(m_vertexDequant.scale, 0.0f);
+	m_uniforms.positionOffset = glm::vec4(m_vertexDequant.offset, 0.0f);
+
+	WGPUBufferDescriptor vertexDesc = {
 		.nextInChain = nullptr,
 		.label = "My Vertex Buffer",
 		.usage = WGPUBufferUsage_Vertex | WGPUBufferUsage_CopyDst,
-		.size = m_vertexData.size() * sizeof(Vertex),
+		.size = (m_vertexPacked.size() + 3) & ~uint64_t(3),
 		.mappedAtCreation = false,
 	};
-	vertexBufferDesc.size = (vertexBufferDesc.size + 3) & ~3;
-
-	WGPUBufferDescriptor indexBufferDesc = {
+	m_vertexBuffer = wgpuDeviceCreateBuffer(m_driver.device, &vertexDesc);
+	// Meshlet culling reads the mesh indices in a compute pass.
+	WGPUBufferUsageFlags indexUsage = WGPUBufferUsage_Index | WGPUBufferUsage_CopyDst
+			| (m_meshlets.empty() ? WGPUBufferUsage_None : WGPUBufferUsage_Storage);
+	WGPUBufferDescriptor indexDesc = {
 		.nextInChain = nullptr,
 		.label = "My Index Buffer",
-		.usage = WGPUBufferUsage_Index | WGPUBufferUsage_CopyDst,
-		.size = m_indexData.size() * sizeof(uint16_t),
+		.usage = indexUsage,
+		.size = p_mesh->indices.bytes.size(),
 		.mappedAtCreation = false,
 	};
-	indexBufferDesc.size = (indexBufferDesc.size + 3) & ~3;
+	m_indexBuffer = wgpuDeviceCreateBuffer(m_driver.device, &indexDesc);
+	LOG_INFO("Vertex format: %u bytes per vertex, %zu bytes", m_options.vertexFormat.Stride(), m_vertexPacked.size());
 
-	WGPUBufferDescriptor uniformBufferDesc = {
-		.nextInChain = nullptr,
-		.label = "My Uniform Buffer",
-		.usage = WGPUBufferUsage_Uniform | WGPUBufferUsage_CopyDst,
-		.size = 4 * sizeof(float),
-		.mappedAtCreation = false,
+	// Rebinds the culling passes to the new levels and buffers.
+	InstancesSet(static_cast<uint32_t>(m_instanceData.size()));
+
+	m_meshUpload = std::move(p_mesh);
+	m_uploadStep = 0;
+	m_uploadedVertexBytes = 0;
+	m_uploadedIndexBytes = 0;
+}
+
+// @brief Stage the next upload steps of the streaming mesh, at most p_budget bytes of them and at least one step,
+// 0 for all of them. The vertices a step needs are copied along with its indices, in the same flush.
+void Application::MeshUpload(uint64_t p_budget) {
+	ZoneScoped;
+	[[maybe_unused]] uint64_t uploaded = 0;
+	if (m_meshUpload != nullptr) {
+		const std::vector<RdUploadStep>& steps = m_meshUpload->steps;
+		RdUploadStep end = { m_uploadedVertexBytes, m_uploadedIndexBytes };
+		size_t step = m_uploadStep;
+		for (; step < steps.size(); ++step) {
+			uint64_t bytes = steps[step].vertexBytes - m_uploadedVertexBytes + steps[step].indexBytes - m_uploadedIndexBytes;
+			if (step > m_uploadStep && p_budget != 0 && bytes > p_budget) {
+				break;
+			}
+			end = steps[step];
+		}
+
+		if (end.vertexBytes > m_uploadedVertexBytes) {
+			m_driver.staging.Upload(
+					m_vertexBuffer,
+					m_uploadedVertexBytes,
+					m_vertexPacked.data() + m_uploadedVertexBytes,
+					end.vertexBytes - m_uploadedVertexBytes
+			);
+		}
+		if (end.indexBytes > m_uploadedIndexBytes) {
+			m_driver.staging.Upload(
+					m_indexBuffer,
+					m_uploadedIndexBytes,
+					m_meshUpload->indices.bytes.data() + m_uploadedIndexBytes,
+					end.indexBytes - m_uploadedIndexBytes
+			);
+		}
+		uploaded = end.vertexBytes - m_uploadedVertexBytes + end.indexBytes - m_uploadedIndexBytes;
+		m_uploadStep = step;
+		m_uploadedVertexBytes = end.vertexBytes;
+		m_uploadedIndexBytes = end.indexBytes;
+		Invalidate();
+
+		if (m_uploadStep == steps.size()) {
+			LOG_INFO("Mesh uploaded: %s", m_meshUpload->request.path.string().c_str());
+			m_meshUpload.reset();
+		}
+	}
+	TracyPlot("Asset bytes uploaded", static_cast<int64_t>(uploaded));
+}
+
+// @brief Lay count copies of the mesh out on a square grid filling the view, a single one keeps the original size.
+// Every fourth copy orbits the previous one instead of taking its own cell, so the scene has a hierarchy.
+void Application::InstancesSet(uint32_t count) {
+	ZoneScoped;
+	count = std::max(count, 1u);
+	Invalidate();
+	uint32_t side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+	float cell = 2.0f / static_cast<float>(side);
+
+	m_scene.Clear();
+	m_scene.Reserve(count);
+	for (uint32_t i = 0; i < count; ++i) {
+		uint32_t column = i % side;
+		uint32_t row = i / side;
+		// Cheap hash so neighbouring instances get visibly different tints and speeds.
+		uint32_t hash = (i + 1) * 2654435761u;
+		glm::vec4 color = count == 1 ? glm::vec4(1.0f)
+									 : glm::vec4(0.5f + static_cast<float>(hash & 0xff) / 510.0f,
+												 0.5f + static_cast<float>((hash >> 8) & 0xff) / 510.0f,
+												 0.5f + static_cast<float>((hash >> 16) & 0xff) / 510.0f, 1.0f);
+		if (count == 1) {
+			m_scene.Add(RdScene::NO_PARENT, glm::vec3(0.0f), glm::quat(1.0f, 0.0f, 0.0f, 0.0f), 1.0f, 0.0f, color);
+		} else if (i % 4 == 3) {
+			m_scene.Add(i - 1, glm::vec3(1.2f, 0.0f, 0.0f), glm::quat(1.0f, 0.0f, 0.0f, 0.0f), 0.4f, 1.0f, color);
+		} else {
+			glm::vec3 position(-1.0f + cell * (static_cast<float>(column) + 0.5f),
+							   -1.0f + cell * (static_cast<float>(row) + 0.5f), 0.0f);
+			float spin = 0.25f + static_cast<float>(hash >> 24) / 255.0f;
+			m_scene.Add(RdScene::NO_PARENT, position, glm::quat(1.0f, 0.0f, 0.0f, 0.0f), cell * 0.3f, spin, color);
+		}
+	}
+
+	m_instanceData.resize(count);
+	m_instanceBounds.Resize(count);
+	m_scene.Update(m_uniforms.time, m_meshRadius, m_jobs, m_instanceData.data(), &m_instanceBounds);
+
+	if (m_instanceBuffer != nullptr) {
+		wgpuBufferRelease(m_instanceBuffer);
+	}
+	m_instanceBuffer = m_driver.BufferCreate(
+			WGPUBufferUsage_Vertex | WGPUBufferUsage_Storage | WGPUBufferUsage_CopyDst,
+			m_instanceData.data(),
+			m_instanceData.size() * sizeof(Instance),
+			"Instance Buffer"
+	);
+	CullingBind();
+
+	// Released buffers may hand their address to new ones, so the key alone cannot tell the bundles are stale.
+	BundlesRelease();
+	for (WGPUBuffer* buffer : { &m_visibleBuffer, &m_visibleIndirect }) {
+		if (*buffer != nullptr) {
+			wgpuBufferRelease(*buffer);
+			*buffer = nullptr;
+		}
+	}
+	if (m_cpuCulling) {
+		// A region per level of detail, each large enough for every instance.
+		std::span<const RdMeshLod> lods = LodsActive();
+		WGPUBufferDescriptor visibleDesc = {
+			.nextInChain = nullptr,
+			.label = "Visible Instances",
+			.usage = WGPUBufferUsage_Vertex | WGPUBufferUsage_CopyDst,
+			.size = m_instanceData.size() * sizeof(Instance) * lods.size(),
+			.mappedAtCreation = false,
+		};
+		m_visibleBuffer = wgpuDeviceCreateBuffer(m_driver.device, &visibleDesc);
+		// Only the instance counts change, InstancesCull() uploads them every frame.
+		std::vector<uint32_t> indirect;
+		for (const RdMeshLod& lod : lods) {
+			indirect.insert(indirect.end(), { lod.indexCount, 0, lod.firstIndex, 0, 0 });
+		}
+		m_visibleIndirect = m_driver.BufferCreate(
+				WGPUBufferUsage_Indirect | WGPUBufferUsage_CopyDst,
+				indirect.data(),
+				indirect.size() * sizeof(uint32_t),
+				"Visible Indirect Draw"
+		);
+		m_instanceBvh.Build(m_instanceBounds);
+	}
+	LOG_INFO("Instances: %u", count);
+}
+
+// @brief Point the culling pass at the current instances, the CPU takes over when they do not fit a storage binding
+void Application::CullingBind() {
+	ZoneScoped;
+	bool gpu = m_culling.pipeline != nullptr
+			&& m_culling.InstancesBind(
+					m_driver,
+					m_instanceBuffer,
+					static_cast<uint32_t>(m_instanceData.size()),
+					LodsActive(),
+					m_meshRadius,
+					LodScale(),
+					m_context.limits.maxStorageBufferBindingSize
+			);
+	m_cpuCulling = !gpu && m_options.culling != Options::Culling::None;
+
+	if (m_meshletCulling.pipeline != nullptr) {
+		m_meshletCulling.MeshletsBind(
+				m_driver,
+				m_meshlets,
+				m_indexBuffer,
+				m_indexFormat == WGPUIndexFormat_Uint16 ? 2 : 4,
+				m_culling,
+				m_options.meshletCones,
+				m_context.limits.maxStorageBufferBindingSize
+		);
+	}
+}
+
+// @brief CPU work of a frame as a job graph: animation, culling, uploads and recording the draws.
+// The staging ring is not thread safe, every node using it depends on the one before that does. Without CPU
+// culling the transforms are written straight into staging memory, otherwise into m_instanceData along with
+// the bounds the BVH is refitted to, and only the visible instances are uploaded.
+void Application::FrameUpdate() {
+	ZoneScoped;
+	auto now = std::chrono::steady_clock::now();
+	if (m_animate) {
+		float step = std::chrono::duration<float>(now - m_lastFrameTime).count();
+		m_animationTime += std::min(step, MAX_ANIMATION_STEP);
+	}
+	m_lastFrameTime = now;
+	float time = m_animationTime;
+	m_uniforms.time = time;
+
+	Instance* instances = m_instanceData.data();
+	RdStagingSlice slice = {};
+	if (!m_cpuCulling) {
+		slice = m_driver.staging.Allocate(m_instanceData.size() * sizeof(Instance));
+		instances = static_cast<Instance*>(slice.data);
+	}
+
+	auto uploadsJob = [this]() {
+		[[maybe_unused]] uint64_t uploaded = m_driver.BufferUploadDirty(
+				m_vertexBuffer, m_vertexPacked.data(), m_vertexPacked.size(), m_vertexDirty
+		);
+		TracyPlot("Vertex bytes uploaded", static_cast<int64_t>(uploaded));
+		m_driver.staging.Upload(m_uniformBuffer, 0, &m_uniforms, sizeof(FrameUniforms));
+	};
+	// The draws stay the same from frame to frame, recording them again is only needed after something changed.
+	BundleKey bundleKey = BundleKeyCurrent();
+	bool bundlesRecord = m_options.renderBundles && m_pipeline != nullptr && m_vertexBuffer != nullptr
+			&& (m_bundles.empty() || bundleKey != m_bundleKey);
+	auto bundlesJob = [this, bundleKey]() {
+		BundlesRecord();
+		m_bundleKey = bundleKey;
 	};
 
-	m_vertexBuffer = wgpuDeviceCreateBuffer(m_driver.device, &vertexBufferDesc);
-	m_indexBuffer = wgpuDeviceCreateBuffer(m_driver.device, &indexBufferDesc);
-	m_uniformBuffer = wgpuDeviceCreateBuffer(m_driver.device, &uniformBufferDesc);
+	RdJobGraph graph;
+	RdJobGraph::Node transforms = graph.Add("Transforms", [this, time, instances]() {
+		m_scene.Update(time, m_meshRadius, m_jobs, instances, m_cpuCulling ? &m_instanceBounds : nullptr);
+	});
+	RdJobGraph::Node refit = transforms;
+	if (m_cpuCulling) {
+		refit = graph.Add("BVH Refit", [this]() {
+			m_instanceBvh.UpdateAll(m_instanceBounds);
+		}, { transforms });
+	}
+	if (m_context.parallelEncoding) {
+		RdJobGraph::Node last = graph.Add("Uploads", uploadsJob);
+		if (m_cpuCulling) {
+			last = graph.Add("Cull", [this]() { InstancesCull(); }, { refit, last });
+		}
+		if (bundlesRecord) {
+			graph.Add("Record Bundles", bundlesJob, { last });
+		}
+		graph.Run(m_jobs);
+	} else {
+		// Without implicit synchronization a Dawn device must stay on one thread. The staging pages and bundle
+		// encoders are device calls, so those jobs run here once the transforms are done.
+		graph.Run(m_jobs);
+		uploadsJob();
+		if (m_cpuCulling) {
+			InstancesCull();
+		}
+		if (bundlesRecord) {
+			bundlesJob();
+		}
+	}
 
-	wgpuQueueWriteBuffer(m_driver.queue, m_vertexBuffer, 0, m_vertexData.data(), vertexBufferDesc.size);
-	wgpuQueueWriteBuffer(m_driver.queue, m_indexBuffer, 0, m_indexData.data(), indexBufferDesc.size);
+	if (!m_cpuCulling) {
+		m_driver.staging.CopyQueue(slice, m_instanceBuffer, 0);
+	}
+}
 
-	float currentTime = 1.0f;
-	wgpuQueueWriteBuffer(m_driver.queue, m_uniformBuffer, 0, &currentTime, sizeof(float));
+// @brief The clip transform of vs_main in triangles.wgsl as a matrix
+static glm::mat4 ViewProjection(float p_zoom, glm::vec2 p_pan) {
+	const float ratio = 800.0f / 600.0f;
+	glm::mat4 matrix(1.0f);
+	matrix[0][0] = p_zoom;
+	matrix[1][1] = p_zoom * ratio;
+	matrix[2][2] = 0.5f;
+	matrix[3] = glm::vec4(-p_pan.x * p_zoom, -p_pan.y * p_zoom * ratio, 0.5f, 1.0f);
+	return matrix;
+}
 
-	LOG_INFO("Buffers initialized");
+// @brief Collect the instances in view through the BVH, pick their level of detail and gather every level
+// straight into its part of a staging slice, which is copied to the region of that level
+void Application::InstancesCull() {
+	ZoneScoped;
+	RdFrustum frustum = RdFrustum::FromMatrix(ViewProjection(m_uniforms.zoom, m_uniforms.pan));
+	m_visibleIds.clear();
+	m_instanceBvh.Cull(frustum, m_visibleIds);
+	uint32_t visibleCount = static_cast<uint32_t>(m_visibleIds.size());
+	TracyPlot("Visible instances", static_cast<int64_t>(visibleCount));
+
+	std::span<const RdMeshLod> lods = LodsActive();
+	float lodScale = m_uniforms.zoom * LodScale();
+	m_visibleLods.resize(visibleCount);
+	std::fill(std::begin(m_visibleCounts), std::end(m_visibleCounts), 0u);
+	for (uint32_t i = 0; i < visibleCount; ++i) {
+		uint32_t lod = MeshLodSelect(lods, m_instanceData[m_visibleIds[i]].scale * lodScale);
+		m_visibleLods[i] = static_cast<uint8_t>(lod);
+		m_visibleCounts[lod]++;
+	}
+
+	uint32_t firsts[RD_MESH_MAX_LODS] = {};
+	int64_t triangles = 0;
+	for (uint32_t l = 0; l < lods.size(); ++l) {
+		firsts[l] = l == 0 ? 0 : firsts[l - 1] + m_visibleCounts[l - 1];
+		triangles += static_cast<int64_t>(m_visibleCounts[l]) * (lods[l].indexCount / 3);
+		m_driver.staging.Upload(
+				m_visibleIndirect, l * INDIRECT_DRAW_SIZE + sizeof(uint32_t), &m_visibleCounts[l], sizeof(uint32_t)
+		);
+	}
+	TracyPlot("Triangles drawn", triangles);
+	if (visibleCount == 0) {
+		return;
+	}
+
+	RdStagingSlice slice = m_driver.staging.Allocate(visibleCount * sizeof(Instance));
+	Instance* visible = static_cast<Instance*>(slice.data);
+	uint32_t cursors[RD_MESH_MAX_LODS];
+	std::copy(std::begin(firsts), std::end(firsts), cursors);
+	for (uint32_t i = 0; i < visibleCount; ++i) {
+		visible[cursors[m_visibleLods[i]]++] = m_instanceData[m_visibleIds[i]];
+	}
+
+	uint64_t regionBytes = m_instanceData.size() * sizeof(Instance);
+	for (uint32_t l = 0; l < lods.size(); ++l) {
+		if (m_visibleCounts[l] == 0) {
+			continue;
+		}
+		uint64_t offset = firsts[l] * sizeof(Instance);
+		RdStagingSlice part = {
+			.data = static_cast<std::byte*>(slice.data) + offset,
+			.buffer = slice.buffer,
+			.offset = slice.offset + offset,
+			.size = m_visibleCounts[l] * sizeof(Instance),
+		};
+		m_driver.staging.CopyQueue(part, m_visibleBuffer, l * regionBytes);
+	}
+}
+
+std::span<const RdMeshLod> Application::LodsActive() const {
+	bool enabled = m_options.lodThreshold > 0.0f && m_options.culling != Options::Culling::None;
+	return std::span<const RdMeshLod>(m_lods).first(enabled ? m_lods.size() : 1);
+}
+
+// Positions are scaled by zoom into clip space, which spans the surface width over 2 units.
+float Application::LodScale() const {
+	if (m_options.lodThreshold <= 0.0f) {
+		return 0.0f;
+	}
+	return static_cast<float>(m_window.width) * 0.5f / m_options.lodThreshold;
+}
+
+void Application::LodThresholdSet(float threshold) {
+	ZoneScoped;
+	size_t levels = LodsActive().size();
+	m_options.lodThreshold = std::max(threshold, 0.0f);
+	Invalidate();
+	if (LodsActive().size() != levels) {
+		// The number of levels sizes the visible instance buffers.
+		InstancesSet(static_cast<uint32_t>(m_instanceData.size()));
+	} else {
+		m_culling.LodScaleSet(m_driver.staging, LodScale());
+	}
+}
+
+uint64_t Application::TrianglesSelected() const {
+	std::span<const RdMeshLod> lods = LodsActive();
+	float lodScale = m_uniforms.zoom * LodScale();
+	uint64_t triangles = 0;
+	for (const Instance& instance : m_instanceData) {
+		triangles += lods[MeshLodSelect(lods, instance.scale * lodScale)].indexCount / 3;
+	}
+	return triangles;
+}
+
+// @brief Every mutation of m_vertexData has to report the vertices it touched, only those are uploaded
+// A vertex moved out of the quantization range requantizes the whole mesh against its new bounds.
+void Application::VertexDataChanged(size_t first, size_t count) {
+	const RdVertexFormat& vertexFormat = m_options.vertexFormat;
+	for (size_t i = first; i < first + count; ++i) {
+		if (!VertexDequantCovers(vertexFormat.position, m_vertexDequant, m_vertexData[i].position)) {
+			m_vertexDequant = VertexDequantCompute(vertexFormat.position, m_vertexData);
+			m_uniforms.positionScale = glm::vec4(m_vertexDequant.scale, 0.0f);
+			m_uniforms.positionOffset = glm::vec4(m_vertexDequant.offset, 0.0f);
+			first = 0;
+			count = m_vertexData.size();
+			break;
+		}
+	}
+
+	uint32_t stride = vertexFormat.Stride();
+	VertexEncode(
+			vertexFormat,
+			m_vertexDequant,
+			std::span<const Vertex>(m_vertexData).subspan(first, count),
+			m_vertexPacked.data() + first * stride
+	);
+	m_vertexDirty.Mark(first * stride, count * stride);
+	Invalidate();
+
+	// The culling bounds only ever grow, a vertex moved inwards leaves them conservative.
+	float radius = m_meshRadius;
+	for (size_t i = first; i < first + count; ++i) {
+		radius = std::max(radius, glm::length(m_vertexData[i].position) + m_vertexDequant.error);
+	}
+	if (radius > m_meshRadius) {
+		m_meshRadius = radius;
+		m_culling.RadiusSet(m_driver.staging, radius);
+	}
+
+	// Without a map from vertices to meshlets every meshlet is refitted, edits happen on small meshes.
+	if (!m_meshlets.empty()) {
+		for (RdMeshlet& meshlet : m_meshlets) {
+			MeshletBoundsCompute(m_vertexData, m_meshletIndices, meshlet);
+			meshlet.radius += m_vertexDequant.error;
+		}
+		m_meshletCulling.BoundsSet(m_driver.staging, m_meshlets);
+	}
+}
+
+Application::BundleKey Application::BundleKeyCurrent() const {
+	return {
+		.pipeline = m_pipeline,
+		.colorFormat = m_context.rdSurface.format,
+		.depthFormat = m_context.rdSurface.depthTextureFormat,
+		.vertexBuffer = m_vertexBuffer,
+		.indexBuffer = m_indexBuffer,
+		.bindGroup = m_bindGroup,
+		.instanceBuffer = m_cpuCulling ? m_visibleBuffer : m_instanceBuffer,
+		.instanceCount = static_cast<uint32_t>(m_instanceData.size()),
+		.gpuCulling = m_culling.Ready(),
+		.meshletCulling = m_meshletCulling.Ready(),
+	};
+}
+
+// @brief Record the instanced draw into one bundle per chunk of instances, the chunks spread over the job system
+// when the backend allows encoding from several threads
+void Application::BundlesRecord() {
+	ZoneScoped;
+	BundlesRelease();
+
+	uint32_t instanceCount = static_cast<uint32_t>(m_instanceData.size());
+	// Culled draws are a single indirect call, their instance count changes without touching the bundle.
+	bool indirect = m_culling.Ready() || m_cpuCulling;
+	size_t chunks = indirect ? 1 : (instanceCount + INSTANCES_PER_BUNDLE - 1) / INSTANCES_PER_BUNDLE;
+	m_bundles.assign(chunks, nullptr);
+
+	auto record = [this, instanceCount](size_t p_begin, size_t p_end) {
+		for (size_t chunk = p_begin; chunk < p_end; ++chunk) {
+			WGPURenderBundleEncoder bundle = m_driver.BundleEncoderCreate(m_context.rdSurface, "Instances Bundle");
+			wgpuRenderBundleEncoderSetPipeline(bundle, m_pipeline);
+			wgpuRenderBundleEncoderSetVertexBuffer(bundle, 0, m_vertexBuffer, 0, wgpuBufferGetSize(m_vertexBuffer));
+			wgpuRenderBundleEncoderSetIndexBuffer(
+					bundle, m_indexBuffer, m_indexFormat, 0, wgpuBufferGetSize(m_indexBuffer)
+			);
+			wgpuRenderBundleEncoderSetBindGroup(bundle, 0, m_bindGroup, 0, nullptr);
+			if (m_culling.Ready()) {
+				bool meshlets = m_meshletCulling.Ready();
+				m_culling.Draw(bundle, meshlets ? 1 : 0);
+				if (meshlets) {
+					m_meshletCulling.Draw(bundle);
+				}
+			} else if (m_cpuCulling) {
+				std::span<const RdMeshLod> lods = LodsActive();
+				uint64_t regionBytes = wgpuBufferGetSize(m_visibleBuffer) / lods.size();
+				for (uint32_t l = 0; l < lods.size(); ++l) {
+					wgpuRenderBundleEncoderSetVertexBuffer(bundle, 1, m_visibleBuffer, l * regionBytes, regionBytes);
+					wgpuRenderBundleEncoderDrawIndexedIndirect(bundle, m_visibleIndirect, l * INDIRECT_DRAW_SIZE);
+				}
+			} else {
+				uint32_t first = static_cast<uint32_t>(chunk) * INSTANCES_PER_BUNDLE;
+				wgpuRenderBundleEncoderSetVertexBuffer(
+						bundle, 1, m_instanceBuffer, 0, wgpuBufferGetSize(m_instanceBuffer)
+				);
+				wgpuRenderBundleEncoderDrawIndexed(
+						bundle, m_lods[0].indexCount, std::min(INSTANCES_PER_BUNDLE, instanceCount - first), 0, 0, first
+				);
+			}
+
+			WGPURenderBundleDescriptor bundleDesc = {
+				.nextInChain = nullptr,
+				.label = "Instances Bundle",
+			};
+			m_bundles[chunk] = wgpuRenderBundleEncoderFinish(bundle, &bundleDesc);
+			wgpuRenderBundleEncoderRelease(bundle);
+		}
+	};
+
+	if (m_context.parallelEncoding) {
+		m_jobs.ParallelFor(chunks, 1, record);
+	} else {
+		record(0, chunks);
+	}
+	TracyPlot("Render bundles recorded", static_cast<int64_t>(chunks));
+	LOG_TRACE("Recorded %zu render bundles", chunks);
+}
+
+void Application::BundlesRelease() {
+	for (WGPURenderBundle bundle : m_bundles) {
+		wgpuRenderBundleRelease(bundle);
+	}
+	m_bundles.clear();
 }
 
-Application::Application() {
+Application::Application() :
+		m_uploadStep(0),
+		m_uploadedVertexBytes(0),
+		m_uploadedIndexBytes(0),
+		m_animate(true),
+		m_animationTime(0.0f),
+		m_lastFrameTime(std::chrono::steady_clock::now()),
+		m_redrawFrames(REDRAW_FRAMES) {
 	ZoneScoped;
 	LOG_INFO("Application created");
 }
 
 bool Application::isRunning() {
+	if (m_options.headless) {
+		return true;
+	}
 	return !glfwWindowShouldClose(m_window.handle);
 }
 
+RdContext& Application::GetContext() {
+	return m_context;
+}
+
+RdDriver& Application::GetDriver() {
+	return m_driver;
+}
+
 void Application::Terminate() {
 	ZoneScoped;
+#ifndef __EMSCRIPTEN__
+	while (m_driver.staging.Busy() || m_driver.pacer.Busy()) {
+		m_context.Polltick(m_driver.device, true);
+	}
+#endif	// __EMSCRIPTEN__
+	m_loader.Terminate();
+	m_meshUpload.reset();
+	m_meshletCulling.Release();
+	m_culling.Release();
+	BundlesRelease();
+	m_jobs.Terminate();
+	m_driver.Terminate();
 	if (m_window.handle != nullptr) {
 		glfwDestroyWindow(m_window.handle);
 		LOG_TRACE("Application window destroyed");
 	}
-	if (m_pipeline != nullptr) {
-		wgpuRenderPipelineRelease(m_pipeline);
-		LOG_TRACE("Pipeline destroyed");
-	}
 	if (m_vertexBuffer != nullptr) {
 		wgpuBufferRelease(m_vertexBuffer);
 		LOG_TRACE("Buffers destroyed");
@@ -350,6 +1113,15 @@ void Application::Terminate() {
 		wgpuBufferRelease(m_indexBuffer);
 		LOG_TRACE("Index buffer destroyed");
 	}
+	if (m_instanceBuffer != nullptr) {
+		wgpuBufferRelease(m_instanceBuffer);
+		LOG_TRACE("Instance buffer destroyed");
+	}
+	if (m_visibleBuffer != nullptr) {
+		wgpuBufferRelease(m_visibleBuffer);
+		wgpuBufferRelease(m_visibleIndirect);
+		LOG_TRACE("Visible instance buffers destroyed");
+	}
 	if (m_uniformBuffer != nullptr) {
 		wgpuBufferRelease(m_uniformBuffer);
 		LOG_TRACE("Uniform buffer destroyed");
@@ -366,8 +1138,10 @@ void Application::Terminate() {
 		wgpuBindGroupRelease(m_bindGroup);
 		LOG_TRACE("Bind group destroyed");
 	}
-	TerminateGui();
-	glfwTerminate();
+	if (!m_options.headless) {
+		TerminateGui();
+		glfwTerminate();
+	}
 }
 
 void Application::TerminateGui() {
@@ -2,12 +2,26 @@
 
 #include <glm.hpp>
 
+#include "../asset/AssetLoader.hpp"
+#include "../asset/MeshLod.hpp"
+#include "../asset/Meshlet.hpp"
+#include "../asset/VertexFormat.hpp"
 #include "../renderer/Context.hpp"
+#include "../renderer/GpuCulling.hpp"
+#include "../renderer/GpuMeshlets.hpp"
 #include "../renderer/Vertex.hpp"
+#include "../scene/Bvh.hpp"
+#include "../jobs/JobSystem.hpp"
+#include "../scene/Scene.hpp"
 #include "webgpu/webgpu.h"
 
 #include <GLFW/glfw3.h>
 
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
 #include <vector>
 
 class Application {
@@ -18,34 +32,195 @@ public:
 		int height;
 	};
 
-	bool Initialize();
+	struct Options {
+		bool headless = false;
+		bool forceFallbackAdapter = false;
+		int width = 800;
+		int height = 600;
+		// Mesh in the resource directory, a .rdmesh that fails to open falls back to the .txt of the same name.
+		std::string mesh = "pyramid.rdmesh";
+		// Mesh bytes streamed to the GPU per frame while a loaded mesh fills in, 0 uploads it in one frame.
+		uint64_t uploadBudget = 4 << 20;
+		// Number of frames measured by the benchmark runner, 0 runs the interactive loop.
+		uint32_t benchmarkFrames = 0;
+		// Copies of the mesh drawn in one instanced call, laid out on a grid.
+		uint32_t instanceCount = 1;
+		// Instance counts the benchmark runs one after the other instead of a single run.
+		std::vector<uint32_t> instanceSweep;
+		// Benchmark the scene without and with levels of detail instead of a single run.
+		bool benchmarkLod = false;
+		// Where instances outside the view are rejected, Gpu falls back to Cpu when the device cannot run it.
+		enum class Culling {
+			Gpu,
+			Cpu,
+			None,
+		};
+		Culling culling = Culling::Gpu;
+		// Record the draws into render bundles, in parallel when the backend allows it.
+		bool renderBundles = true;
+		// Preferred present mode, Mailbox keeps interactive latency low, benchmarks default to Immediate.
+		WGPUPresentMode presentMode = WGPUPresentMode_Mailbox;
+		// Frames the CPU may queue ahead of the GPU, RdFramePacer::UNLIMITED for none.
+		uint32_t maxFramesInFlight = 2;
+		// Only render when something changed, sleeping in between. Animation counts as a change while it runs.
+		bool onDemand = false;
+		// Screen space error in pixels the culling passes tolerate before switching an instance to a coarser level
+		// of detail, 0 always draws the full mesh.
+		float lodThreshold = 1.0f;
+		// Cull the full mesh meshlet by meshlet after the instances, for dense meshes drawn a few times. Runs on
+		// top of GPU culling only.
+		bool meshletCulling = false;
+		// Also cull meshlets facing away, only right for closed meshes with outward facing triangles.
+		bool meshletCones = true;
+		// GPU layout of the mesh vertices, quantized to 12 bytes by default.
+		RdVertexFormat vertexFormat;
+		// Job system threads besides the main one, AUTO_WORKERS leaves one core per thread.
+		uint32_t jobWorkers = RdJobSystem::AUTO_WORKERS;
+	};
+
+	bool Initialize(const Options& options);
 	bool InitGui();
 	void Terminate();
 	void TerminateGui();
 	void MainLoop();
 	void UpdateGui();
 	void onResize(const int& width, const int& height);
+	void onInput();
+	// @brief Ask for the next frames to be rendered in on-demand mode
+	void Invalidate();
+	// @brief Block until a frame has to be rendered, returns at once unless in on-demand mode
+	void RedrawWait();
 	bool isRunning();
 	void InitPipeline();
+	void UpdatePipeline();
 	void InitBuffers();
+	void MeshRequest(const std::string& name);
+	void AssetsUpdate(uint64_t budget);
+	void MeshSet(std::unique_ptr<RdLoadedMesh> mesh);
+	void MeshUpload(uint64_t budget);
+	void VertexDataChanged(size_t first, size_t count);
+	void InstancesSet(uint32_t count);
+	void CullingBind();
+	void FrameUpdate();
+	void InstancesCull();
+	void BundlesRecord();
+	void BundlesRelease();
+	void LodThresholdSet(float threshold);
+	// @brief Triangles drawn with every instance in view, each at the level the culling passes would pick
+	uint64_t TrianglesSelected() const;
 
 	Window CreateWindow(int width, int height, const char* title);
 
+	RdContext& GetContext();
+	RdDriver& GetDriver();
+
 	Application();
 	~Application();
 
 private:
+	// Frames rendered after an invalidation, ImGui settles its state one frame after the input it reacts to.
+	static constexpr uint32_t REDRAW_FRAMES = 2;
+	// How long an idle on-demand loop sleeps without events, and how often it polls while async work is pending.
+	static constexpr double IDLE_WAIT_SECONDS = 0.5;
+	static constexpr double PENDING_WAIT_SECONDS = 0.01;
+	// Longest step the animation takes, so a stall or a pause does not make it jump.
+	static constexpr float MAX_ANIMATION_STEP = 0.25f;
+
+	// Arguments of one DrawIndexedIndirect, the culling passes keep one per level of detail.
+	static constexpr uint64_t INDIRECT_DRAW_SIZE = 5 * sizeof(uint32_t);
+	// Instances drawn by one render bundle, the unit of parallel recording.
+	static constexpr uint32_t INSTANCES_PER_BUNDLE = 16384;
+
+	// Everything the recorded bundles depend on, they are only recorded again once some of it changed.
+	struct BundleKey {
+		WGPURenderPipeline pipeline;
+		WGPUTextureFormat colorFormat;
+		WGPUTextureFormat depthFormat;
+		WGPUBuffer vertexBuffer;
+		WGPUBuffer indexBuffer;
+		WGPUBindGroup bindGroup;
+		WGPUBuffer instanceBuffer;
+		uint32_t instanceCount;
+		bool gpuCulling;
+		bool meshletCulling;
+
+		bool operator==(const BundleKey&) const = default;
+	};
+
+	BundleKey BundleKeyCurrent() const;
+	// Levels of detail the culling passes pick from, only the full mesh when they are off.
+	std::span<const RdMeshLod> LodsActive() const;
+	// Pixels one mesh unit covers at zoom and instance scale 1, over the tolerated error.
+	float LodScale() const;
+
+	// Mirrors Uniforms in triangles.wgsl and cull.wgsl.
+	struct FrameUniforms {
+		float time;
+		float zoom;
+		glm::vec2 pan;
+		glm::vec4 positionScale;
+		glm::vec4 positionOffset;
+	};
+
+	Options m_options;
 	Window m_window;
 	RdContext m_context;
 	RdDriver m_driver;
 	WGPURenderPipeline m_pipeline;
+	RdPipelineDesc m_pipelineDesc;
+	// Compile in flight that replaces m_pipeline once ready, 0 when there is none.
+	uint64_t m_pipelineRequest;
 	WGPUBuffer m_vertexBuffer;
 	WGPUBuffer m_indexBuffer;
+	WGPUBuffer m_instanceBuffer;
 	WGPUBuffer m_uniformBuffer;
 	WGPUPipelineLayout m_pipelineLayout;
 	WGPUBindGroupLayout m_bindGroupLayout;
 	WGPUBindGroup m_bindGroup;
 	std::vector<Vertex> m_vertexData;
-	std::vector<uint16_t> m_indexData;
-	uint32_t m_indexCount;
+	// m_vertexData encoded in m_options.vertexFormat, the contents of m_vertexBuffer.
+	std::vector<std::byte> m_vertexPacked;
+	RdVertexDequant m_vertexDequant;
+	RdDirtyRanges m_vertexDirty;
+	// Transforms of the instances, animated every frame on the job system.
+	RdJobSystem m_jobs;
+	RdScene m_scene;
+	std::vector<Instance> m_instanceData;
+	RdGpuCulling m_culling;
+	// Meshlets of level 0, ranges of m_meshletIndices, with bounds grown by the quantization error.
+	RdGpuMeshlets m_meshletCulling;
+	std::vector<RdMeshlet> m_meshlets;
+	std::vector<uint32_t> m_meshletIndices;
+	// CPU culling: instance bounds, their hierarchy and the survivors of the last frame, gathered into the region
+	// of m_visibleBuffer of their level of detail and counted in m_visibleIndirect, so the recorded draws never change.
+	bool m_cpuCulling;
+	RdAabbSoA m_instanceBounds;
+	RdBvh m_instanceBvh;
+	std::vector<uint32_t> m_visibleIds;
+	std::vector<uint8_t> m_visibleLods;
+	WGPUBuffer m_visibleBuffer;
+	WGPUBuffer m_visibleIndirect;
+	uint32_t m_visibleCounts[RD_MESH_MAX_LODS];
+	// Recorded draws, one bundle per chunk of instances executed in order, and what they were recorded with.
+	std::vector<WGPURenderBundle> m_bundles;
+	BundleKey m_bundleKey;
+	float m_meshRadius;
+	FrameUniforms m_uniforms;
+	WGPUIndexFormat m_indexFormat;
+	// Index ranges of the levels of detail in m_indexBuffer, level 0 being the full mesh.
+	std::vector<RdMeshLod> m_lods;
+	// Meshes are read and decoded on the loader threads, the one streaming in keeps its index data and the upload
+	// steps not staged yet.
+	RdAssetLoader m_loader;
+	std::unique_ptr<RdLoadedMesh> m_meshUpload;
+	size_t m_uploadStep;
+	uint64_t m_uploadedVertexBytes;
+	uint64_t m_uploadedIndexBytes;
+	char m_meshName[256];
+	// Animation clock, it only advances while m_animate is set.
+	bool m_animate;
+	float m_animationTime;
+	std::chrono::steady_clock::time_point m_lastFrameTime;
+	// Frames still to render in on-demand mode.
+	uint32_t m_redrawFrames;
 };
@@ -0,0 +1,169 @@
+#include "Benchmark.hpp"
+
+#include <webgpu/webgpu.h>
+
+#include "Application.hpp"
+#include "logging_macros.h"
+#include "tracy/Tracy.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+
+static double NowMs() {
+	using namespace std::chrono;
+	return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+Benchmark::Benchmark(uint32_t frameCount, uint32_t warmupFrames) :
+		m_frameCount(frameCount), m_warmupFrames(warmupFrames) {}
+
+// @brief Render warmup frames, then m_frameCount measured ones.
+// Every measured frame waits for the GPU before the next one starts, so the GPU time is the span between
+// submission and completion of that frame alone instead of including time spent queued behind earlier frames.
+void Benchmark::Run(Application& app) {
+	ZoneScoped;
+	RdContext& context = app.GetContext();
+	RdDriver& driver = app.GetDriver();
+
+	for (uint32_t i = 0; i < m_warmupFrames && app.isRunning(); ++i) {
+		app.MainLoop();
+	}
+
+	m_samples.clear();
+	m_samples.reserve(m_frameCount);
+	for (uint32_t i = 0; i < m_frameCount && app.isRunning(); ++i) {
+		FrameSample& sample = m_samples.emplace_back(FrameSample{ 0.0, 0.0, 0.0, false });
+
+		double start = NowMs();
+		app.MainLoop();
+		sample.submitMs = NowMs();
+		sample.cpuMs = sample.submitMs - start;
+
+		wgpuQueueOnSubmittedWorkDone(driver.queue, OnFrameWorkDone, &sample);
+		while (!sample.done) {
+			context.Polltick(driver.device, true);
+		}
+	}
+}
+
+void Benchmark::OnFrameWorkDone(WGPUQueueWorkDoneStatus status, void* userdata) {
+	(void)status;
+	FrameSample& sample = *reinterpret_cast<FrameSample*>(userdata);
+	sample.doneMs = NowMs();
+	sample.done = true;
+}
+
+BenchmarkStats Benchmark::Summarize(std::vector<double> samples) {
+	if (samples.empty()) {
+		return { 0.0, 0.0, 0.0, 0.0 };
+	}
+
+	std::sort(samples.begin(), samples.end());
+	auto percentile = [&samples](double p) {
+		size_t rank = static_cast<size_t>(p * static_cast<double>(samples.size() - 1) + 0.5);
+		return samples[rank];
+	};
+
+	return {
+		.min = samples.front(),
+		.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size()),
+		.p50 = percentile(0.50),
+		.p99 = percentile(0.99),
+	};
+}
+
+void Benchmark::Stats(BenchmarkStats& cpuStats, BenchmarkStats& gpuStats) const {
+	std::vector<double> cpu;
+	std::vector<double> gpu;
+	cpu.reserve(m_samples.size());
+	gpu.reserve(m_samples.size());
+	for (const FrameSample& sample : m_samples) {
+		cpu.push_back(sample.cpuMs);
+		gpu.push_back(sample.doneMs - sample.submitMs);
+	}
+
+	cpuStats = Summarize(std::move(cpu));
+	gpuStats = Summarize(std::move(gpu));
+}
+
+void Benchmark::Report() const {
+	BenchmarkStats cpuStats;
+	BenchmarkStats gpuStats;
+	Stats(cpuStats, gpuStats);
+
+	LOG_INFO("Benchmark: %zu frames", m_samples.size());
+	LOG_INFO("  ~  CPU ms  min %8.3f  mean %8.3f  p50 %8.3f  p99 %8.3f",
+			 cpuStats.min, cpuStats.mean, cpuStats.p50, cpuStats.p99);
+	LOG_INFO("  ~  GPU ms  min %8.3f  mean %8.3f  p50 %8.3f  p99 %8.3f",
+			 gpuStats.min, gpuStats.mean, gpuStats.p50, gpuStats.p99);
+}
+
+// The frame time per instance shows where drawing stops scaling linearly: once it stops falling the GPU is
+// saturated, once it rises the renderer has fallen off a cliff.
+void Benchmark::InstanceSweep(Application& app, uint32_t frameCount, const std::vector<uint32_t>& instanceCounts) {
+	ZoneScoped;
+	struct Row {
+		uint32_t instances;
+		BenchmarkStats cpu;
+		BenchmarkStats gpu;
+	};
+	std::vector<Row> rows;
+
+	for (uint32_t instances : instanceCounts) {
+		if (!app.isRunning()) {
+			break;
+		}
+		app.InstancesSet(instances);
+		Benchmark benchmark(frameCount);
+		benchmark.Run(app);
+
+		Row& row = rows.emplace_back(Row{ instances, {}, {} });
+		benchmark.Stats(row.cpu, row.gpu);
+	}
+
+	LOG_INFO("Instance sweep: %u frames per step", frameCount);
+	LOG_INFO("  ~  %10s  %10s  %10s  %10s  %10s  %12s", "instances", "cpu p50", "cpu p99", "gpu p50", "gpu p99", "gpu ns/inst");
+	for (const Row& row : rows) {
+		LOG_INFO("  ~  %10u  %10.3f  %10.3f  %10.3f  %10.3f  %12.2f",
+				 row.instances, row.cpu.p50, row.cpu.p99, row.gpu.p50, row.gpu.p99,
+				 row.gpu.p50 * 1e6 / static_cast<double>(row.instances));
+	}
+}
+
+// Same scene twice, so the difference in triangles and GPU time is what the levels of detail bought.
+void Benchmark::LodCompare(Application& app, uint32_t frameCount, float threshold) {
+	ZoneScoped;
+	struct Row {
+		const char* name;
+		float threshold;
+		uint64_t triangles;
+		BenchmarkStats cpu;
+		BenchmarkStats gpu;
+	};
+	Row rows[] = {
+		{ "full", 0.0f, 0, {}, {} },
+		{ "lod", threshold, 0, {}, {} },
+	};
+
+	for (Row& row : rows) {
+		if (!app.isRunning()) {
+			return;
+		}
+		app.LodThresholdSet(row.threshold);
+		Benchmark benchmark(frameCount);
+		benchmark.Run(app);
+		row.triangles = app.TrianglesSelected();
+		benchmark.Stats(row.cpu, row.gpu);
+	}
+
+	LOG_INFO("LOD comparison: %u frames each, %.2f px tolerated", frameCount, threshold);
+	LOG_INFO("  ~  %6s  %12s  %10s  %10s  %10s", "mode", "triangles", "cpu p50", "gpu p50", "gpu p99");
+	for (const Row& row : rows) {
+		LOG_INFO("  ~  %6s  %12llu  %10.3f  %10.3f  %10.3f",
+				 row.name, static_cast<unsigned long long>(row.triangles), row.cpu.p50, row.gpu.p50, row.gpu.p99);
+	}
+	LOG_INFO("  ~  triangles / %.2f, gpu p50 / %.2f",
+			 static_cast<double>(rows[0].triangles) / static_cast<double>(std::max<uint64_t>(rows[1].triangles, 1)),
+			 rows[0].gpu.p50 / std::max(rows[1].gpu.p50, 1e-6));
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <webgpu/webgpu.h>
+
+#include <cstdint>
+#include <vector>
+
+class Application;
+
+struct BenchmarkStats {
+	double min;
+	double mean;
+	double p50;
+	double p99;
+};
+
+// Renders a fixed number of frames through Application::MainLoop and reports CPU and GPU frame times.
+class Benchmark {
+public:
+	explicit Benchmark(uint32_t frameCount, uint32_t warmupFrames = 10);
+
+	void Run(Application& app);
+	void Report() const;
+	void Stats(BenchmarkStats& cpu, BenchmarkStats& gpu) const;
+
+	static BenchmarkStats Summarize(std::vector<double> samples);
+	// @brief Run frameCount frames per instance count and print one table row each
+	static void InstanceSweep(Application& app, uint32_t frameCount, const std::vector<uint32_t>& instanceCounts);
+	// @brief Run frameCount frames with the full mesh everywhere, then with levels of detail, and compare them
+	static void LodCompare(Application& app, uint32_t frameCount, float threshold);
+
+private:
+	struct FrameSample {
+		double cpuMs;
+		double submitMs;
+		double doneMs;
+		bool done;
+	};
+
+	static void OnFrameWorkDone(WGPUQueueWorkDoneStatus status, void* userdata);
+
+	uint32_t m_frameCount;
+	uint32_t m_warmupFrames;
+	std::vector<FrameSample> m_samples;
+};
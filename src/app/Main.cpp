@@ -5,15 +5,161 @@
 #include <emscripten/html5.h>
 #endif
 
+#include <algorithm>
 #include <cassert>
+#include <charconv>
+#include <cstdlib>
 #include <cstring>
+#include <system_error>
+#include <vector>
 
 #include "Application.hpp"
+#include "Benchmark.hpp"
+#include "logging_macros.h"
+#include "tracy/Tracy.hpp"
 
-int main() {
+// "1000,10000,100000" -> { 1000, 10000, 100000 }
+static std::vector<uint32_t> ParseCounts(const char* list) {
+	std::vector<uint32_t> counts;
+	for (const char* cursor = list; *cursor != '\0';) {
+		char* end = nullptr;
+		unsigned long value = strtoul(cursor, &end, 10);
+		if (end == cursor) {
+			break;
+		}
+		counts.push_back(static_cast<uint32_t>(value));
+		cursor = *end == ',' ? end + 1 : end;
+	}
+	return counts;
+}
+
+// "1280" -> 1280, false for anything but a whole positive number. The upper bound is the device's texture size
+// limit, checked once the device exists.
+static bool ParseSize(const char* text, int& size) {
+	const char* end = text + strlen(text);
+	int value = 0;
+	auto [last, error] = std::from_chars(text, end, value);
+	if (error != std::errc() || last != end || value <= 0) {
+		return false;
+	}
+	size = value;
+	return true;
+}
+
+static Application::Options ParseOptions(int argc, char** argv) {
+	Application::Options options;
+	bool presentModeSet = false;
+	for (int i = 1; i < argc; ++i) {
+		const char* arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (strcmp(arg, "--headless") == 0) {
+			options.headless = true;
+		} else if (strcmp(arg, "--fallback-adapter") == 0) {
+			options.forceFallbackAdapter = true;
+		} else if (strcmp(arg, "--width") == 0 && hasValue) {
+			if (!ParseSize(argv[++i], options.width)) {
+				LOG_WARN("Invalid width %s, keeping %d", argv[i], options.width);
+			}
+		} else if (strcmp(arg, "--height") == 0 && hasValue) {
+			if (!ParseSize(argv[++i], options.height)) {
+				LOG_WARN("Invalid height %s, keeping %d", argv[i], options.height);
+			}
+		} else if (strcmp(arg, "--bench") == 0 && hasValue) {
+			options.benchmarkFrames = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+		} else if (strcmp(arg, "--culling") == 0 && hasValue) {
+			const char* mode = argv[++i];
+			if (strcmp(mode, "gpu") == 0) {
+				options.culling = Application::Options::Culling::Gpu;
+			} else if (strcmp(mode, "cpu") == 0) {
+				options.culling = Application::Options::Culling::Cpu;
+			} else if (strcmp(mode, "none") == 0) {
+				options.culling = Application::Options::Culling::None;
+			} else {
+				LOG_WARN("Unknown culling mode %s, expected gpu, cpu or none", mode);
+			}
+		} else if (strcmp(arg, "--present") == 0 && hasValue) {
+			const char* mode = argv[++i];
+			presentModeSet = true;
+			if (strcmp(mode, "fifo") == 0) {
+				options.presentMode = WGPUPresentMode_Fifo;
+			} else if (strcmp(mode, "mailbox") == 0) {
+				options.presentMode = WGPUPresentMode_Mailbox;
+			} else if (strcmp(mode, "immediate") == 0) {
+				options.presentMode = WGPUPresentMode_Immediate;
+			} else {
+				presentModeSet = false;
+				LOG_WARN("Unknown present mode %s, expected fifo, mailbox or immediate", mode);
+			}
+		} else if (strcmp(arg, "--frames-in-flight") == 0 && hasValue) {
+			// 0 lifts the limit.
+			options.maxFramesInFlight = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+		} else if (strcmp(arg, "--on-demand") == 0) {
+			options.onDemand = true;
+		} else if (strcmp(arg, "--positions") == 0 && hasValue) {
+			const char* format = argv[++i];
+			if (strcmp(format, "float32") == 0) {
+				options.vertexFormat.position = RdPositionFormat::Float32x3;
+			} else if (strcmp(format, "snorm16") == 0) {
+				options.vertexFormat.position = RdPositionFormat::Snorm16x4;
+			} else if (strcmp(format, "unorm16") == 0) {
+				options.vertexFormat.position = RdPositionFormat::Unorm16x4;
+			} else {
+				LOG_WARN("Unknown position format %s, expected float32, snorm16 or unorm16", format);
+			}
+		} else if (strcmp(arg, "--colors") == 0 && hasValue) {
+			const char* format = argv[++i];
+			if (strcmp(format, "float32") == 0) {
+				options.vertexFormat.color = RdColorFormat::Float32x3;
+			} else if (strcmp(format, "unorm8") == 0) {
+				options.vertexFormat.color = RdColorFormat::Unorm8x4;
+			} else {
+				LOG_WARN("Unknown color format %s, expected float32 or unorm8", format);
+			}
+		} else if (strcmp(arg, "--mesh") == 0 && hasValue) {
+			options.mesh = argv[++i];
+		} else if (strcmp(arg, "--upload-budget") == 0 && hasValue) {
+			// Bytes per frame, 0 uploads a mesh at once.
+			options.uploadBudget = strtoull(argv[++i], nullptr, 10);
+		} else if (strcmp(arg, "--lod-error") == 0 && hasValue) {
+			// Pixels, 0 turns levels of detail off.
+			options.lodThreshold = static_cast<float>(std::max(atof(argv[++i]), 0.0));
+		} else if (strcmp(arg, "--meshlets") == 0) {
+			options.meshletCulling = true;
+		} else if (strcmp(arg, "--no-meshlet-cones") == 0) {
+			options.meshletCones = false;
+		} else if (strcmp(arg, "--bench-lod") == 0) {
+			options.benchmarkLod = true;
+		} else if (strcmp(arg, "--no-render-bundles") == 0) {
+			options.renderBundles = false;
+		} else if (strcmp(arg, "--threads") == 0 && hasValue) {
+			// Counts the main thread like the scaling benchmarks do.
+			options.jobWorkers = static_cast<uint32_t>(std::max(atoi(argv[++i]), 1) - 1);
+		} else if (strcmp(arg, "--instances") == 0 && hasValue) {
+			options.instanceCount = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+		} else if (strcmp(arg, "--bench-instances") == 0 && hasValue) {
+			options.instanceSweep = ParseCounts(argv[++i]);
+		} else {
+			LOG_WARN("Ignoring unknown argument: %s", arg);
+		}
+	}
+
+	// A headless run has no window to close, so it always ends after a benchmark.
+	bool comparison = !options.instanceSweep.empty() || options.benchmarkLod;
+	if ((options.headless || comparison) && options.benchmarkFrames == 0) {
+		options.benchmarkFrames = 100;
+	}
+	// Benchmarks measure throughput, vsync would only cap it.
+	if (options.benchmarkFrames > 0 && !presentModeSet) {
+		options.presentMode = WGPUPresentMode_Immediate;
+	}
+	return options;
+}
+
+int main(int argc, char** argv) {
     Application app;   
+    Application::Options options = ParseOptions(argc, argv);
 
-    if (!app.Initialize()) {
+    if (!app.Initialize(options)) {
         return -1;
     }
     
@@ -24,8 +170,20 @@ int main() {
 	};
 	emscripten_set_main_loop_arg(callback, &app, 0, true);
 #else // __EMSCRIPTEN__
-	while (app.isRunning()) {
-		app.MainLoop();
+	if (!options.instanceSweep.empty()) {
+		Benchmark::InstanceSweep(app, options.benchmarkFrames, options.instanceSweep);
+	} else if (options.benchmarkLod) {
+		float threshold = options.lodThreshold > 0.0f ? options.lodThreshold : 1.0f;
+		Benchmark::LodCompare(app, options.benchmarkFrames, threshold);
+	} else if (options.benchmarkFrames > 0) {
+		Benchmark benchmark(options.benchmarkFrames);
+		benchmark.Run(app);
+		benchmark.Report();
+	} else {
+		while (app.isRunning()) {
+			app.RedrawWait();
+			app.MainLoop();
+		}
 	}
 #endif // __EMSCRIPTEN__
 
@@ -0,0 +1,206 @@
+#include "AssetLoader.hpp"
+
+#include "GeometryImport.hpp"
+#include "MeshFile.hpp"
+#include "MeshOptimize.hpp"
+#include "logging_macros.h"
+#include "tracy/Tracy.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+// @brief Cut the index buffer into steps of RdAssetLoader::STEP_INDEX_BYTES, each needing the vertices up to the
+// largest one referenced so far. Vertex fetch optimization numbers vertices by first use, so those grow in step.
+static std::vector<RdUploadStep> UploadStepsBuild(const RdLoadedMesh& p_mesh, uint32_t p_vertexStride) {
+	ZoneScoped;
+	std::vector<RdUploadStep> steps;
+	const RdIndexData& indices = p_mesh.indices;
+	uint64_t indexStride = static_cast<uint64_t>(indices.format);
+	// Even, so the step ends stay 4 byte aligned for 16 bit indices.
+	uint64_t stepIndices = std::max<uint64_t>((RdAssetLoader::STEP_INDEX_BYTES / indexStride) & ~uint64_t(1), 2);
+
+	uint32_t maxVertex = 0;
+	for (uint64_t first = 0; first < indices.count; first += stepIndices) {
+		uint64_t end = std::min<uint64_t>(first + stepIndices, indices.count);
+		for (uint64_t i = first; i < end; ++i) {
+			uint32_t index = 0;
+			std::memcpy(&index, indices.bytes.data() + i * indexStride, indexStride);
+			maxVertex = std::max(maxVertex, index);
+		}
+		steps.push_back({ static_cast<uint64_t>(maxVertex + 1) * p_vertexStride, end * indexStride });
+	}
+
+	// The last step takes the padding of both buffers and any vertex no index references.
+	uint64_t vertexBytes = p_mesh.vertexBytes.size();
+	if (steps.empty()) {
+		steps.push_back({});
+	}
+	steps.back() = { vertexBytes, indices.bytes.size() };
+	for (RdUploadStep& step : steps) {
+		step.vertexBytes = std::min(step.vertexBytes, vertexBytes);
+	}
+	return steps;
+}
+
+bool MeshLoad(const RdMeshRequest& p_request, RdLoadedMesh& p_mesh) {
+	ZoneScoped;
+	auto start = std::chrono::steady_clock::now();
+	const std::filesystem::path& path = p_request.path;
+
+	RdMeshFile meshFile;
+	if (path.extension() == ".rdmesh" && meshFile.Open(path)) {
+		// Converted meshes were optimized and simplified by meshconv already.
+		p_mesh.vertices.assign(meshFile.Vertices().begin(), meshFile.Vertices().end());
+		p_mesh.lods.assign(meshFile.Lods().begin(), meshFile.Lods().end());
+		p_mesh.indices.format = meshFile.IndexFormat();
+		p_mesh.indices.count = meshFile.header->indexCount;
+		p_mesh.indices.bytes.assign(meshFile.IndexBlock(), meshFile.IndexBlock() + meshFile.header->indexBytes);
+		if (p_request.meshlets) {
+			p_mesh.meshletIndices = IndexDataUnpack(meshFile.IndexBlock(), meshFile.IndexFormat(), p_mesh.lods[0].indexCount);
+		}
+	} else {
+		std::filesystem::path geometryPath = path;
+		if (geometryPath.extension() == ".rdmesh") {
+			geometryPath.replace_extension(".txt");
+		}
+		std::vector<uint32_t> indices;
+		if (!GeometryImport(geometryPath, p_mesh.vertices, indices)) {
+			LOG_ERROR("Failed to load geometry: %s", geometryPath.string().c_str());
+			return false;
+		}
+		// Text and imported geometry is in authoring order.
+		MeshOptimize(p_mesh.vertices, indices);
+		p_mesh.lods = MeshLodChainBuild(p_mesh.vertices, indices);
+		p_mesh.indices = IndexDataPack(indices);
+		if (p_request.meshlets) {
+			p_mesh.meshletIndices.assign(indices.begin(), indices.begin() + p_mesh.lods[0].indexCount);
+		}
+	}
+
+	const RdVertexFormat& vertexFormat = p_request.vertexFormat;
+	p_mesh.dequant = VertexDequantCompute(vertexFormat.position, p_mesh.vertices);
+	p_mesh.vertexBytes.resize(p_mesh.vertices.size() * vertexFormat.Stride());
+	VertexEncode(vertexFormat, p_mesh.dequant, p_mesh.vertices, p_mesh.vertexBytes.data());
+
+	// Quantized positions land up to the quantization error away, the bounds include it.
+	p_mesh.radius = 0.0f;
+	for (const Vertex& vertex : p_mesh.vertices) {
+		p_mesh.radius = std::max(p_mesh.radius, glm::length(vertex.position));
+	}
+	p_mesh.radius += p_mesh.dequant.error;
+	if (p_request.meshlets) {
+		p_mesh.meshlets = MeshletsBuild(p_mesh.vertices, p_mesh.meshletIndices);
+		for (RdMeshlet& meshlet : p_mesh.meshlets) {
+			meshlet.radius += p_mesh.dequant.error;
+		}
+	}
+
+	p_mesh.steps = UploadStepsBuild(p_mesh, vertexFormat.Stride());
+	double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	LOG_INFO("Mesh loaded: %s, %zu vertices, %u triangles, %zu upload steps in %.2f ms", path.string().c_str(),
+			 p_mesh.vertices.size(), p_mesh.indices.count / 3, p_mesh.steps.size(), elapsedMs);
+	return true;
+}
+
+void RdAssetLoader::Initialize(uint32_t p_threads, std::function<void()> p_onLoaded) {
+	ZoneScoped;
+	m_onLoaded = std::move(p_onLoaded);
+	m_running = true;
+	for (uint32_t t = 0; t < std::max(p_threads, 1u); ++t) {
+		m_threads.emplace_back(&RdAssetLoader::Worker, this);
+	}
+	LOG_INFO("Asset loader initialized: %zu threads", m_threads.size());
+}
+
+void RdAssetLoader::Terminate() {
+	ZoneScoped;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_running = false;
+	}
+	m_wake.notify_all();
+	for (std::thread& thread : m_threads) {
+		thread.join();
+	}
+	m_threads.clear();
+
+	for (RdLoadedMesh* mesh : m_requests) {
+		delete mesh;
+	}
+	m_requests.clear();
+	while (std::optional<RdLoadedMesh*> mesh = m_loaded.Pop()) {
+		delete *mesh;
+	}
+	m_pending = 0;
+}
+
+RdAssetLoader::~RdAssetLoader() {
+	if (!m_threads.empty()) {
+		Terminate();
+	}
+}
+
+uint64_t RdAssetLoader::Request(RdMeshRequest p_request) {
+	ZoneScoped;
+	auto mesh = std::make_unique<RdLoadedMesh>();
+	mesh->request = std::move(p_request);
+	uint64_t id = 0;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		id = m_nextId++;
+		mesh->id = id;
+		m_requests.push_back(mesh.release());
+		m_pending++;
+	}
+	m_wake.notify_one();
+	return id;
+}
+
+std::unique_ptr<RdLoadedMesh> RdAssetLoader::Poll() {
+	std::optional<RdLoadedMesh*> mesh = m_loaded.Pop();
+	if (!mesh) {
+		return nullptr;
+	}
+	m_pending--;
+	return std::unique_ptr<RdLoadedMesh>(*mesh);
+}
+
+uint32_t RdAssetLoader::Pending() const {
+	return m_pending.load(std::memory_order_relaxed);
+}
+
+bool RdAssetLoader::Ready() const {
+	return m_loaded.Size() > 0;
+}
+
+void RdAssetLoader::Worker() {
+	tracy::SetThreadName("Asset Loader");
+	for (;;) {
+		RdLoadedMesh* mesh = nullptr;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wake.wait(lock, [this]() { return !m_running || !m_requests.empty(); });
+			if (!m_running) {
+				return;
+			}
+			mesh = m_requests.front();
+			m_requests.pop_front();
+		}
+
+		// A failed load is handed over too, the render thread reports it and keeps the mesh it has.
+		mesh->loaded = MeshLoad(mesh->request, *mesh);
+
+		// The render thread drains the queue every frame, a full one only holds this thread for a few frames.
+		while (!m_loaded.Push(mesh)) {
+			std::unique_lock<std::mutex> lock(m_mutex);
+			if (m_wake.wait_for(lock, std::chrono::milliseconds(1), [this]() { return !m_running; })) {
+				delete mesh;
+				return;
+			}
+		}
+		if (m_onLoaded) {
+			m_onLoaded();
+		}
+	}
+}
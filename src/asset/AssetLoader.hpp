@@ -0,0 +1,103 @@
+#pragma once
+
+#include "IndexData.hpp"
+#include "MeshLod.hpp"
+#include "Meshlet.hpp"
+#include "VertexFormat.hpp"
+#include "../jobs/BoundedQueue.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A mesh to load and what for: the vertex layout it gets encoded in, and whether meshlets are built for it.
+// A .rdmesh that fails to open falls back to the text geometry of the same name, .obj, .gltf and .glb are imported
+// through GeometryImport.
+struct RdMeshRequest {
+	std::filesystem::path path;
+	RdVertexFormat vertexFormat;
+	bool meshlets = false;
+};
+
+// Prefix of a mesh on the GPU once a step is uploaded. Every step uploads the vertices its indices reference
+// before the indices themselves, so a mesh drawn while it streams in only ever shows finished triangles.
+struct RdUploadStep {
+	uint64_t vertexBytes;
+	uint64_t indexBytes;
+};
+
+// A mesh read and decoded off the render thread, what is left to do is creating its buffers and uploading them.
+struct RdLoadedMesh {
+	uint64_t id = 0;
+	RdMeshRequest request;
+	bool loaded = false;
+	std::vector<Vertex> vertices;
+	// vertices encoded in request.vertexFormat.
+	std::vector<std::byte> vertexBytes;
+	RdVertexDequant dequant;
+	RdIndexData indices;
+	std::vector<RdMeshLod> lods;
+	// Level 0 widened to 32 bits and its meshlets, with bounds grown by the quantization error. Only built when
+	// request.meshlets is set.
+	std::vector<uint32_t> meshletIndices;
+	std::vector<RdMeshlet> meshlets;
+	// Bounding radius around the mesh origin, quantization error included.
+	float radius = 0.0f;
+	std::vector<RdUploadStep> steps;
+};
+
+// @brief Read, decode and prepare p_request for upload: optimize and simplify text and imported geometry, quantize
+// the vertices and split the buffers into upload steps. Runs on any thread.
+bool MeshLoad(const RdMeshRequest& p_request, RdLoadedMesh& p_mesh);
+
+// @brief Loads meshes on threads of its own. Requests are handed over under a mutex the threads sleep on, loaded
+// meshes come back through a lock-free queue the render thread polls once a frame without ever blocking on it.
+struct RdAssetLoader {
+	// One thread can read a file while another one decodes.
+	static constexpr uint32_t DEFAULT_THREADS = 2;
+	// Loaded meshes waiting for the render thread, loader threads hold on to theirs while it is full.
+	static constexpr size_t QUEUE_CAPACITY = 16;
+	// Index bytes per upload step, the granularity at which a mesh becomes drawable.
+	static constexpr uint64_t STEP_INDEX_BYTES = 64 << 10;
+
+	// @brief Start p_threads loader threads. p_onLoaded runs on a loader thread whenever a mesh was queued, to
+	// wake a render loop sleeping on events.
+	void Initialize(uint32_t p_threads = DEFAULT_THREADS, std::function<void()> p_onLoaded = {});
+	void Terminate();
+
+	// @brief Queue p_request, returns the id its RdLoadedMesh will carry
+	uint64_t Request(RdMeshRequest p_request);
+	// @brief Render thread, the oldest loaded mesh or nullptr, never blocks
+	std::unique_ptr<RdLoadedMesh> Poll();
+	// @brief Requests not polled yet, whether waiting, loading or loaded
+	uint32_t Pending() const;
+	// @brief Whether Poll() has a loaded mesh to return
+	bool Ready() const;
+
+	RdAssetLoader() = default;
+	~RdAssetLoader();
+
+	RdAssetLoader(const RdAssetLoader&) = delete;
+	RdAssetLoader& operator=(const RdAssetLoader&) = delete;
+
+private:
+	void Worker();
+
+	std::vector<std::thread> m_threads;
+	std::function<void()> m_onLoaded;
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::deque<RdLoadedMesh*> m_requests;
+	bool m_running = false;
+	uint64_t m_nextId = 1;
+
+	RdBoundedQueue<RdLoadedMesh*, QUEUE_CAPACITY> m_loaded;
+	std::atomic<uint32_t> m_pending = 0;
+};
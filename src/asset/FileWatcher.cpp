@@ -0,0 +1,103 @@
+#include "FileWatcher.hpp"
+
+#include "logging_macros.h"
+#include "tracy/Tracy.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif	// __linux__
+
+bool RdFileWatcher::Start(
+		const std::filesystem::path& p_directory,
+		const std::string& p_extension,
+		std::function<void()> p_notify
+) {
+	ZoneScoped;
+	Stop();
+	m_extension = p_extension;
+	m_notify = std::move(p_notify);
+#if defined(__linux__)
+	m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (m_fd < 0) {
+		LOG_WARN("inotify unavailable, file watching disabled");
+		return false;
+	}
+	// Editors either rewrite the file in place or move a temporary over it.
+	if (inotify_add_watch(m_fd, p_directory.string().c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+		LOG_WARN("Failed to watch %s", p_directory.string().c_str());
+		close(m_fd);
+		m_fd = -1;
+		return false;
+	}
+
+	m_running = true;
+	m_thread = std::thread(&RdFileWatcher::Watch, this);
+	LOG_INFO("Watching %s for *%s changes", p_directory.string().c_str(), p_extension.c_str());
+	return true;
+#else
+	LOG_WARN("File watching is only implemented on Linux: %s", p_directory.string().c_str());
+	return false;
+#endif	// __linux__
+}
+
+void RdFileWatcher::Stop() {
+	if (!m_thread.joinable()) {
+		return;
+	}
+	m_running = false;
+	m_thread.join();
+#if defined(__linux__)
+	close(m_fd);
+#endif	// __linux__
+	m_fd = -1;
+}
+
+std::vector<std::string> RdFileWatcher::Changed() {
+	std::vector<std::string> changed;
+	std::lock_guard lock(m_mutex);
+	changed.swap(m_changed);
+	return changed;
+}
+
+// @brief Wait on the inotify descriptor with a short timeout so Stop() never waits long for the thread
+void RdFileWatcher::Watch() {
+#if defined(__linux__)
+	alignas(inotify_event) char buffer[4096];
+	pollfd descriptor = { m_fd, POLLIN, 0 };
+	while (m_running) {
+		if (poll(&descriptor, 1, 100) <= 0) {
+			continue;
+		}
+
+		ssize_t length = read(m_fd, buffer, sizeof(buffer));
+		bool reported = false;
+		for (ssize_t offset = 0; offset < length;) {
+			const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+			offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+			std::string name = event->len > 0 ? event->name : "";
+			if (!name.ends_with(m_extension)) {
+				continue;
+			}
+
+			std::lock_guard lock(m_mutex);
+			if (std::find(m_changed.begin(), m_changed.end(), name) == m_changed.end()) {
+				m_changed.push_back(std::move(name));
+			}
+			reported = true;
+		}
+		if (reported && m_notify) {
+			m_notify();
+		}
+	}
+#endif	// __linux__
+}
+
+RdFileWatcher::~RdFileWatcher() {
+	Stop();
+}
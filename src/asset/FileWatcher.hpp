@@ -0,0 +1,40 @@
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// @brief Reports files of one directory that were rewritten, from a background thread blocked on inotify.
+// Only Linux has a backend, elsewhere Start() fails and Changed() stays empty. p_notify runs on the watcher thread
+// whenever a file was reported, to wake up a consumer that sleeps instead of polling Changed().
+struct RdFileWatcher {
+	bool Start(
+			const std::filesystem::path& p_directory,
+			const std::string& p_extension,
+			std::function<void()> p_notify = nullptr
+	);
+	void Stop();
+	// @brief File names changed since the last call, each reported once however often it was written
+	std::vector<std::string> Changed();
+
+	RdFileWatcher() = default;
+	~RdFileWatcher();
+
+	RdFileWatcher(const RdFileWatcher&) = delete;
+	RdFileWatcher& operator=(const RdFileWatcher&) = delete;
+
+private:
+	void Watch();
+
+	std::string m_extension;
+	std::function<void()> m_notify;
+	std::thread m_thread;
+	std::atomic<bool> m_running = false;
+	std::mutex m_mutex;
+	std::vector<std::string> m_changed;
+	int m_fd = -1;
+};
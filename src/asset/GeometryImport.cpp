@@ -0,0 +1,72 @@
+#include "GeometryImport.hpp"
+
+#include "GltfGeometry.hpp"
+#include "MappedFile.hpp"
+#include "ObjGeometry.hpp"
+#include "TextGeometry.hpp"
+#include "logging_macros.h"
+#include "tracy/Tracy.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <string_view>
+
+// Shading of imported meshes: ambient plus a two-sided diffuse term, winding and normal sign do not matter.
+static const glm::vec3 LIGHT_DIRECTION = glm::normalize(glm::vec3(0.4f, 0.6f, 0.7f));
+static constexpr float AMBIENT = 0.35f;
+
+bool GeometryImport(const std::filesystem::path& p_path, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+	ZoneScoped;
+	auto start = std::chrono::steady_clock::now();
+	std::filesystem::path extension = p_path.extension();
+	bool imported = extension == ".obj" || extension == ".gltf" || extension == ".glb";
+
+	bool loaded = false;
+	if (extension == ".gltf" || extension == ".glb") {
+		loaded = GeometryParseGltf(p_path, vertices, indices);
+	} else {
+		RdMappedFile file;
+		if (!file.Open(p_path)) {
+			LOG_ERROR("Failed to open geometry: %s", p_path.string().c_str());
+			return false;
+		}
+		std::string_view text(reinterpret_cast<const char*>(file.data), file.size);
+		loaded = imported ? GeometryParseObj(text, vertices, indices) : GeometryParseText(text, vertices, indices);
+	}
+	if (!loaded) {
+		return false;
+	}
+	if (imported && indices.empty()) {
+		LOG_ERROR("No triangles in %s", p_path.string().c_str());
+		return false;
+	}
+
+	if (imported) {
+		GeometryShade(vertices, indices);
+		double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		LOG_INFO("Geometry imported: %s, %zu vertices, %zu triangles in %.2f ms", p_path.string().c_str(),
+				 vertices.size(), indices.size() / 3, elapsedMs);
+	}
+	return true;
+}
+
+void GeometryShade(std::span<Vertex> p_vertices, std::span<const uint32_t> p_indices) {
+	ZoneScoped;
+	// Area weighted, the cross product of two edges is twice the triangle area along its normal.
+	std::vector<glm::vec3> normals(p_vertices.size(), glm::vec3(0.0f));
+	for (size_t i = 0; i + 2 < p_indices.size(); i += 3) {
+		glm::vec3 a = p_vertices[p_indices[i]].position;
+		glm::vec3 b = p_vertices[p_indices[i + 1]].position;
+		glm::vec3 c = p_vertices[p_indices[i + 2]].position;
+		glm::vec3 normal = glm::cross(b - a, c - a);
+		normals[p_indices[i]] += normal;
+		normals[p_indices[i + 1]] += normal;
+		normals[p_indices[i + 2]] += normal;
+	}
+
+	for (size_t v = 0; v < p_vertices.size(); ++v) {
+		float length = glm::length(normals[v]);
+		float diffuse = length > 0.0f ? std::abs(glm::dot(normals[v], LIGHT_DIRECTION)) / length : 1.0f;
+		p_vertices[v].color *= AMBIENT + (1.0f - AMBIENT) * diffuse;
+	}
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "../renderer/Vertex.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+// @brief Read the geometry at p_path by its extension: .obj, .gltf and .glb through their importers, anything else
+// as the `[points]`/`[indices]` text format. Imported meshes get their shading baked in, see GeometryShade.
+bool GeometryImport(const std::filesystem::path& p_path, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+// @brief Multiply a two-sided diffuse term from smooth vertex normals into the vertex colors. The pipeline draws
+// vertex colors unlit, imported meshes would otherwise show as flat silhouettes.
+void GeometryShade(std::span<Vertex> p_vertices, std::span<const uint32_t> p_indices);
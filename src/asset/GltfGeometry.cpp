@@ -0,0 +1,760 @@
+#include "GltfGeometry.hpp"
+
+#include "MappedFile.hpp"
+#include "ParallelParse.hpp"
+#include "logging_macros.h"
+#include "tracy/Tracy.hpp"
+
+#include <gtc/matrix_transform.hpp>
+#include <gtc/quaternion.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <span>
+#include <string_view>
+
+// GLB container, little endian: a 12 byte header then chunks of { length, type, data padded to 4 bytes }.
+static constexpr uint32_t GLB_MAGIC = 0x46546C67;  // "glTF"
+static constexpr uint32_t GLB_CHUNK_JSON = 0x4E4F534A;
+static constexpr uint32_t GLB_CHUNK_BIN = 0x004E4942;
+
+// Accessor component types.
+static constexpr uint32_t GLTF_BYTE = 5120;
+static constexpr uint32_t GLTF_UNSIGNED_BYTE = 5121;
+static constexpr uint32_t GLTF_SHORT = 5122;
+static constexpr uint32_t GLTF_UNSIGNED_SHORT = 5123;
+static constexpr uint32_t GLTF_UNSIGNED_INT = 5125;
+static constexpr uint32_t GLTF_FLOAT = 5126;
+static constexpr uint32_t GLTF_TRIANGLES = 4;
+
+// Elements converted per work unit, a multiple of 3 so units never split a triangle.
+static constexpr size_t UNIT_ELEMENTS = 3 << 14;
+// Nesting the JSON or the node hierarchy deeper than this is taken as a malformed or cyclic file.
+static constexpr uint32_t MAX_DEPTH = 64;
+
+// ~~~~~~~~~~~~~
+// Minimal JSON document. Strings point into the text, escapes are kept as written: glTF keys never have any and
+// neither do the relative buffer URIs this loader resolves. Objects and arrays both keep their values in items.
+// ~~~~~~~~~~~~~
+struct JsonValue {
+	enum class Type : uint8_t {
+		Null,
+		Bool,
+		Number,
+		String,
+		Array,
+		Object,
+	};
+
+	Type type = Type::Null;
+	double number = 0.0;
+	std::string_view string;
+	std::vector<std::string_view> keys;
+	std::vector<JsonValue> items;
+
+	const JsonValue* Find(std::string_view p_key) const {
+		for (size_t i = 0; i < keys.size(); ++i) {
+			if (keys[i] == p_key) {
+				return &items[i];
+			}
+		}
+		return nullptr;
+	}
+
+	const JsonValue* At(size_t p_index) const {
+		return type == Type::Array && p_index < items.size() ? &items[p_index] : nullptr;
+	}
+
+	double Number(std::string_view p_key, double p_fallback) const {
+		const JsonValue* value = Find(p_key);
+		return value != nullptr && value->type == Type::Number ? value->number : p_fallback;
+	}
+
+	// @brief A non-negative integer member, false when missing or anything else
+	bool Index(std::string_view p_key, size_t& index) const {
+		const JsonValue* value = Find(p_key);
+		if (value == nullptr || value->type != Type::Number || value->number < 0.0
+			|| value->number != std::floor(value->number) || value->number > 9e15) {
+			return false;
+		}
+		index = static_cast<size_t>(value->number);
+		return true;
+	}
+
+	const JsonValue* Element(const JsonValue& p_document, std::string_view p_array, std::string_view p_key) const {
+		size_t index = 0;
+		const JsonValue* array = p_document.Find(p_array);
+		return array != nullptr && Index(p_key, index) ? array->At(index) : nullptr;
+	}
+};
+
+struct JsonParser {
+	const char* cursor;
+	const char* end;
+
+	void SkipBlanks() {
+		while (cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\n' || *cursor == '\r')) {
+			++cursor;
+		}
+	}
+
+	bool Literal(std::string_view p_word) {
+		if (static_cast<size_t>(end - cursor) < p_word.size() || std::memcmp(cursor, p_word.data(), p_word.size()) != 0) {
+			return false;
+		}
+		cursor += p_word.size();
+		return true;
+	}
+
+	bool String(std::string_view& p_string) {
+		const char* begin = ++cursor;
+		while (cursor < end && *cursor != '"') {
+			cursor += *cursor == '\\' ? 2 : 1;
+		}
+		if (cursor >= end) {
+			return false;
+		}
+		p_string = std::string_view(begin, static_cast<size_t>(cursor - begin));
+		++cursor;
+		return true;
+	}
+
+	bool Value(JsonValue& value, uint32_t p_depth) {
+		SkipBlanks();
+		if (cursor >= end || p_depth > MAX_DEPTH) {
+			return false;
+		}
+		switch (*cursor) {
+			case '{':
+			case '[': {
+				bool object = *cursor == '{';
+				char close = object ? '}' : ']';
+				value.type = object ? JsonValue::Type::Object : JsonValue::Type::Array;
+				++cursor;
+				SkipBlanks();
+				if (cursor < end && *cursor == close) {
+					++cursor;
+					return true;
+				}
+				for (;;) {
+					if (object) {
+						SkipBlanks();
+						std::string_view key;
+						if (cursor >= end || *cursor != '"' || !String(key)) {
+							return false;
+						}
+						SkipBlanks();
+						if (cursor >= end || *cursor++ != ':') {
+							return false;
+						}
+						value.keys.push_back(key);
+					}
+					if (!Value(value.items.emplace_back(), p_depth + 1)) {
+						return false;
+					}
+					SkipBlanks();
+					if (cursor < end && *cursor == ',') {
+						++cursor;
+					} else if (cursor < end && *cursor == close) {
+						++cursor;
+						return true;
+					} else {
+						return false;
+					}
+				}
+			}
+			case '"':
+				value.type = JsonValue::Type::String;
+				return String(value.string);
+			case 't':
+			case 'f':
+				value.type = JsonValue::Type::Bool;
+				value.number = *cursor == 't' ? 1.0 : 0.0;
+				return Literal(*cursor == 't' ? "true" : "false");
+			case 'n':
+				return Literal("null");
+			default: {
+				value.type = JsonValue::Type::Number;
+				auto [next, error] = std::from_chars(cursor, end, value.number);
+				cursor = next;
+				return error == std::errc();
+			}
+		}
+	}
+};
+
+// ~~~~~~~~~~~~~
+// Buffers and accessors
+// ~~~~~~~~~~~~~
+
+// The bytes of a buffer: the binary chunk of the .glb, a mapped .bin, or a decoded data URI.
+struct GltfBuffer {
+	RdMappedFile file;
+	std::vector<std::byte> decoded;
+	std::span<const std::byte> bytes;
+};
+
+// A typed view into a buffer, element i starts at data + i * stride.
+struct GltfAccessor {
+	const std::byte* data = nullptr;
+	size_t count = 0;
+	size_t stride = 0;
+	uint32_t componentType = 0;
+	uint32_t components = 0;
+	bool normalized = false;
+};
+
+static uint32_t ComponentSize(uint32_t p_componentType) {
+	switch (p_componentType) {
+		case GLTF_BYTE:
+		case GLTF_UNSIGNED_BYTE:
+			return 1;
+		case GLTF_SHORT:
+		case GLTF_UNSIGNED_SHORT:
+			return 2;
+		case GLTF_UNSIGNED_INT:
+		case GLTF_FLOAT:
+			return 4;
+		default:
+			return 0;
+	}
+}
+
+static uint32_t ComponentCount(std::string_view p_type) {
+	return p_type == "SCALAR" ? 1 : p_type == "VEC2" ? 2 : p_type == "VEC3" ? 3 : p_type == "VEC4" ? 4 : 0;
+}
+
+// @brief Component p_component of element p_element as a float, normalized integers map to [0, 1] or [-1, 1]
+static float ComponentRead(const GltfAccessor& p_accessor, size_t p_element, uint32_t p_component) {
+	const std::byte* data = p_accessor.data + p_element * p_accessor.stride + p_component * ComponentSize(p_accessor.componentType);
+	bool normalized = p_accessor.normalized;
+	switch (p_accessor.componentType) {
+		case GLTF_FLOAT: {
+			float value;
+			std::memcpy(&value, data, sizeof(value));
+			return value;
+		}
+		case GLTF_BYTE: {
+			int8_t value;
+			std::memcpy(&value, data, sizeof(value));
+			return normalized ? std::max(value / 127.0f, -1.0f) : value;
+		}
+		case GLTF_UNSIGNED_BYTE: {
+			uint8_t value;
+			std::memcpy(&value, data, sizeof(value));
+			return normalized ? value / 255.0f : value;
+		}
+		case GLTF_SHORT: {
+			int16_t value;
+			std::memcpy(&value, data, sizeof(value));
+			return normalized ? std::max(value / 32767.0f, -1.0f) : value;
+		}
+		case GLTF_UNSIGNED_SHORT: {
+			uint16_t value;
+			std::memcpy(&value, data, sizeof(value));
+			return normalized ? value / 65535.0f : value;
+		}
+		default: {
+			uint32_t value;
+			std::memcpy(&value, data, sizeof(value));
+			return static_cast<float>(value);
+		}
+	}
+}
+
+static glm::vec3 Vec3Read(const GltfAccessor& p_accessor, size_t p_element) {
+	if (p_accessor.componentType == GLTF_FLOAT) {
+		glm::vec3 value;
+		std::memcpy(&value, p_accessor.data + p_element * p_accessor.stride, sizeof(value));
+		return value;
+	}
+	return glm::vec3(ComponentRead(p_accessor, p_element, 0), ComponentRead(p_accessor, p_element, 1), ComponentRead(p_accessor, p_element, 2));
+}
+
+static uint32_t IndexRead(const GltfAccessor& p_accessor, size_t p_element) {
+	const std::byte* data = p_accessor.data + p_element * p_accessor.stride;
+	switch (p_accessor.componentType) {
+		case GLTF_UNSIGNED_BYTE:
+			return static_cast<uint32_t>(*data);
+		case GLTF_UNSIGNED_SHORT: {
+			uint16_t value;
+			std::memcpy(&value, data, sizeof(value));
+			return value;
+		}
+		default: {
+			uint32_t value;
+			std::memcpy(&value, data, sizeof(value));
+			return value;
+		}
+	}
+}
+
+static bool Base64Decode(std::string_view p_text, std::vector<std::byte>& p_bytes) {
+	auto digit = [](char c) -> int {
+		return c >= 'A' && c <= 'Z' ? c - 'A'
+				: c >= 'a' && c <= 'z' ? c - 'a' + 26
+				: c >= '0' && c <= '9' ? c - '0' + 52
+				: c == '+'			   ? 62
+				: c == '/'			   ? 63
+									   : -1;
+	};
+	p_bytes.clear();
+	p_bytes.reserve(p_text.size() / 4 * 3);
+	uint32_t bits = 0;
+	int bitCount = 0;
+	for (char c : p_text) {
+		if (c == '=') {
+			break;
+		}
+		int value = digit(c);
+		if (value < 0) {
+			return false;
+		}
+		bits = (bits << 6) | static_cast<uint32_t>(value);
+		bitCount += 6;
+		if (bitCount >= 8) {
+			bitCount -= 8;
+			p_bytes.push_back(static_cast<std::byte>((bits >> bitCount) & 0xFF));
+		}
+	}
+	return true;
+}
+
+// @brief Point every buffer of the document at its bytes. Only the data URIs are decoded, the rest stays mapped.
+static bool BuffersResolve(
+		const JsonValue& p_document,
+		const std::filesystem::path& p_directory,
+		std::span<const std::byte> p_binaryChunk,
+		std::vector<GltfBuffer>& p_buffers
+) {
+	ZoneScoped;
+	const JsonValue* buffers = p_document.Find("buffers");
+	if (buffers == nullptr || buffers->type != JsonValue::Type::Array) {
+		return false;
+	}
+	p_buffers = std::vector<GltfBuffer>(buffers->items.size());
+	for (size_t i = 0; i < buffers->items.size(); ++i) {
+		const JsonValue& buffer = buffers->items[i];
+		GltfBuffer& output = p_buffers[i];
+		const JsonValue* uri = buffer.Find("uri");
+		if (uri == nullptr) {
+			// The first buffer of a .glb without a URI is its binary chunk.
+			if (i != 0 || p_binaryChunk.empty()) {
+				LOG_ERROR("glTF buffer %zu has no data", i);
+				return false;
+			}
+			output.bytes = p_binaryChunk;
+		} else if (uri->string.starts_with("data:")) {
+			size_t comma = uri->string.find(',');
+			if (comma == std::string_view::npos || !uri->string.substr(0, comma).ends_with(";base64")
+				|| !Base64Decode(uri->string.substr(comma + 1), output.decoded)) {
+				LOG_ERROR("glTF buffer %zu has an unsupported data URI", i);
+				return false;
+			}
+			output.bytes = output.decoded;
+		} else {
+			std::filesystem::path path = p_directory / std::string(uri->string);
+			if (!output.file.Open(path)) {
+				LOG_ERROR("Failed to open glTF buffer: %s", path.string().c_str());
+				return false;
+			}
+			output.bytes = std::span<const std::byte>(output.file.data, output.file.size);
+		}
+
+		if (buffer.Number("byteLength", 0.0) > static_cast<double>(output.bytes.size())) {
+			LOG_ERROR("glTF buffer %zu is shorter than its byteLength", i);
+			return false;
+		}
+	}
+	return true;
+}
+
+// @brief Resolve accessor p_index to the bytes it covers, checking every element lies inside its buffer view
+static bool AccessorResolve(
+		const JsonValue& p_document, const std::vector<GltfBuffer>& p_buffers, size_t p_index, GltfAccessor& accessor
+) {
+	const JsonValue* accessors = p_document.Find("accessors");
+	const JsonValue* json = accessors != nullptr ? accessors->At(p_index) : nullptr;
+	if (json == nullptr) {
+		return false;
+	}
+	if (json->Find("sparse") != nullptr) {
+		LOG_WARN("glTF accessor %zu is sparse, sparse accessors are not supported", p_index);
+		return false;
+	}
+
+	const JsonValue* view = json->Element(p_document, "bufferViews", "bufferView");
+	size_t bufferIndex = 0;
+	const JsonValue* type = json->Find("type");
+	if (view == nullptr || !view->Index("buffer", bufferIndex) || bufferIndex >= p_buffers.size() || type == nullptr) {
+		return false;
+	}
+
+	accessor.componentType = static_cast<uint32_t>(json->Number("componentType", 0.0));
+	accessor.components = ComponentCount(type->string);
+	accessor.count = static_cast<size_t>(std::max(json->Number("count", 0.0), 0.0));
+	const JsonValue* normalized = json->Find("normalized");
+	accessor.normalized = normalized != nullptr && normalized->number != 0.0;
+	size_t elementSize = static_cast<size_t>(ComponentSize(accessor.componentType)) * accessor.components;
+	if (elementSize == 0) {
+		return false;
+	}
+	accessor.stride = std::max<size_t>(static_cast<size_t>(std::max(view->Number("byteStride", 0.0), 0.0)), elementSize);
+
+	std::span<const std::byte> buffer = p_buffers[bufferIndex].bytes;
+	double viewOffset = view->Number("byteOffset", 0.0);
+	double viewLength = view->Number("byteLength", 0.0);
+	double accessorOffset = json->Number("byteOffset", 0.0);
+	double accessorEnd = accessor.count == 0
+			? accessorOffset
+			: accessorOffset + static_cast<double>(accessor.stride) * static_cast<double>(accessor.count - 1) + static_cast<double>(elementSize);
+	if (viewOffset < 0.0 || accessorOffset < 0.0 || viewOffset + viewLength > static_cast<double>(buffer.size())
+		|| accessorEnd > viewLength) {
+		LOG_ERROR("glTF accessor %zu reads outside of its buffer", p_index);
+		return false;
+	}
+	accessor.data = buffer.data() + static_cast<size_t>(viewOffset) + static_cast<size_t>(accessorOffset);
+	return true;
+}
+
+// ~~~~~~~~~~~~~
+// Scene
+// ~~~~~~~~~~~~~
+
+// A primitive placed by a node and where its vertices and indices land in the output.
+struct GltfDraw {
+	glm::mat4 transform;
+	// Mirroring transforms turn the triangles inside out, their winding is flipped back.
+	bool flip;
+	GltfAccessor positions;
+	GltfAccessor colors;
+	GltfAccessor indices;
+	glm::vec3 baseColor;
+	size_t firstVertex;
+	size_t firstIndex;
+	size_t indexCount;
+};
+
+// A run of vertices or indices of one draw.
+struct GltfUnit {
+	uint32_t draw;
+	bool indices;
+	size_t begin;
+	size_t end;
+};
+
+static glm::mat4 NodeTransform(const JsonValue& p_node) {
+	const JsonValue* matrix = p_node.Find("matrix");
+	if (matrix != nullptr && matrix->items.size() == 16) {
+		// Column major, like glm.
+		glm::mat4 transform;
+		for (int i = 0; i < 16; ++i) {
+			transform[i / 4][i % 4] = static_cast<float>(matrix->items[i].number);
+		}
+		return transform;
+	}
+
+	auto vector = [&p_node](std::string_view p_key, glm::vec4 p_fallback) {
+		const JsonValue* value = p_node.Find(p_key);
+		for (size_t i = 0; value != nullptr && i < std::min<size_t>(value->items.size(), 4); ++i) {
+			p_fallback[static_cast<int>(i)] = static_cast<float>(value->items[i].number);
+		}
+		return p_fallback;
+	};
+	glm::vec4 translation = vector("translation", glm::vec4(0.0f));
+	glm::vec4 rotation = vector("rotation", glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+	glm::vec4 scale = vector("scale", glm::vec4(1.0f));
+	return glm::translate(glm::mat4(1.0f), glm::vec3(translation))
+			* glm::mat4_cast(glm::quat(rotation.w, rotation.x, rotation.y, rotation.z))
+			* glm::scale(glm::mat4(1.0f), glm::vec3(scale));
+}
+
+// glTF colors are linear, the fragment shader expects sRGB vertex colors. A table keeps pow out of the per
+// vertex loop, 4096 steps are finer than the 8 bits the colors end up in.
+static constexpr size_t SRGB_TABLE_SIZE = 4096;
+
+static glm::vec3 LinearToSrgb(glm::vec3 p_color) {
+	static const std::vector<float> table = []() {
+		std::vector<float> values(SRGB_TABLE_SIZE);
+		for (size_t i = 0; i < SRGB_TABLE_SIZE; ++i) {
+			values[i] = std::pow(static_cast<float>(i) / static_cast<float>(SRGB_TABLE_SIZE - 1), 1.0f / 2.2f);
+		}
+		return values;
+	}();
+	glm::vec3 scaled = glm::clamp(p_color, glm::vec3(0.0f), glm::vec3(1.0f)) * static_cast<float>(SRGB_TABLE_SIZE - 1) + 0.5f;
+	return glm::vec3(table[static_cast<size_t>(scaled.r)], table[static_cast<size_t>(scaled.g)], table[static_cast<size_t>(scaled.b)]);
+}
+
+// @brief Append a draw for every triangle primitive of p_mesh
+static void MeshDraws(
+		const JsonValue& p_document,
+		const std::vector<GltfBuffer>& p_buffers,
+		const JsonValue& p_mesh,
+		const glm::mat4& p_transform,
+		std::vector<GltfDraw>& p_draws
+) {
+	const JsonValue* primitives = p_mesh.Find("primitives");
+	if (primitives == nullptr) {
+		return;
+	}
+	for (const JsonValue& primitive : primitives->items) {
+		if (primitive.Number("mode", GLTF_TRIANGLES) != GLTF_TRIANGLES) {
+			LOG_WARN("Skipping a glTF primitive that is not a triangle list");
+			continue;
+		}
+
+		GltfDraw draw = {};
+		draw.transform = p_transform;
+		draw.flip = glm::determinant(p_transform) < 0.0f;
+		const JsonValue* attributes = primitive.Find("attributes");
+		size_t index = 0;
+		if (attributes == nullptr || !attributes->Index("POSITION", index)
+			|| !AccessorResolve(p_document, p_buffers, index, draw.positions) || draw.positions.components != 3) {
+			LOG_WARN("Skipping a glTF primitive without valid positions");
+			continue;
+		}
+		// Colors are read for every position, fewer of them would read past the accessor.
+		if (attributes->Index("COLOR_0", index) && (!AccessorResolve(p_document, p_buffers, index, draw.colors)
+													 || draw.colors.components < 3
+													 || draw.colors.count < draw.positions.count)) {
+			LOG_WARN("Ignoring invalid glTF vertex colors");
+			draw.colors = {};
+		}
+		if (primitive.Index("indices", index)) {
+			if (!AccessorResolve(p_document, p_buffers, index, draw.indices) || draw.indices.components != 1
+				|| (draw.indices.componentType != GLTF_UNSIGNED_BYTE && draw.indices.componentType != GLTF_UNSIGNED_SHORT
+					&& draw.indices.componentType != GLTF_UNSIGNED_INT)) {
+				LOG_WARN("Skipping a glTF primitive with invalid indices");
+				continue;
+			}
+		}
+		draw.indexCount = (draw.indices.data != nullptr ? draw.indices.count : draw.positions.count) / 3 * 3;
+
+		draw.baseColor = glm::vec3(1.0f);
+		const JsonValue* material = primitive.Element(p_document, "materials", "material");
+		const JsonValue* pbr = material != nullptr ? material->Find("pbrMetallicRoughness") : nullptr;
+		const JsonValue* factor = pbr != nullptr ? pbr->Find("baseColorFactor") : nullptr;
+		for (size_t i = 0; factor != nullptr && i < std::min<size_t>(factor->items.size(), 3); ++i) {
+			draw.baseColor[static_cast<int>(i)] = static_cast<float>(factor->items[i].number);
+		}
+		p_draws.push_back(draw);
+	}
+}
+
+static bool NodeVisit(
+		const JsonValue& p_document,
+		const std::vector<GltfBuffer>& p_buffers,
+		size_t p_node,
+		const glm::mat4& p_parent,
+		uint32_t p_depth,
+		std::vector<GltfDraw>& p_draws
+) {
+	const JsonValue* nodes = p_document.Find("nodes");
+	const JsonValue* node = nodes != nullptr ? nodes->At(p_node) : nullptr;
+	if (node == nullptr || p_depth > MAX_DEPTH) {
+		LOG_ERROR("glTF node %zu is missing or nested too deep", p_node);
+		return false;
+	}
+
+	glm::mat4 transform = p_parent * NodeTransform(*node);
+	const JsonValue* mesh = node->Element(p_document, "meshes", "mesh");
+	if (mesh != nullptr) {
+		MeshDraws(p_document, p_buffers, *mesh, transform, p_draws);
+	}
+	const JsonValue* children = node->Find("children");
+	for (size_t i = 0; children != nullptr && i < children->items.size(); ++i) {
+		size_t child = static_cast<size_t>(std::max(children->items[i].number, 0.0));
+		if (!NodeVisit(p_document, p_buffers, child, transform, p_depth + 1, p_draws)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// @brief Write the vertices or indices p_unit covers
+static bool UnitConvert(const GltfUnit& p_unit, const GltfDraw& p_draw, Vertex* p_vertices, uint32_t* p_indices) {
+	if (!p_unit.indices) {
+		Vertex* output = p_vertices + p_draw.firstVertex;
+		glm::vec3 color = LinearToSrgb(p_draw.baseColor);
+		const GltfAccessor& positions = p_draw.positions;
+		const GltfAccessor& colors = p_draw.colors;
+		for (size_t i = p_unit.begin; i < p_unit.end; ++i) {
+			output[i].position = glm::vec3(p_draw.transform * glm::vec4(Vec3Read(positions, i), 1.0f));
+			if (colors.data != nullptr) {
+				output[i].color = LinearToSrgb(Vec3Read(colors, i) * p_draw.baseColor);
+			} else {
+				output[i].color = color;
+			}
+		}
+		return true;
+	}
+
+	uint32_t* output = p_indices + p_draw.firstIndex;
+	size_t vertexCount = p_draw.positions.count;
+	bool indexed = p_draw.indices.data != nullptr;
+	bool valid = true;
+	for (size_t i = p_unit.begin; i < p_unit.end; ++i) {
+		// Mirrored: corners 1 and 2 of every triangle swap places.
+		size_t corner = i % 3;
+		size_t source = !p_draw.flip || corner == 0 ? i : corner == 1 ? i + 1 : i - 1;
+		uint32_t index = indexed ? IndexRead(p_draw.indices, source) : static_cast<uint32_t>(source);
+		valid &= index < vertexCount;
+		output[i] = static_cast<uint32_t>(p_draw.firstVertex) + std::min<uint32_t>(index, static_cast<uint32_t>(vertexCount - 1));
+	}
+	return valid;
+}
+
+static bool GlbSplit(std::span<const std::byte> p_file, std::string_view& json, std::span<const std::byte>& binary) {
+	auto word = [&p_file](size_t p_offset) {
+		uint32_t value = 0;
+		std::memcpy(&value, p_file.data() + p_offset, sizeof(value));
+		return value;
+	};
+	if (p_file.size() < 12 || word(0) != GLB_MAGIC || word(4) != 2) {
+		return false;
+	}
+	size_t length = std::min<size_t>(word(8), p_file.size());
+	for (size_t offset = 12; offset + 8 <= length;) {
+		size_t chunkLength = word(offset);
+		uint32_t chunkType = word(offset + 4);
+		if (chunkLength > length - offset - 8) {
+			return false;
+		}
+		const std::byte* chunk = p_file.data() + offset + 8;
+		if (chunkType == GLB_CHUNK_JSON && json.empty()) {
+			json = std::string_view(reinterpret_cast<const char*>(chunk), chunkLength);
+		} else if (chunkType == GLB_CHUNK_BIN && binary.empty()) {
+			binary = std::span<const std::byte>(chunk, chunkLength);
+		}
+		offset += 8 + ((chunkLength + 3) & ~size_t(3));
+	}
+	return !json.empty();
+}
+
+// @brief Parse the JSON, walk the default scene into draws, size the outputs once from the accessor counts, then
+// convert the draws in units spread evenly over the threads.
+bool GeometryParseGltf(const std::filesystem::path& p_path, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+	ZoneScoped;
+	vertices.clear();
+	indices.clear();
+
+	RdMappedFile file;
+	if (!file.Open(p_path)) {
+		LOG_ERROR("Failed to open glTF: %s", p_path.string().c_str());
+		return false;
+	}
+	std::span<const std::byte> bytes(file.data, file.size);
+	std::string_view text(reinterpret_cast<const char*>(file.data), file.size);
+	std::span<const std::byte> binaryChunk;
+	if (p_path.extension() == ".glb") {
+		text = {};
+		if (!GlbSplit(bytes, text, binaryChunk)) {
+			LOG_ERROR("Malformed GLB container: %s", p_path.string().c_str());
+			return false;
+		}
+	}
+
+	JsonValue document;
+	JsonParser parser = { text.data(), text.data() + text.size() };
+	{
+		ZoneScopedN("Parse JSON");
+		if (!parser.Value(document, 0) || document.type != JsonValue::Type::Object) {
+			LOG_ERROR("Malformed glTF JSON: %s", p_path.string().c_str());
+			return false;
+		}
+	}
+
+	const JsonValue* asset = document.Find("asset");
+	const JsonValue* version = asset != nullptr ? asset->Find("version") : nullptr;
+	if (version == nullptr || !version->string.starts_with("2.")) {
+		LOG_ERROR("Not a glTF 2.0 asset: %s", p_path.string().c_str());
+		return false;
+	}
+
+	std::vector<GltfBuffer> buffers;
+	if (!BuffersResolve(document, p_path.parent_path(), binaryChunk, buffers)) {
+		return false;
+	}
+
+	// The default scene, or every mesh once when the file has no scenes.
+	std::vector<GltfDraw> draws;
+	const JsonValue* scene = document.Element(document, "scenes", "scene");
+	const JsonValue* scenes = document.Find("scenes");
+	if (scene == nullptr && scenes != nullptr) {
+		scene = scenes->At(0);
+	}
+	if (scene != nullptr) {
+		const JsonValue* roots = scene->Find("nodes");
+		for (size_t i = 0; roots != nullptr && i < roots->items.size(); ++i) {
+			size_t root = static_cast<size_t>(std::max(roots->items[i].number, 0.0));
+			if (!NodeVisit(document, buffers, root, glm::mat4(1.0f), 0, draws)) {
+				return false;
+			}
+		}
+	} else if (const JsonValue* meshes = document.Find("meshes")) {
+		for (const JsonValue& mesh : meshes->items) {
+			MeshDraws(document, buffers, mesh, glm::mat4(1.0f), draws);
+		}
+	}
+
+	size_t vertexCount = 0;
+	size_t indexCount = 0;
+	for (GltfDraw& draw : draws) {
+		draw.firstVertex = vertexCount;
+		draw.firstIndex = indexCount;
+		vertexCount += draw.positions.count;
+		indexCount += draw.indexCount;
+	}
+	if (vertexCount > UINT32_MAX) {
+		LOG_ERROR("glTF with %zu vertices exceeds 32-bit indices", vertexCount);
+		return false;
+	}
+
+	// Units of at most UNIT_ELEMENTS, handed out in contiguous runs of equal size to one thread each.
+	std::vector<GltfUnit> units;
+	for (uint32_t d = 0; d < draws.size(); ++d) {
+		for (size_t begin = 0; begin < draws[d].positions.count; begin += UNIT_ELEMENTS) {
+			units.push_back({ d, false, begin, std::min(begin + UNIT_ELEMENTS, draws[d].positions.count) });
+		}
+		for (size_t begin = 0; begin < draws[d].indexCount; begin += UNIT_ELEMENTS) {
+			units.push_back({ d, true, begin, std::min(begin + UNIT_ELEMENTS, draws[d].indexCount) });
+		}
+	}
+	size_t elementCount = vertexCount + indexCount;
+	size_t threadCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+	size_t runCount = std::clamp<size_t>(elementCount / (UNIT_ELEMENTS * 4), 1, threadCount);
+	std::vector<std::span<const GltfUnit>> runs;
+	size_t runBegin = 0;
+	size_t elements = 0;
+	for (size_t u = 0; u < units.size(); ++u) {
+		elements += units[u].end - units[u].begin;
+		if (elements * runCount >= elementCount * (runs.size() + 1) || u + 1 == units.size()) {
+			runs.emplace_back(units.data() + runBegin, u + 1 - runBegin);
+			runBegin = u + 1;
+		}
+	}
+
+	vertices.resize(vertexCount);
+	indices.resize(indexCount);
+	std::atomic<bool> valid = true;
+	ParseRunParallel(runs, [&](std::span<const GltfUnit> run) {
+		ZoneScopedN("Convert glTF");
+		for (const GltfUnit& unit : run) {
+			if (!UnitConvert(unit, draws[unit.draw], vertices.data(), indices.data())) {
+				valid = false;
+			}
+		}
+	});
+
+	if (!valid) {
+		LOG_ERROR("glTF indices reference missing vertices: %s", p_path.string().c_str());
+		vertices.clear();
+		indices.clear();
+		return false;
+	}
+	LOG_TRACE("glTF: %zu draws, %zu vertices, %zu triangles", draws.size(), vertexCount, indexCount / 3);
+	return true;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "../renderer/Vertex.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+// Import the triangles of the default scene of a glTF 2.0 asset, a .gltf with external or base64 buffers or a
+// .glb with its binary chunk. Every primitive is flattened into one mesh with its node transform applied, colored
+// by COLOR_0 times the base color factor of its material. Buffers are memory-mapped and their views read in place,
+// straight into the output, on one thread per hardware thread.
+bool GeometryParseGltf(const std::filesystem::path& p_path, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
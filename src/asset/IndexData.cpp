@@ -0,0 +1,48 @@
+#include "IndexData.hpp"
+
+#include "tracy/Tracy.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+// @brief Pick Uint16 when every index is below 0xFFFF, which is reserved as the strip restart value
+RdIndexFormat IndexFormatSelect(std::span<const uint32_t> p_indices) {
+	ZoneScoped;
+	uint32_t maxIndex = p_indices.empty() ? 0 : *std::max_element(p_indices.begin(), p_indices.end());
+	return maxIndex < 0xFFFF ? RdIndexFormat::Uint16 : RdIndexFormat::Uint32;
+}
+
+RdIndexData IndexDataPack(std::span<const uint32_t> p_indices) {
+	ZoneScoped;
+	RdIndexData data;
+	data.format = IndexFormatSelect(p_indices);
+	data.count = static_cast<uint32_t>(p_indices.size());
+
+	size_t stride = static_cast<size_t>(data.format);
+	data.bytes.resize((p_indices.size() * stride + 3) & ~size_t(3));
+
+	if (data.format == RdIndexFormat::Uint32) {
+		std::memcpy(data.bytes.data(), p_indices.data(), p_indices.size_bytes());
+	} else {
+		auto* narrow = reinterpret_cast<uint16_t*>(data.bytes.data());
+		std::transform(p_indices.begin(), p_indices.end(), narrow, [](uint32_t index) {
+			return static_cast<uint16_t>(index);
+		});
+	}
+	return data;
+}
+
+std::vector<uint32_t> IndexDataUnpack(const std::byte* p_data, RdIndexFormat p_format, uint32_t p_count) {
+	ZoneScoped;
+	std::vector<uint32_t> indices(p_count);
+	if (p_format == RdIndexFormat::Uint32) {
+		std::memcpy(indices.data(), p_data, p_count * sizeof(uint32_t));
+	} else {
+		for (uint32_t i = 0; i < p_count; ++i) {
+			uint16_t index;
+			std::memcpy(&index, p_data + i * sizeof(uint16_t), sizeof(uint16_t));
+			indices[i] = index;
+		}
+	}
+	return indices;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// The value is the size of one index in bytes.
+enum class RdIndexFormat : uint32_t {
+	Uint16 = 2,
+	Uint32 = 4,
+};
+
+// Index data packed in the narrowest format that addresses every referenced vertex.
+// Meshes whose indices all fit in 16 bits keep the bandwidth savings, larger ones switch to 32 bits.
+struct RdIndexData {
+	RdIndexFormat format = RdIndexFormat::Uint16;
+	uint32_t count = 0;
+	// Padded to a multiple of 4 bytes so it can be uploaded as is.
+	std::vector<std::byte> bytes;
+};
+
+RdIndexFormat IndexFormatSelect(std::span<const uint32_t> p_indices);
+RdIndexData IndexDataPack(std::span<const uint32_t> p_indices);
+// @brief Widen p_count indices stored in p_format at p_data back to 32 bits
+std::vector<uint32_t> IndexDataUnpack(const std::byte* p_data, RdIndexFormat p_format, uint32_t p_count);
@@ -0,0 +1,118 @@
+#include "MappedFile.hpp"
+
+#include "logging_macros.h"
+#include "tracy/Tracy.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif	// _WIN32
+
+#include <utility>
+
+bool RdMappedFile::Open(const std::filesystem::path& p_path) {
+	ZoneScoped;
+	Close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileW(
+			p_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr
+	);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr) {
+		CloseHandle(file);
+		return false;
+	}
+
+	void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == nullptr) {
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	m_file = file;
+	m_mapping = mapping;
+	data = static_cast<const std::byte*>(view);
+	size = static_cast<size_t>(fileSize.QuadPart);
+#else
+	int fd = open(p_path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size == 0) {
+		close(fd);
+		return false;
+	}
+
+	void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	// The mapping keeps its own reference to the file.
+	close(fd);
+	if (view == MAP_FAILED) {
+		return false;
+	}
+
+	data = static_cast<const std::byte*>(view);
+	size = static_cast<size_t>(info.st_size);
+#endif	// _WIN32
+
+	LOG_TRACE("File mapped: %s (%zu bytes)", p_path.string().c_str(), size);
+	return true;
+}
+
+void RdMappedFile::Close() {
+	if (data == nullptr) {
+		return;
+	}
+
+#ifdef _WIN32
+	UnmapViewOfFile(data);
+	CloseHandle(m_mapping);
+	CloseHandle(m_file);
+	m_mapping = nullptr;
+	m_file = nullptr;
+#else
+	munmap(const_cast<std::byte*>(data), size);
+#endif	// _WIN32
+
+	data = nullptr;
+	size = 0;
+}
+
+RdMappedFile::~RdMappedFile() {
+	Close();
+}
+
+RdMappedFile::RdMappedFile(RdMappedFile&& other) noexcept {
+	*this = std::move(other);
+}
+
+RdMappedFile& RdMappedFile::operator=(RdMappedFile&& other) noexcept {
+	if (this != &other) {
+		Close();
+		data = std::exchange(other.data, nullptr);
+		size = std::exchange(other.size, 0);
+#ifdef _WIN32
+		m_file = std::exchange(other.m_file, nullptr);
+		m_mapping = std::exchange(other.m_mapping, nullptr);
+#endif	// _WIN32
+	}
+	return *this;
+}
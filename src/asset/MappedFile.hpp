@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+// Read-only memory mapping of a whole file. The mapping lives as long as the object, so spans handed out
+// from it must not outlive it.
+struct RdMappedFile {
+	bool Open(const std::filesystem::path& p_path);
+	void Close();
+
+	RdMappedFile() = default;
+	~RdMappedFile();
+
+	RdMappedFile(const RdMappedFile&) = delete;
+	RdMappedFile& operator=(const RdMappedFile&) = delete;
+
+	RdMappedFile(RdMappedFile&& other) noexcept;
+	RdMappedFile& operator=(RdMappedFile&& other) noexcept;
+
+	const std::byte* data = nullptr;
+	size_t size = 0;
+
+private:
+#ifdef _WIN32
+	void* m_file = nullptr;
+	void* m_mapping = nullptr;
+#endif	// _WIN32
+};
@@ -0,0 +1,171 @@
+#include "MeshFile.hpp"
+
+#include "logging_macros.h"
+#include "tracy/Tracy.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+static uint64_t AlignUp(uint64_t p_value, uint64_t p_alignment) {
+	return (p_value + p_alignment - 1) & ~(p_alignment - 1);
+}
+
+static void WritePadding(std::ofstream& p_file, uint64_t p_from, uint64_t p_to) {
+	static const char zeros[RD_MESH_BLOCK_ALIGNMENT] = {};
+	p_file.write(zeros, static_cast<std::streamsize>(p_to - p_from));
+}
+
+bool MeshFileWrite(
+		const std::filesystem::path& p_path,
+		std::span<const Vertex> p_vertices,
+		const RdIndexData& p_indices,
+		std::span<const RdMeshLod> p_lods
+) {
+	ZoneScoped;
+	std::ofstream file(p_path, std::ios::binary | std::ios::trunc);
+	if (!file) {
+		LOG_ERROR("Failed to open mesh file for writing: %s", p_path.string().c_str());
+		return false;
+	}
+
+	RdMeshFileHeader header = {
+		.magic = { RD_MESH_MAGIC[0], RD_MESH_MAGIC[1], RD_MESH_MAGIC[2], RD_MESH_MAGIC[3] },
+		.version = RD_MESH_VERSION,
+		.vertexCount = static_cast<uint32_t>(p_vertices.size()),
+		.vertexStride = sizeof(Vertex),
+		.indexCount = p_indices.count,
+		.indexStride = static_cast<uint32_t>(p_indices.format),
+		.vertexOffset = AlignUp(sizeof(RdMeshFileHeader), RD_MESH_BLOCK_ALIGNMENT),
+		.vertexBytes = AlignUp(p_vertices.size_bytes(), RD_MESH_COPY_ALIGNMENT),
+		.indexOffset = 0,
+		.indexBytes = AlignUp(p_indices.bytes.size(), RD_MESH_COPY_ALIGNMENT),
+		.lodCount = static_cast<uint32_t>(p_lods.size()),
+		.lodStride = sizeof(RdMeshLod),
+		.lodOffset = 0,
+	};
+	header.indexOffset = AlignUp(header.vertexOffset + header.vertexBytes, RD_MESH_BLOCK_ALIGNMENT);
+	header.lodOffset = AlignUp(header.indexOffset + header.indexBytes, RD_MESH_BLOCK_ALIGNMENT);
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	WritePadding(file, sizeof(header), header.vertexOffset);
+
+	file.write(reinterpret_cast<const char*>(p_vertices.data()), static_cast<std::streamsize>(p_vertices.size_bytes()));
+	WritePadding(file, header.vertexOffset + p_vertices.size_bytes(), header.indexOffset);
+
+	file.write(reinterpret_cast<const char*>(p_indices.bytes.data()), static_cast<std::streamsize>(p_indices.bytes.size()));
+	WritePadding(file, header.indexOffset + p_indices.bytes.size(), header.lodOffset);
+
+	file.write(reinterpret_cast<const char*>(p_lods.data()), static_cast<std::streamsize>(p_lods.size_bytes()));
+
+	if (!file) {
+		LOG_ERROR("Failed to write mesh file: %s", p_path.string().c_str());
+		return false;
+	}
+
+	LOG_INFO("Mesh file written: %s (%u vertices, %u indices, %u levels)",
+			 p_path.string().c_str(), header.vertexCount, header.indexCount, header.lodCount);
+	return true;
+}
+
+// @brief p_bytes starting at p_offset fit in p_size, written so that no sum can wrap
+static bool BlockInBounds(uint64_t p_offset, uint64_t p_bytes, uint64_t p_size) {
+	return p_offset <= p_size && p_bytes <= p_size - p_offset;
+}
+
+// @brief Every index of the block names one of p_vertexCount vertices
+template<typename Index>
+static bool IndicesInBounds(const std::byte* p_block, uint32_t p_indexCount, uint32_t p_vertexCount) {
+	const auto* indices = reinterpret_cast<const Index*>(p_block);
+	Index highest = 0;
+	for (uint32_t i = 0; i < p_indexCount; ++i) {
+		highest = std::max(highest, indices[i]);
+	}
+	return p_indexCount == 0 || highest < p_vertexCount;
+}
+
+bool RdMeshFile::Open(const std::filesystem::path& p_path) {
+	ZoneScoped;
+	header = nullptr;
+	if (!file.Open(p_path)) {
+		return false;
+	}
+
+	if (file.size < sizeof(RdMeshFileHeader)) {
+		LOG_ERROR("Mesh file is truncated: %s", p_path.string().c_str());
+		return false;
+	}
+
+	const auto* candidate = reinterpret_cast<const RdMeshFileHeader*>(file.data);
+	if (std::memcmp(candidate->magic, RD_MESH_MAGIC, sizeof(RD_MESH_MAGIC)) != 0) {
+		LOG_ERROR("Not a mesh file: %s", p_path.string().c_str());
+		return false;
+	}
+	if (candidate->version != RD_MESH_VERSION) {
+		LOG_ERROR("Unsupported mesh file version %u: %s", candidate->version, p_path.string().c_str());
+		return false;
+	}
+	bool indexStrideValid = candidate->indexStride == static_cast<uint32_t>(RdIndexFormat::Uint16)
+			|| candidate->indexStride == static_cast<uint32_t>(RdIndexFormat::Uint32);
+	if (candidate->vertexStride != sizeof(Vertex) || !indexStrideValid || candidate->lodStride != sizeof(RdMeshLod)) {
+		LOG_ERROR("Mesh file layout does not match this build: %s", p_path.string().c_str());
+		return false;
+	}
+
+	bool blocksValid = candidate->vertexOffset % RD_MESH_BLOCK_ALIGNMENT == 0
+			&& candidate->indexOffset % RD_MESH_BLOCK_ALIGNMENT == 0
+			&& candidate->vertexBytes >= uint64_t(candidate->vertexCount) * candidate->vertexStride
+			&& candidate->indexBytes >= uint64_t(candidate->indexCount) * candidate->indexStride
+			&& BlockInBounds(candidate->vertexOffset, candidate->vertexBytes, file.size)
+			&& BlockInBounds(candidate->indexOffset, candidate->indexBytes, file.size)
+			&& candidate->lodOffset % RD_MESH_BLOCK_ALIGNMENT == 0
+			&& candidate->lodCount >= 1 && candidate->lodCount <= RD_MESH_MAX_LODS
+			&& BlockInBounds(candidate->lodOffset, uint64_t(candidate->lodCount) * candidate->lodStride, file.size);
+	if (!blocksValid) {
+		LOG_ERROR("Mesh file blocks are out of bounds: %s", p_path.string().c_str());
+		return false;
+	}
+
+	const auto* lods = reinterpret_cast<const RdMeshLod*>(file.data + candidate->lodOffset);
+	for (uint32_t l = 0; l < candidate->lodCount; ++l) {
+		if (uint64_t(lods[l].firstIndex) + lods[l].indexCount > candidate->indexCount) {
+			LOG_ERROR("Mesh file level %u is out of bounds: %s", l, p_path.string().c_str());
+			return false;
+		}
+	}
+
+	// The draws read vertices by these indices on the GPU, none may point past the vertex block.
+	const std::byte* indexBlock = file.data + candidate->indexOffset;
+	bool indicesValid = candidate->indexStride == static_cast<uint32_t>(RdIndexFormat::Uint16)
+			? IndicesInBounds<uint16_t>(indexBlock, candidate->indexCount, candidate->vertexCount)
+			: IndicesInBounds<uint32_t>(indexBlock, candidate->indexCount, candidate->vertexCount);
+	if (!indicesValid) {
+		LOG_ERROR("Mesh file indices are out of bounds: %s", p_path.string().c_str());
+		return false;
+	}
+
+	header = candidate;
+	LOG_INFO("Mesh file mapped: %s (%u vertices, %u indices, %u levels)",
+			 p_path.string().c_str(), header->vertexCount, header->indexCount, header->lodCount);
+	return true;
+}
+
+std::span<const Vertex> RdMeshFile::Vertices() const {
+	return { reinterpret_cast<const Vertex*>(VertexBlock()), header->vertexCount };
+}
+
+std::span<const RdMeshLod> RdMeshFile::Lods() const {
+	return { reinterpret_cast<const RdMeshLod*>(file.data + header->lodOffset), header->lodCount };
+}
+
+RdIndexFormat RdMeshFile::IndexFormat() const {
+	return static_cast<RdIndexFormat>(header->indexStride);
+}
+
+const std::byte* RdMeshFile::VertexBlock() const {
+	return file.data + header->vertexOffset;
+}
+
+const std::byte* RdMeshFile::IndexBlock() const {
+	return file.data + header->indexOffset;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "../renderer/Vertex.hpp"
+#include "IndexData.hpp"
+#include "MappedFile.hpp"
+#include "MeshLod.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+// ~~~~~~~~~~~~~
+// Binary mesh container (.rdmesh), little-endian.
+//
+//   RdMeshFileHeader
+//   vertex block: vertexCount * Vertex
+//   index block:  indexCount * indexStride bytes, indexStride is 2 or 4 (see RdIndexFormat)
+//   lod block:    lodCount * RdMeshLod, ranges of the index block, level 0 first (see MeshLod.hpp)
+//
+// Blocks start at RD_MESH_BLOCK_ALIGNMENT and their byte sizes are padded to RD_MESH_COPY_ALIGNMENT,
+// so a mapped block can be passed to wgpuQueueWriteBuffer or copied into a mappedAtCreation buffer as is.
+// ~~~~~~~~~~~~~
+constexpr char RD_MESH_MAGIC[4] = { 'R', 'D', 'M', 'S' };
+constexpr uint32_t RD_MESH_VERSION = 2;
+constexpr uint64_t RD_MESH_BLOCK_ALIGNMENT = 16;
+constexpr uint64_t RD_MESH_COPY_ALIGNMENT = 4;
+
+struct RdMeshFileHeader {
+	char magic[4];
+	uint32_t version;
+	uint32_t vertexCount;
+	uint32_t vertexStride;
+	uint32_t indexCount;
+	uint32_t indexStride;
+	uint64_t vertexOffset;
+	uint64_t vertexBytes;
+	uint64_t indexOffset;
+	uint64_t indexBytes;
+	uint32_t lodCount;
+	uint32_t lodStride;
+	uint64_t lodOffset;
+};
+static_assert(sizeof(RdMeshFileHeader) == 72, "RdMeshFileHeader layout is part of the file format");
+
+bool MeshFileWrite(
+		const std::filesystem::path& p_path,
+		std::span<const Vertex> p_vertices,
+		const RdIndexData& p_indices,
+		std::span<const RdMeshLod> p_lods
+);
+
+// A validated, memory-mapped .rdmesh file: every block lies inside the file and every index and level inside the
+// vertex and index blocks, files from anywhere can be opened. Vertex and index data point straight into the mapping.
+struct RdMeshFile {
+	bool Open(const std::filesystem::path& p_path);
+
+	std::span<const Vertex> Vertices() const;
+	std::span<const RdMeshLod> Lods() const;
+	RdIndexFormat IndexFormat() const;
+	const std::byte* VertexBlock() const;
+	const std::byte* IndexBlock() const;
+
+	const RdMeshFileHeader* header = nullptr;
+	RdMappedFile file;
+};
@@ -0,0 +1,406 @@
+#include "MeshLod.hpp"
+
+#include "MeshOptimize.hpp"
+#include "logging_macros.h"
+#include "tracy/Tracy.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+// Border planes outweigh face planes, so collapses pulling the border inwards come last.
+static constexpr double BORDER_WEIGHT = 10.0;
+// Smallest cosine between a face normal before and after a collapse, anything sharper counts as a flip.
+static constexpr double FLIP_COSINE = 0.2;
+
+// Weighted sum of squared distances to a set of planes, the symmetric matrix [A b; b^T c] of Garland and
+// Heckbert stored as its upper triangle.
+struct Quadric {
+	double xx = 0.0, xy = 0.0, xz = 0.0, yy = 0.0, yz = 0.0, zz = 0.0;
+	double x = 0.0, y = 0.0, z = 0.0;
+	double c = 0.0;
+	// Sum of the plane weights, dividing by it turns the sum into a mean.
+	double weight = 0.0;
+
+	// Plane dot(p_normal, p) + p_distance = 0, p_normal of unit length.
+	void PlaneAdd(const glm::dvec3& p_normal, double p_distance, double p_weight) {
+		xx += p_weight * p_normal.x * p_normal.x;
+		xy += p_weight * p_normal.x * p_normal.y;
+		xz += p_weight * p_normal.x * p_normal.z;
+		yy += p_weight * p_normal.y * p_normal.y;
+		yz += p_weight * p_normal.y * p_normal.z;
+		zz += p_weight * p_normal.z * p_normal.z;
+		x += p_weight * p_normal.x * p_distance;
+		y += p_weight * p_normal.y * p_distance;
+		z += p_weight * p_normal.z * p_distance;
+		c += p_weight * p_distance * p_distance;
+		weight += p_weight;
+	}
+
+	Quadric& operator+=(const Quadric& p_other) {
+		xx += p_other.xx;
+		xy += p_other.xy;
+		xz += p_other.xz;
+		yy += p_other.yy;
+		yz += p_other.yz;
+		zz += p_other.zz;
+		x += p_other.x;
+		y += p_other.y;
+		z += p_other.z;
+		c += p_other.c;
+		weight += p_other.weight;
+		return *this;
+	}
+
+	double Evaluate(const glm::dvec3& p) const {
+		double quadratic = xx * p.x * p.x + yy * p.y * p.y + zz * p.z * p.z
+				+ 2.0 * (xy * p.x * p.y + xz * p.x * p.z + yz * p.y * p.z);
+		return quadratic + 2.0 * (x * p.x + y * p.y + z * p.z) + c;
+	}
+};
+
+enum class VertexKind : uint8_t {
+	Interior,
+	Border,	 // On exactly two border edges, slides along them.
+	Locked,	 // Seam, non-manifold or otherwise unsafe to move.
+};
+
+// @brief Lock vertices sharing their position with another one, vertices on edges used by more than two triangles
+// and vertices that are not on exactly zero or two border edges
+static std::vector<VertexKind> VertexKindsClassify(
+		std::span<const Vertex> p_vertices,
+		std::span<const uint32_t> p_indices,
+		const RdTriangleAdjacency& p_adjacency
+) {
+	ZoneScoped;
+	struct PositionHash {
+		size_t operator()(const glm::vec3& p_position) const {
+			uint32_t words[3];
+			std::memcpy(words, &p_position, sizeof(words));
+			return static_cast<size_t>((words[0] * 73856093u) ^ (words[1] * 19349663u) ^ (words[2] * 83492791u));
+		}
+	};
+
+	std::vector<VertexKind> kinds(p_vertices.size(), VertexKind::Interior);
+	std::unordered_map<glm::vec3, uint32_t, PositionHash> firstAt;
+	firstAt.reserve(p_vertices.size());
+	for (uint32_t v = 0; v < p_vertices.size(); ++v) {
+		auto [entry, inserted] = firstAt.try_emplace(p_vertices[v].position, v);
+		if (!inserted) {
+			kinds[v] = VertexKind::Locked;
+			kinds[entry->second] = VertexKind::Locked;
+		}
+	}
+
+	std::vector<uint8_t> borderEdges(p_vertices.size(), 0);
+	for (size_t i = 0; i < p_indices.size(); ++i) {
+		uint32_t a = p_indices[i];
+		uint32_t b = p_indices[i - i % 3 + (i + 1) % 3];
+		uint32_t shared = 0;
+		for (uint32_t t = p_adjacency.offsets[a]; t < p_adjacency.offsets[a + 1]; ++t) {
+			const uint32_t* corners = &p_indices[p_adjacency.triangles[t] * 3];
+			shared += corners[0] == b || corners[1] == b || corners[2] == b;
+		}
+		if (shared > 2) {
+			kinds[a] = VertexKind::Locked;
+			kinds[b] = VertexKind::Locked;
+		} else if (shared == 1) {
+			borderEdges[a] = static_cast<uint8_t>(std::min(borderEdges[a] + 1, 3));
+			borderEdges[b] = static_cast<uint8_t>(std::min(borderEdges[b] + 1, 3));
+		}
+	}
+
+	for (size_t v = 0; v < p_vertices.size(); ++v) {
+		if (kinds[v] == VertexKind::Interior && borderEdges[v] != 0) {
+			kinds[v] = borderEdges[v] == 2 ? VertexKind::Border : VertexKind::Locked;
+		}
+	}
+	return kinds;
+}
+
+static std::vector<Quadric> QuadricsBuild(
+		std::span<const Vertex> p_vertices,
+		std::span<const uint32_t> p_indices,
+		const RdTriangleAdjacency& p_adjacency
+) {
+	ZoneScoped;
+	std::vector<Quadric> quadrics(p_vertices.size());
+	for (size_t triangle = 0; triangle < p_indices.size() / 3; ++triangle) {
+		const uint32_t* corners = &p_indices[triangle * 3];
+		glm::dvec3 positions[3];
+		for (int corner = 0; corner < 3; ++corner) {
+			positions[corner] = glm::dvec3(p_vertices[corners[corner]].position);
+		}
+		glm::dvec3 cross = glm::cross(positions[1] - positions[0], positions[2] - positions[0]);
+		double length = glm::length(cross);
+		if (length <= 0.0) {
+			continue;
+		}
+		glm::dvec3 normal = cross / length;
+		double area = length * 0.5;
+		for (int corner = 0; corner < 3; ++corner) {
+			Quadric& quadric = quadrics[corners[corner]];
+			quadric.PlaneAdd(normal, -glm::dot(normal, positions[0]), area);
+		}
+
+		// A plane through every border edge, perpendicular to its face, keeps the outline in place.
+		for (int corner = 0; corner < 3; ++corner) {
+			uint32_t a = corners[corner];
+			uint32_t b = corners[(corner + 1) % 3];
+			uint32_t shared = 0;
+			for (uint32_t t = p_adjacency.offsets[a]; t < p_adjacency.offsets[a + 1]; ++t) {
+				const uint32_t* other = &p_indices[p_adjacency.triangles[t] * 3];
+				shared += other[0] == b || other[1] == b || other[2] == b;
+			}
+			if (shared != 1) {
+				continue;
+			}
+			glm::dvec3 edge = positions[(corner + 1) % 3] - positions[corner];
+			glm::dvec3 borderNormal = glm::cross(edge, normal);
+			double borderLength = glm::length(borderNormal);
+			if (borderLength <= 0.0) {
+				continue;
+			}
+			borderNormal /= borderLength;
+			double weight = BORDER_WEIGHT * glm::dot(edge, edge);
+			double distance = -glm::dot(borderNormal, positions[corner]);
+			quadrics[a].PlaneAdd(borderNormal, distance, weight);
+			quadrics[b].PlaneAdd(borderNormal, distance, weight);
+		}
+	}
+	return quadrics;
+}
+
+// @brief Whether moving p_from onto p_to keeps the mesh manifold and no face flips. p_shared receives the
+// triangles the collapse removes.
+static bool CollapseValid(
+		std::span<const Vertex> p_vertices,
+		std::span<const uint32_t> p_indices,
+		const RdTriangleAdjacency& p_adjacency,
+		const std::vector<VertexKind>& p_kinds,
+		uint32_t p_from,
+		uint32_t p_to,
+		uint32_t& p_shared
+) {
+	p_shared = 0;
+	for (uint32_t t = p_adjacency.offsets[p_from]; t < p_adjacency.offsets[p_from + 1]; ++t) {
+		const uint32_t* corners = &p_indices[p_adjacency.triangles[t] * 3];
+		p_shared += corners[0] == p_to || corners[1] == p_to || corners[2] == p_to;
+	}
+	if (p_shared == 0 || (p_kinds[p_from] == VertexKind::Border && p_shared != 1)) {
+		return false;
+	}
+
+	// Link condition: the only neighbours both ends share are the far corners of the triangles that vanish,
+	// anything else would fold two faces onto each other.
+	auto neighbours = [&](uint32_t p_vertex, std::vector<uint32_t>& p_out) {
+		p_out.clear();
+		for (uint32_t t = p_adjacency.offsets[p_vertex]; t < p_adjacency.offsets[p_vertex + 1]; ++t) {
+			const uint32_t* corners = &p_indices[p_adjacency.triangles[t] * 3];
+			for (int corner = 0; corner < 3; ++corner) {
+				if (corners[corner] != p_vertex) {
+					p_out.push_back(corners[corner]);
+				}
+			}
+		}
+		std::sort(p_out.begin(), p_out.end());
+		p_out.erase(std::unique(p_out.begin(), p_out.end()), p_out.end());
+	};
+	thread_local std::vector<uint32_t> fromRing;
+	thread_local std::vector<uint32_t> toRing;
+	neighbours(p_from, fromRing);
+	neighbours(p_to, toRing);
+	size_t common = 0;
+	for (size_t i = 0, j = 0; i < fromRing.size() && j < toRing.size();) {
+		if (fromRing[i] < toRing[j]) {
+			++i;
+		} else if (fromRing[i] > toRing[j]) {
+			++j;
+		} else {
+			++common;
+			++i;
+			++j;
+		}
+	}
+	if (common != p_shared) {
+		return false;
+	}
+
+	const glm::vec3& target = p_vertices[p_to].position;
+	for (uint32_t t = p_adjacency.offsets[p_from]; t < p_adjacency.offsets[p_from + 1]; ++t) {
+		const uint32_t* corners = &p_indices[p_adjacency.triangles[t] * 3];
+		if (corners[0] == p_to || corners[1] == p_to || corners[2] == p_to) {
+			continue;
+		}
+		glm::dvec3 before[3];
+		glm::dvec3 after[3];
+		for (int corner = 0; corner < 3; ++corner) {
+			before[corner] = glm::dvec3(p_vertices[corners[corner]].position);
+			after[corner] = corners[corner] == p_from ? glm::dvec3(target) : before[corner];
+		}
+		glm::dvec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+		glm::dvec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+		double limit = FLIP_COSINE * glm::length(normalBefore) * glm::length(normalAfter);
+		if (glm::dot(normalBefore, normalAfter) <= limit) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// @brief Passes of greedy collapses. Every pass ranks all edges by the error of collapsing them onto their
+// cheaper end and takes them in order, skipping edges next to one collapsed earlier in the pass since their
+// cost and validity were computed on faces that changed.
+std::vector<uint32_t> MeshSimplify(
+		std::span<const Vertex> p_vertices,
+		std::span<const uint32_t> p_indices,
+		size_t p_targetIndexCount,
+		float p_maxError,
+		float* p_error
+) {
+	ZoneScoped;
+	const size_t vertexCount = p_vertices.size();
+	const size_t targetTriangles = p_targetIndexCount / 3;
+	std::vector<uint32_t> indices(p_indices.begin(), p_indices.end());
+	float maxError = 0.0f;
+
+	RdTriangleAdjacency adjacency = MeshTriangleAdjacency(indices, vertexCount);
+	std::vector<VertexKind> kinds = VertexKindsClassify(p_vertices, indices, adjacency);
+	std::vector<Quadric> quadrics = QuadricsBuild(p_vertices, indices, adjacency);
+
+	struct Collapse {
+		uint32_t from;
+		uint32_t to;
+		float error;
+	};
+	std::vector<Collapse> collapses;
+	std::vector<uint8_t> touched(vertexCount);
+
+	auto collapseError = [&](uint32_t p_from, uint32_t p_to) {
+		Quadric quadric = quadrics[p_from];
+		quadric += quadrics[p_to];
+		double squared = std::max(quadric.Evaluate(glm::dvec3(p_vertices[p_to].position)), 0.0);
+		return static_cast<float>(std::sqrt(squared / std::max(quadric.weight, 1e-20)));
+	};
+
+	size_t triangleCount = indices.size() / 3;
+	while (triangleCount > targetTriangles) {
+		collapses.clear();
+		for (size_t i = 0; i < indices.size(); ++i) {
+			uint32_t a = indices[i];
+			uint32_t b = indices[i - i % 3 + (i + 1) % 3];
+			bool aMoves = kinds[a] == VertexKind::Interior || (kinds[a] == VertexKind::Border && kinds[b] != VertexKind::Interior);
+			bool bMoves = kinds[b] == VertexKind::Interior || (kinds[b] == VertexKind::Border && kinds[a] != VertexKind::Interior);
+			float aError = aMoves ? collapseError(a, b) : std::numeric_limits<float>::infinity();
+			float bError = bMoves ? collapseError(b, a) : std::numeric_limits<float>::infinity();
+			if (aMoves && aError <= bError) {
+				collapses.push_back({ a, b, aError });
+			} else if (bMoves) {
+				collapses.push_back({ b, a, bError });
+			}
+		}
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& p_a, const Collapse& p_b) {
+			return p_a.error < p_b.error;
+		});
+
+		std::fill(touched.begin(), touched.end(), 0);
+		std::vector<uint32_t> remap(vertexCount);
+		for (uint32_t v = 0; v < vertexCount; ++v) {
+			remap[v] = v;
+		}
+		size_t collapsed = 0;
+		for (const Collapse& collapse : collapses) {
+			if (collapse.error > p_maxError || triangleCount <= targetTriangles) {
+				break;
+			}
+			uint32_t shared = 0;
+			if (touched[collapse.from] || touched[collapse.to]
+				|| !CollapseValid(p_vertices, indices, adjacency, kinds, collapse.from, collapse.to, shared)) {
+				continue;
+			}
+
+			remap[collapse.from] = collapse.to;
+			quadrics[collapse.to] += quadrics[collapse.from];
+			for (uint32_t t = adjacency.offsets[collapse.from]; t < adjacency.offsets[collapse.from + 1]; ++t) {
+				const uint32_t* corners = &indices[adjacency.triangles[t] * 3];
+				touched[corners[0]] = touched[corners[1]] = touched[corners[2]] = 1;
+			}
+			triangleCount -= shared;
+			maxError = std::max(maxError, collapse.error);
+			collapsed++;
+		}
+		if (collapsed == 0) {
+			break;
+		}
+
+		size_t write = 0;
+		for (size_t triangle = 0; triangle < indices.size() / 3; ++triangle) {
+			uint32_t a = remap[indices[triangle * 3 + 0]];
+			uint32_t b = remap[indices[triangle * 3 + 1]];
+			uint32_t c = remap[indices[triangle * 3 + 2]];
+			if (a != b && b != c && a != c) {
+				indices[write++] = a;
+				indices[write++] = b;
+				indices[write++] = c;
+			}
+		}
+		indices.resize(write);
+		triangleCount = write / 3;
+		adjacency = MeshTriangleAdjacency(indices, vertexCount);
+	}
+
+	if (p_error != nullptr) {
+		*p_error = maxError;
+	}
+	return indices;
+}
+
+std::vector<RdMeshLod> MeshLodChainBuild(
+		std::span<const Vertex> p_vertices,
+		std::vector<uint32_t>& p_indices,
+		const RdMeshLodOptions& p_options
+) {
+	ZoneScoped;
+	std::vector<RdMeshLod> lods;
+	lods.push_back({ 0, static_cast<uint32_t>(p_indices.size()), 0.0f });
+
+	uint32_t maxLevels = std::min(p_options.maxLevels, RD_MESH_MAX_LODS);
+	std::vector<uint32_t> previous(p_indices);
+	float error = 0.0f;
+	while (lods.size() < maxLevels) {
+		size_t targetTriangles = static_cast<size_t>(static_cast<float>(previous.size() / 3) * p_options.ratio);
+		if (targetTriangles < p_options.minTriangles) {
+			break;
+		}
+		float levelError = 0.0f;
+		std::vector<uint32_t> level = MeshSimplify(
+				p_vertices, previous, targetTriangles * 3, std::numeric_limits<float>::max(), &levelError
+		);
+		if (level.size() * 10 > previous.size() * 9) {
+			break;
+		}
+		MeshOptimizeVertexCache(level, p_vertices.size());
+
+		// Each level was measured against the one before, their errors add up at worst.
+		error += levelError;
+		lods.push_back({ static_cast<uint32_t>(p_indices.size()), static_cast<uint32_t>(level.size()), error });
+		p_indices.insert(p_indices.end(), level.begin(), level.end());
+		previous = std::move(level);
+	}
+
+	LOG_INFO("Mesh LOD chain: %zu levels", lods.size());
+	for (size_t l = 0; l < lods.size(); ++l) {
+		LOG_TRACE("  ~  level %zu: %u triangles, error %g", l, lods[l].indexCount / 3, lods[l].error);
+	}
+	return lods;
+}
+
+uint32_t MeshLodSelect(std::span<const RdMeshLod> p_lods, float p_pixelsPerUnit) {
+	uint32_t level = 0;
+	for (uint32_t l = 1; l < p_lods.size() && p_lods[l].error * p_pixelsPerUnit <= 1.0f; ++l) {
+		level = l;
+	}
+	return level;
+}
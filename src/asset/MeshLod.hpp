@@ -0,0 +1,59 @@
+#pragma once
+
+#include "../renderer/Vertex.hpp"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// ~~~~~~~~~~~~~
+// Levels of detail built with quadric error edge collapses (Garland and Heckbert 1997).
+//
+// Collapses only ever move a vertex onto one of its neighbours, so every level indexes the vertices of the full
+// mesh. The levels are packed one after the other into a single index buffer and drawn with the vertex buffer
+// of level 0, picking a level is picking an index range.
+//
+// Vertices sharing their position with another one (color seams) stay where they are, border vertices only
+// slide along the border.
+// ~~~~~~~~~~~~~
+
+// One level inside the packed index buffer.
+struct RdMeshLod {
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	// Distance between this level and the full mesh, in mesh units, 0 for level 0.
+	float error;
+};
+
+struct RdMeshLodOptions {
+	// Levels including the full mesh. Renderers keep one instance region per level, see RD_MESH_MAX_LODS.
+	uint32_t maxLevels = 4;
+	// Triangles every level keeps from the one before.
+	float ratio = 0.25f;
+	// The chain ends at the first level below this, or that removes less than a tenth of the triangles.
+	uint32_t minTriangles = 32;
+};
+
+constexpr uint32_t RD_MESH_MAX_LODS = 4;
+
+// @brief Collapse edges cheapest first until p_targetIndexCount indices are left or the next collapse would move
+// the surface further than p_maxError. Returns the remaining triangles, p_error receives the largest error reached.
+std::vector<uint32_t> MeshSimplify(
+		std::span<const Vertex> p_vertices,
+		std::span<const uint32_t> p_indices,
+		size_t p_targetIndexCount,
+		float p_maxError,
+		float* p_error = nullptr
+);
+
+// @brief Append coarser levels of the mesh in p_indices to it, each simplified from the one before and optimized
+// for the vertex cache. Returns every level, level 0 being the input. Meshes too small to simplify get one level.
+std::vector<RdMeshLod> MeshLodChainBuild(
+		std::span<const Vertex> p_vertices,
+		std::vector<uint32_t>& p_indices,
+		const RdMeshLodOptions& p_options = {}
+);
+
+// @brief Coarsest level whose error stays below one pixel, p_pixelsPerUnit being the size of one mesh unit on
+// screen divided by the tolerated error in pixels
+uint32_t MeshLodSelect(std::span<const RdMeshLod> p_lods, float p_pixelsPerUnit);
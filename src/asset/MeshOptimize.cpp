@@ -0,0 +1,293 @@
+#include "MeshOptimize.hpp"
+
+#include "logging_macros.h"
+#include "tracy/Tracy.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <unordered_map>
+
+RdTriangleAdjacency MeshTriangleAdjacency(std::span<const uint32_t> p_indices, size_t p_vertexCount) {
+	RdTriangleAdjacency adjacency;
+	adjacency.offsets.assign(p_vertexCount + 1, 0);
+	for (uint32_t index : p_indices) {
+		adjacency.offsets[index + 1]++;
+	}
+	for (size_t v = 0; v < p_vertexCount; ++v) {
+		adjacency.offsets[v + 1] += adjacency.offsets[v];
+	}
+
+	std::vector<uint32_t> cursor(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+	adjacency.triangles.resize(p_indices.size());
+	for (size_t i = 0; i < p_indices.size(); ++i) {
+		adjacency.triangles[cursor[p_indices[i]]++] = static_cast<uint32_t>(i / 3);
+	}
+	return adjacency;
+}
+
+// FIFO cache through timestamps: a vertex is cached while fewer than p_cacheSize misses happened since its own.
+RdVertexCacheStats MeshAnalyzeVertexCache(std::span<const uint32_t> p_indices, size_t p_vertexCount, uint32_t p_cacheSize) {
+	ZoneScoped;
+	RdVertexCacheStats stats;
+	if (p_indices.empty()) {
+		return stats;
+	}
+
+	std::vector<uint32_t> stamps(p_vertexCount, 0);
+	std::vector<bool> referenced(p_vertexCount, false);
+	uint32_t time = p_cacheSize + 1;
+	size_t misses = 0;
+	size_t unique = 0;
+	for (uint32_t index : p_indices) {
+		if (time - stamps[index] > p_cacheSize) {
+			stamps[index] = time++;
+			misses++;
+		}
+		if (!referenced[index]) {
+			referenced[index] = true;
+			unique++;
+		}
+	}
+
+	stats.acmr = static_cast<float>(misses) / static_cast<float>(p_indices.size() / 3);
+	stats.atvr = static_cast<float>(misses) / static_cast<float>(unique);
+	return stats;
+}
+
+size_t MeshDeduplicate(std::vector<Vertex>& p_vertices, std::vector<uint32_t>& p_indices) {
+	ZoneScoped;
+	struct BitsHash {
+		size_t operator()(const Vertex& p_vertex) const {
+			uint32_t words[sizeof(Vertex) / sizeof(uint32_t)];
+			std::memcpy(words, &p_vertex, sizeof(Vertex));
+			uint64_t hash = 0xcbf29ce484222325ull;
+			for (uint32_t word : words) {
+				hash = (hash ^ word) * 0x100000001b3ull;
+			}
+			return static_cast<size_t>(hash);
+		}
+	};
+	struct BitsEqual {
+		bool operator()(const Vertex& p_a, const Vertex& p_b) const {
+			return std::memcmp(&p_a, &p_b, sizeof(Vertex)) == 0;
+		}
+	};
+
+	std::unordered_map<Vertex, uint32_t, BitsHash, BitsEqual> unique;
+	unique.reserve(p_vertices.size());
+	std::vector<uint32_t> remap(p_vertices.size());
+	std::vector<Vertex> vertices;
+	vertices.reserve(p_vertices.size());
+	for (size_t v = 0; v < p_vertices.size(); ++v) {
+		auto [entry, inserted] = unique.try_emplace(p_vertices[v], static_cast<uint32_t>(vertices.size()));
+		if (inserted) {
+			vertices.push_back(p_vertices[v]);
+		}
+		remap[v] = entry->second;
+	}
+
+	for (uint32_t& index : p_indices) {
+		index = remap[index];
+	}
+	size_t removed = p_vertices.size() - vertices.size();
+	p_vertices = std::move(vertices);
+	return removed;
+}
+
+// @brief Tipsify: fan around a vertex, emitting all its remaining triangles, then move on to the candidate that is
+// still cached and will stay so while its own triangles are emitted. Dead ends fall back to recently emitted
+// vertices, then to the input order. Linear in the triangle count.
+void MeshOptimizeVertexCache(std::vector<uint32_t>& p_indices, size_t p_vertexCount, uint32_t p_cacheSize) {
+	ZoneScoped;
+	const size_t triangleCount = p_indices.size() / 3;
+	if (triangleCount == 0) {
+		return;
+	}
+
+	RdTriangleAdjacency adjacency = MeshTriangleAdjacency(p_indices, p_vertexCount);
+	std::vector<uint32_t> live(p_vertexCount);
+	for (size_t v = 0; v < p_vertexCount; ++v) {
+		live[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+	}
+	std::vector<uint32_t> stamps(p_vertexCount, 0);
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<uint32_t> deadEnds;
+	std::vector<uint32_t> candidates;
+	std::vector<uint32_t> output;
+	output.reserve(p_indices.size());
+
+	const int64_t cacheSize = p_cacheSize;
+	int64_t time = cacheSize + 1;
+	size_t cursor = 0;
+
+	auto skipDeadEnd = [&]() -> int64_t {
+		while (!deadEnds.empty()) {
+			uint32_t vertex = deadEnds.back();
+			deadEnds.pop_back();
+			if (live[vertex] > 0) {
+				return vertex;
+			}
+		}
+		for (; cursor < p_vertexCount; ++cursor) {
+			if (live[cursor] > 0) {
+				return static_cast<int64_t>(cursor);
+			}
+		}
+		return -1;
+	};
+
+	int64_t fan = skipDeadEnd();
+	while (fan >= 0) {
+		candidates.clear();
+		for (uint32_t a = adjacency.offsets[fan]; a < adjacency.offsets[fan + 1]; ++a) {
+			uint32_t triangle = adjacency.triangles[a];
+			if (emitted[triangle]) {
+				continue;
+			}
+			emitted[triangle] = true;
+			for (uint32_t corner = 0; corner < 3; ++corner) {
+				uint32_t vertex = p_indices[triangle * 3 + corner];
+				output.push_back(vertex);
+				deadEnds.push_back(vertex);
+				candidates.push_back(vertex);
+				live[vertex]--;
+				if (time - stamps[vertex] > cacheSize) {
+					stamps[vertex] = static_cast<uint32_t>(time++);
+				}
+			}
+		}
+
+		// The candidate cached longest that stays cached while its remaining triangles are emitted.
+		int64_t next = -1;
+		int64_t best = -1;
+		for (uint32_t vertex : candidates) {
+			if (live[vertex] == 0) {
+				continue;
+			}
+			int64_t priority = 0;
+			int64_t age = time - stamps[vertex];
+			if (age + 2 * static_cast<int64_t>(live[vertex]) <= cacheSize) {
+				priority = age;
+			}
+			if (priority > best) {
+				best = priority;
+				next = vertex;
+			}
+		}
+		fan = next >= 0 ? next : skipDeadEnd();
+	}
+
+	p_indices = std::move(output);
+}
+
+// @brief Split the cache-ordered triangles where the simulated cache restarts and sort those clusters so the ones
+// facing away from the mesh center come first. Seen from outside, near surfaces then mostly hide far ones, which
+// the depth test rejects before shading. Triangles keep their order inside a cluster, so the cache order survives.
+void MeshOptimizeOverdraw(std::vector<uint32_t>& p_indices, std::span<const Vertex> p_vertices, uint32_t p_cacheSize) {
+	ZoneScoped;
+	const size_t triangleCount = p_indices.size() / 3;
+	if (triangleCount == 0) {
+		return;
+	}
+
+	std::vector<uint32_t> clusterStarts;
+	std::vector<uint32_t> stamps(p_vertices.size(), 0);
+	uint32_t time = p_cacheSize + 1;
+	for (size_t triangle = 0; triangle < triangleCount; ++triangle) {
+		uint32_t misses = 0;
+		for (uint32_t corner = 0; corner < 3; ++corner) {
+			uint32_t vertex = p_indices[triangle * 3 + corner];
+			if (time - stamps[vertex] > p_cacheSize) {
+				stamps[vertex] = time++;
+				misses++;
+			}
+		}
+		if (triangle == 0 || misses == 3) {
+			clusterStarts.push_back(static_cast<uint32_t>(triangle));
+		}
+	}
+	clusterStarts.push_back(static_cast<uint32_t>(triangleCount));
+
+	glm::vec3 meshCenter(0.0f);
+	for (const Vertex& vertex : p_vertices) {
+		meshCenter += vertex.position;
+	}
+	meshCenter /= static_cast<float>(std::max<size_t>(p_vertices.size(), 1));
+
+	struct Cluster {
+		uint32_t first;
+		uint32_t end;
+		float key;
+	};
+	std::vector<Cluster> clusters;
+	clusters.reserve(clusterStarts.size() - 1);
+	for (size_t c = 0; c + 1 < clusterStarts.size(); ++c) {
+		glm::vec3 centroid(0.0f);
+		glm::vec3 normal(0.0f);
+		float area = 0.0f;
+		for (uint32_t triangle = clusterStarts[c]; triangle < clusterStarts[c + 1]; ++triangle) {
+			const glm::vec3& a = p_vertices[p_indices[triangle * 3 + 0]].position;
+			const glm::vec3& b = p_vertices[p_indices[triangle * 3 + 1]].position;
+			const glm::vec3& d = p_vertices[p_indices[triangle * 3 + 2]].position;
+			glm::vec3 cross = glm::cross(b - a, d - a);
+			float weight = glm::length(cross);
+			centroid += (a + b + d) * (weight / 3.0f);
+			normal += cross;
+			area += weight;
+		}
+		float normalLength = glm::length(normal);
+		float key = 0.0f;
+		if (area > 0.0f && normalLength > 0.0f) {
+			key = glm::dot(centroid / area - meshCenter, normal / normalLength);
+		}
+		clusters.push_back({ clusterStarts[c], clusterStarts[c + 1], key });
+	}
+
+	std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) {
+		return a.key > b.key;
+	});
+
+	std::vector<uint32_t> output;
+	output.reserve(p_indices.size());
+	for (const Cluster& cluster : clusters) {
+		output.insert(output.end(), p_indices.begin() + cluster.first * 3, p_indices.begin() + cluster.end * 3);
+	}
+	p_indices = std::move(output);
+}
+
+void MeshOptimizeVertexFetch(std::vector<Vertex>& p_vertices, std::vector<uint32_t>& p_indices) {
+	ZoneScoped;
+	std::vector<uint32_t> remap(p_vertices.size(), UINT32_MAX);
+	std::vector<Vertex> vertices;
+	vertices.reserve(p_vertices.size());
+	for (uint32_t& index : p_indices) {
+		if (remap[index] == UINT32_MAX) {
+			remap[index] = static_cast<uint32_t>(vertices.size());
+			vertices.push_back(p_vertices[index]);
+		}
+		index = remap[index];
+	}
+	p_vertices = std::move(vertices);
+}
+
+void MeshOptimize(std::vector<Vertex>& p_vertices, std::vector<uint32_t>& p_indices, const RdMeshOptimizeOptions& p_options) {
+	ZoneScoped;
+	// Every pass indexes vertices directly, the importers reject indices out of range.
+	assert(std::all_of(p_indices.begin(), p_indices.end(), [&p_vertices](uint32_t index) {
+		return index < p_vertices.size();
+	}));
+	size_t vertexCount = p_vertices.size();
+	RdVertexCacheStats before = MeshAnalyzeVertexCache(p_indices, p_vertices.size(), p_options.cacheSize);
+
+	MeshDeduplicate(p_vertices, p_indices);
+	MeshOptimizeVertexCache(p_indices, p_vertices.size(), p_options.cacheSize);
+	if (p_options.overdraw) {
+		MeshOptimizeOverdraw(p_indices, p_vertices, p_options.cacheSize);
+	}
+	MeshOptimizeVertexFetch(p_vertices, p_indices);
+
+	RdVertexCacheStats after = MeshAnalyzeVertexCache(p_indices, p_vertices.size(), p_options.cacheSize);
+	LOG_INFO("Mesh optimized: %zu -> %zu vertices, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f",
+			 vertexCount, p_vertices.size(), before.acmr, after.acmr, before.atvr, after.atvr);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "../renderer/Vertex.hpp"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// ~~~~~~~~~~~~~
+// Load and conversion time reordering of indexed triangle lists, in the order MeshOptimize() runs them:
+//
+//   deduplicate    merge bitwise identical vertices
+//   vertex cache   reorder triangles for post-transform cache hits (Tipsify, Sander et al. 2007)
+//   overdraw       reorder cache-friendly clusters of triangles front to back as seen from outside
+//   vertex fetch   reorder vertices by first use so fetches walk the vertex buffer linearly
+//
+// The rendered result is unchanged, only the order of triangles and vertices changes.
+// ~~~~~~~~~~~~~
+
+// Post-transform cache efficiency of an index buffer, simulated with a FIFO cache.
+// ACMR is misses per triangle, 0.5 at best on large regular meshes and 3 at worst. ATVR is misses per referenced
+// vertex, 1 at best.
+struct RdVertexCacheStats {
+	float acmr = 0.0f;
+	float atvr = 0.0f;
+};
+
+struct RdMeshOptimizeOptions {
+	// Entries of the simulated cache, 16 is a safe middle ground for current GPUs.
+	uint32_t cacheSize = 16;
+	bool overdraw = true;
+};
+
+// Triangles using every vertex, as offsets into one flat list like a CSR matrix.
+struct RdTriangleAdjacency {
+	std::vector<uint32_t> offsets;
+	std::vector<uint32_t> triangles;
+};
+
+RdTriangleAdjacency MeshTriangleAdjacency(std::span<const uint32_t> p_indices, size_t p_vertexCount);
+RdVertexCacheStats MeshAnalyzeVertexCache(std::span<const uint32_t> p_indices, size_t p_vertexCount, uint32_t p_cacheSize = 16);
+
+// @brief Merge bitwise identical vertices and remap p_indices, returns the number of vertices removed
+size_t MeshDeduplicate(std::vector<Vertex>& p_vertices, std::vector<uint32_t>& p_indices);
+void MeshOptimizeVertexCache(std::vector<uint32_t>& p_indices, size_t p_vertexCount, uint32_t p_cacheSize = 16);
+void MeshOptimizeOverdraw(std::vector<uint32_t>& p_indices, std::span<const Vertex> p_vertices, uint32_t p_cacheSize = 16);
+// @brief Reorder vertices by first use and drop the unreferenced ones
+void MeshOptimizeVertexFetch(std::vector<Vertex>& p_vertices, std::vector<uint32_t>& p_indices);
+
+// @brief Run every stage and log the cache statistics before and after
+void MeshOptimize(
+		std::vector<Vertex>& p_vertices,
+		std::vector<uint32_t>& p_indices,
+		const RdMeshOptimizeOptions& p_options = {}
+);
@@ -0,0 +1,116 @@
+#include "Meshlet.hpp"
+
+#include "logging_macros.h"
+#include "tracy/Tracy.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Wider cones are not worth testing, hardly any view sees all of such a meshlet from behind.
+static constexpr float MAX_CONE_DEGREES = 80.0f;
+
+void MeshletBoundsCompute(std::span<const Vertex> p_vertices, std::span<const uint32_t> p_indices, RdMeshlet& p_meshlet) {
+	std::span<const uint32_t> indices = p_indices.subspan(p_meshlet.firstIndex, p_meshlet.indexCount);
+
+	glm::vec3 lower(std::numeric_limits<float>::max());
+	glm::vec3 upper(std::numeric_limits<float>::lowest());
+	for (uint32_t index : indices) {
+		lower = glm::min(lower, p_vertices[index].position);
+		upper = glm::max(upper, p_vertices[index].position);
+	}
+	p_meshlet.center = (lower + upper) * 0.5f;
+	p_meshlet.radius = 0.0f;
+	for (uint32_t index : indices) {
+		p_meshlet.radius = std::max(p_meshlet.radius, glm::length(p_vertices[index].position - p_meshlet.center));
+	}
+
+	// Degenerate triangles have no facing, they neither widen the cone nor keep it from culling.
+	glm::vec3 normals[128];
+	uint32_t normalCount = 0;
+	glm::vec3 axis(0.0f);
+	for (size_t i = 0; i + 2 < indices.size() && normalCount < std::size(normals); i += 3) {
+		const glm::vec3& a = p_vertices[indices[i + 0]].position;
+		const glm::vec3& b = p_vertices[indices[i + 1]].position;
+		const glm::vec3& c = p_vertices[indices[i + 2]].position;
+		glm::vec3 normal = glm::cross(b - a, c - a);
+		float length = glm::length(normal);
+		if (length > 0.0f) {
+			normals[normalCount++] = normal / length;
+			axis += normal / length;
+		}
+	}
+
+	p_meshlet.coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+	p_meshlet.coneCutoff = 2.0f;
+	float axisLength = glm::length(axis);
+	if (normalCount == 0 || axisLength == 0.0f) {
+		return;
+	}
+	axis /= axisLength;
+	float minCosine = 1.0f;
+	for (uint32_t n = 0; n < normalCount; ++n) {
+		minCosine = std::min(minCosine, glm::dot(normals[n], axis));
+	}
+	p_meshlet.coneAxis = axis;
+	if (minCosine > std::cos(glm::radians(MAX_CONE_DEGREES))) {
+		p_meshlet.coneCutoff = std::sqrt(std::max(0.0f, 1.0f - minCosine * minCosine));
+	}
+}
+
+// @brief Greedy scan: triangles join the current meshlet until one would bring more new vertices than the vertex
+// budget leaves, or the triangle budget is reached. Linear in the index count.
+std::vector<RdMeshlet> MeshletsBuild(
+		std::span<const Vertex> p_vertices,
+		std::span<const uint32_t> p_indices,
+		const RdMeshletOptions& p_options
+) {
+	ZoneScoped;
+	std::vector<RdMeshlet> meshlets;
+	const uint32_t maxTriangles = std::clamp(p_options.maxTriangles, 1u, 128u);
+	const uint32_t maxVertices = std::max(p_options.maxVertices, 3u);
+
+	// Meshlet that last used every vertex, a vertex is new to the current meshlet unless it is the owner.
+	std::vector<uint32_t> owners(p_vertices.size(), UINT32_MAX);
+	RdMeshlet current = {};
+	size_t vertexTotal = 0;
+	for (size_t i = 0; i + 2 < p_indices.size(); i += 3) {
+		uint32_t id = static_cast<uint32_t>(meshlets.size());
+		uint32_t added = 0;
+		for (size_t corner = 0; corner < 3; ++corner) {
+			added += owners[p_indices[i + corner]] != id ? 1 : 0;
+		}
+		if (current.vertexCount + added > maxVertices || current.indexCount / 3 == maxTriangles) {
+			MeshletBoundsCompute(p_vertices, p_indices, current);
+			meshlets.push_back(current);
+			vertexTotal += current.vertexCount;
+			current = {};
+			current.firstIndex = static_cast<uint32_t>(i);
+			id++;
+			added = 3;
+		}
+		for (size_t corner = 0; corner < 3; ++corner) {
+			owners[p_indices[i + corner]] = id;
+		}
+		current.vertexCount += added;
+		current.indexCount += 3;
+	}
+	if (current.indexCount > 0) {
+		MeshletBoundsCompute(p_vertices, p_indices, current);
+		meshlets.push_back(current);
+		vertexTotal += current.vertexCount;
+	}
+
+	size_t cones = std::count_if(meshlets.begin(), meshlets.end(), [](const RdMeshlet& meshlet) {
+		return meshlet.coneCutoff <= 1.0f;
+	});
+	double count = static_cast<double>(std::max<size_t>(meshlets.size(), 1));
+	LOG_INFO("Meshlets: %zu, %.1f vertices and %.1f triangles on average, %zu with a usable cone",
+			 meshlets.size(), static_cast<double>(vertexTotal) / count,
+			 static_cast<double>(p_indices.size() / 3) / count, cones);
+	return meshlets;
+}
+
+bool MeshletBackfacing(const RdMeshlet& p_meshlet, const glm::vec3& p_axis, const glm::vec3& p_viewDirection) {
+	return glm::dot(p_axis, p_viewDirection) > p_meshlet.coneCutoff;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "../renderer/Vertex.hpp"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// ~~~~~~~~~~~~~
+// Meshlets: clusters of a few dozen triangles with bounds tight enough to cull them one by one.
+//
+// Triangles leave MeshOptimize() in cache order, neighbours follow each other, so a meshlet is a contiguous run
+// of the index buffer cut whenever it would exceed its vertex or triangle budget. Culling a meshlet is dropping
+// its index range, the mesh needs no second copy of its indices.
+//
+// Bounds are a sphere around the meshlet vertices and a cone holding every triangle normal. In an orthographic
+// view along +z, a meshlet whose whole cone points away from the viewer only has back faces, see MeshletBackfacing.
+// ~~~~~~~~~~~~~
+
+// Budgets of the usual hardware meshlet size, a 124 triangle cap keeps 64 vertex meshlets of regular grids full.
+struct RdMeshletOptions {
+	uint32_t maxVertices = 64;
+	uint32_t maxTriangles = 124;
+};
+
+// Mirrors Meshlet in meshlets.wgsl, the GPU reads the array as built.
+struct RdMeshlet {
+	glm::vec3 center;
+	float radius;
+	// Mean triangle normal, every normal lies within the cone around it.
+	glm::vec3 coneAxis;
+	// Sine of the cone half angle, above 1 when the cone is too wide to ever face away as a whole.
+	float coneCutoff;
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	uint32_t vertexCount;
+	uint32_t padding;
+};
+static_assert(sizeof(RdMeshlet) == 48, "RdMeshlet has to match its WGSL layout");
+
+// @brief Split the triangles of p_indices into meshlets in their current order and compute their bounds
+std::vector<RdMeshlet> MeshletsBuild(
+		std::span<const Vertex> p_vertices,
+		std::span<const uint32_t> p_indices,
+		const RdMeshletOptions& p_options = {}
+);
+
+// @brief Recompute the sphere and cone of p_meshlet from the triangles it covers in p_indices, after its vertices moved
+void MeshletBoundsCompute(std::span<const Vertex> p_vertices, std::span<const uint32_t> p_indices, RdMeshlet& p_meshlet);
+
+// @brief Whether every triangle of a meshlet whose cone axis is p_axis faces away from a viewer looking along
+// p_viewDirection, p_viewDirection of unit length
+bool MeshletBackfacing(const RdMeshlet& p_meshlet, const glm::vec3& p_axis, const glm::vec3& p_viewDirection);
@@ -0,0 +1,188 @@
+#include "ObjGeometry.hpp"
+
+#include "ParallelParse.hpp"
+#include "logging_macros.h"
+#include "tracy/Tracy.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+enum class ObjLine : uint8_t {
+	Position,
+	Face,
+};
+
+struct ObjChunk {
+	std::string_view text;
+	size_t vertexCount = 0;
+	size_t triangleCount = 0;
+	// Output offsets, filled between the counting and parsing passes.
+	size_t firstVertex = 0;
+	size_t firstTriangle = 0;
+	bool valid = true;
+};
+
+static bool IsBlank(char p_char) {
+	return p_char == ' ' || p_char == '\t' || p_char == '\r';
+}
+
+// @brief Call p_onLine(kind, argumentsBegin, lineEnd) for every position and face line of the chunk
+template <typename F>
+static void ForEachLine(std::string_view p_text, F&& p_onLine) {
+	const char* line = p_text.data();
+	const char* textEnd = p_text.data() + p_text.size();
+	while (line < textEnd) {
+		const char* newline = static_cast<const char*>(std::memchr(line, '\n', static_cast<size_t>(textEnd - line)));
+		const char* lineEnd = newline ? newline : textEnd;
+
+		while (line < lineEnd && IsBlank(*line)) {
+			++line;
+		}
+		// `v` and `f` followed by a blank, `vt`, `vn`, `vp` and every other keyword are skipped.
+		if (lineEnd - line >= 2 && IsBlank(line[1])) {
+			if (line[0] == 'v') {
+				p_onLine(ObjLine::Position, line + 2, lineEnd);
+			} else if (line[0] == 'f') {
+				p_onLine(ObjLine::Face, line + 2, lineEnd);
+			}
+		}
+
+		if (newline == nullptr) {
+			break;
+		}
+		line = newline + 1;
+	}
+}
+
+// @brief Corners of a face line, the `v/vt/vn` groups up to the end of the line or a comment
+static uint32_t CornerCount(const char* p_cursor, const char* p_end) {
+	uint32_t count = 0;
+	bool inCorner = false;
+	for (; p_cursor < p_end && *p_cursor != '#'; ++p_cursor) {
+		bool blank = IsBlank(*p_cursor);
+		if (!blank && !inCorner) {
+			count++;
+		}
+		inCorner = !blank;
+	}
+	return count;
+}
+
+static void CountChunk(ObjChunk& p_chunk) {
+	ZoneScoped;
+	ForEachLine(p_chunk.text, [&p_chunk](ObjLine kind, const char* line, const char* lineEnd) {
+		if (kind == ObjLine::Position) {
+			p_chunk.vertexCount++;
+		} else {
+			p_chunk.triangleCount += std::max<uint32_t>(CornerCount(line, lineEnd), 2) - 2;
+		}
+	});
+}
+
+static void ParseChunk(ObjChunk& p_chunk, size_t p_vertexCount, Vertex* p_vertices, uint32_t* p_indices) {
+	ZoneScoped;
+	size_t vertex = p_chunk.firstVertex;
+	uint32_t* triangle = p_indices + p_chunk.firstTriangle * 3;
+
+	ForEachLine(p_chunk.text, [&](ObjLine kind, const char* line, const char* lineEnd) {
+		if (!p_chunk.valid) {
+			return;
+		}
+
+		if (kind == ObjLine::Position) {
+			// x, y, z, then either nothing, w, or r, g, b
+			Vertex& output = p_vertices[vertex++];
+			p_chunk.valid = ParseNumber(line, lineEnd, output.position.x) && ParseNumber(line, lineEnd, output.position.y)
+					&& ParseNumber(line, lineEnd, output.position.z);
+			float extra[3];
+			int extraCount = 0;
+			while (extraCount < 3 && ParseNumber(line, lineEnd, extra[extraCount])) {
+				extraCount++;
+			}
+			output.color = extraCount == 3 ? glm::vec3(extra[0], extra[1], extra[2]) : glm::vec3(1.0f);
+			return;
+		}
+
+		// Fan the polygon around its first corner, only the position index of every corner is read.
+		uint32_t corner = 0;
+		uint32_t first = 0;
+		uint32_t previous = 0;
+		for (;;) {
+			while (line < lineEnd && IsBlank(*line)) {
+				++line;
+			}
+			if (line == lineEnd || *line == '#') {
+				break;
+			}
+			int64_t index = 0;
+			if (!ParseNumber(line, lineEnd, index)) {
+				p_chunk.valid = false;
+				return;
+			}
+			while (line < lineEnd && !IsBlank(*line)) {
+				++line;
+			}
+
+			// 1-based, negative ones count back from the last position read so far.
+			int64_t resolved = index < 0 ? static_cast<int64_t>(vertex) + index : index - 1;
+			if (resolved < 0 || resolved >= static_cast<int64_t>(p_vertexCount)) {
+				p_chunk.valid = false;
+				return;
+			}
+			uint32_t current = static_cast<uint32_t>(resolved);
+			if (corner == 0) {
+				first = current;
+			} else if (corner >= 2) {
+				triangle[0] = first;
+				triangle[1] = previous;
+				triangle[2] = current;
+				triangle += 3;
+			}
+			previous = current;
+			corner++;
+		}
+		if (corner < 3) {
+			p_chunk.valid = false;
+		}
+	});
+}
+
+// @brief Parse the whole text in two passes over line-aligned chunks, one thread per chunk, like
+// GeometryParseText. Relative indices only need the positions before their own chunk, which the first pass counts.
+bool GeometryParseObj(std::string_view p_text, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+	ZoneScoped;
+	std::vector<std::string_view> pieces = ParseSplitLines(p_text);
+	std::vector<ObjChunk> chunks(pieces.size());
+	for (size_t i = 0; i < pieces.size(); ++i) {
+		chunks[i].text = pieces[i];
+	}
+
+	ParseRunParallel(chunks, CountChunk);
+
+	size_t vertexCount = 0;
+	size_t triangleCount = 0;
+	for (ObjChunk& chunk : chunks) {
+		chunk.firstVertex = vertexCount;
+		chunk.firstTriangle = triangleCount;
+		vertexCount += chunk.vertexCount;
+		triangleCount += chunk.triangleCount;
+	}
+	if (vertexCount > UINT32_MAX) {
+		LOG_ERROR("OBJ with %zu positions exceeds 32-bit indices", vertexCount);
+		return false;
+	}
+
+	vertices.resize(vertexCount);
+	indices.resize(triangleCount * 3);
+
+	ParseRunParallel(chunks, [&](ObjChunk& chunk) { ParseChunk(chunk, vertexCount, vertices.data(), indices.data()); });
+
+	bool valid = std::all_of(chunks.begin(), chunks.end(), [](const ObjChunk& chunk) { return chunk.valid; });
+	if (!valid) {
+		LOG_ERROR("Malformed OBJ, expected 3 coordinates per position and 3 or more valid corners per face");
+		vertices.clear();
+		indices.clear();
+		return false;
+	}
+	return true;
+}
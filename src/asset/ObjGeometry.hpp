@@ -0,0 +1,13 @@
+#pragma once
+
+#include "../renderer/Vertex.hpp"
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Parse the positions and faces of a Wavefront OBJ. Polygons are fanned into triangles, negative indices count
+// back from the last position, texture coordinates, normals, groups and materials are skipped. Positions written
+// as `v x y z r g b` carry their color, the others are white.
+// Large inputs are split across threads at line boundaries, the outputs are resized exactly once.
+bool GeometryParseObj(std::string_view p_text, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
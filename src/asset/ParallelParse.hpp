@@ -0,0 +1,84 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+// ~~~~~~~~~~~~~
+// Building blocks of the geometry importers: split a text at line boundaries, run one thread per piece and read
+// numbers without allocating.
+// ~~~~~~~~~~~~~
+
+// Chunks smaller than this are not worth a thread of their own.
+inline constexpr size_t PARSE_MIN_CHUNK_BYTES = 1 << 20;
+
+// @brief Split p_text into one piece per hardware thread at most and PARSE_MIN_CHUNK_BYTES at least, every piece
+// but the last ends right after a newline
+inline std::vector<std::string_view> ParseSplitLines(std::string_view p_text) {
+	size_t threadCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+	size_t chunkCount = std::clamp<size_t>(p_text.size() / PARSE_MIN_CHUNK_BYTES, 1, threadCount);
+
+	std::vector<std::string_view> chunks;
+	chunks.reserve(chunkCount);
+	const char* cursor = p_text.data();
+	const char* textEnd = p_text.data() + p_text.size();
+	for (size_t i = 0; i < chunkCount && cursor < textEnd; ++i) {
+		const char* chunkEnd = textEnd;
+		if (i + 1 < chunkCount) {
+			chunkEnd = std::max(cursor, p_text.data() + p_text.size() * (i + 1) / chunkCount);
+			const char* newline = static_cast<const char*>(std::memchr(chunkEnd, '\n', static_cast<size_t>(textEnd - chunkEnd)));
+			chunkEnd = newline ? newline + 1 : textEnd;
+		}
+		chunks.emplace_back(cursor, static_cast<size_t>(chunkEnd - cursor));
+		cursor = chunkEnd;
+	}
+	if (chunks.empty()) {
+		chunks.emplace_back(p_text);
+	}
+	return chunks;
+}
+
+// @brief Run p_task on every item, one thread per item and the calling thread takes the first one
+template <typename T, typename F>
+void ParseRunParallel(std::vector<T>& p_items, F&& p_task) {
+	if (p_items.empty()) {
+		return;
+	}
+#ifdef __EMSCRIPTEN__
+	for (T& item : p_items) {
+		p_task(item);
+	}
+#else
+	std::vector<std::thread> workers;
+	workers.reserve(p_items.size() - 1);
+	for (size_t i = 1; i < p_items.size(); ++i) {
+		workers.emplace_back([&p_task, &item = p_items[i]]() { p_task(item); });
+	}
+	p_task(p_items[0]);
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+#endif	// __EMSCRIPTEN__
+}
+
+// @brief Read the number after any blanks at p_cursor and move past it
+template <typename T>
+bool ParseNumber(const char*& p_cursor, const char* p_end, T& value) {
+	while (p_cursor < p_end && (*p_cursor == ' ' || *p_cursor == '\t')) {
+		++p_cursor;
+	}
+	// from_chars rejects an explicit plus sign, the text format uses it for positive coordinates.
+	if (p_cursor < p_end && *p_cursor == '+') {
+		++p_cursor;
+	}
+	auto [next, error] = std::from_chars(p_cursor, p_end, value);
+	if (error != std::errc()) {
+		return false;
+	}
+	p_cursor = next;
+	return true;
+}
@@ -0,0 +1,183 @@
+#include "TextGeometry.hpp"
+
+#include "ParallelParse.hpp"
+#include "logging_macros.h"
+#include "tracy/Tracy.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+enum class Section : uint8_t {
+	Inherit,  // Lines before the first header of a chunk belong to whatever section the previous chunk ended in.
+	None,
+	Points,
+	Indices,
+};
+
+enum class LineKind : uint8_t {
+	Skip,
+	Header,
+	Data,
+};
+
+// A run of data lines that share a section. A chunk starts with an Inherit segment and gets a new one per header.
+struct Segment {
+	Section section;
+	uint32_t lines;
+	size_t firstItem;  // Vertex or index offset of the first line, filled between the counting and parsing passes.
+};
+
+struct Chunk {
+	const char* begin;
+	const char* end;
+	std::vector<Segment> segments;
+};
+
+static LineKind ClassifyLine(const char* p_begin, const char* p_end, Section& p_header) {
+	while (p_begin < p_end && (p_end[-1] == '\r' || p_end[-1] == ' ' || p_end[-1] == '\t')) {
+		--p_end;
+	}
+	while (p_begin < p_end && (*p_begin == ' ' || *p_begin == '\t')) {
+		++p_begin;
+	}
+
+	if (p_begin == p_end || *p_begin == '#') {
+		return LineKind::Skip;
+	}
+	if (*p_begin == '[') {
+		std::string_view header(p_begin, static_cast<size_t>(p_end - p_begin));
+		p_header = header == "[points]" ? Section::Points
+				: header == "[indices]"	? Section::Indices
+										: Section::None;
+		return LineKind::Header;
+	}
+	return LineKind::Data;
+}
+
+// @brief Call p_onLine(kind, header, lineBegin, lineEnd) for every line of the chunk
+template <typename F>
+static void ForEachLine(const Chunk& p_chunk, F&& p_onLine) {
+	const char* line = p_chunk.begin;
+	while (line < p_chunk.end) {
+		const char* newline = static_cast<const char*>(std::memchr(line, '\n', static_cast<size_t>(p_chunk.end - line)));
+		const char* lineEnd = newline ? newline : p_chunk.end;
+
+		Section header = Section::None;
+		LineKind kind = ClassifyLine(line, lineEnd, header);
+		p_onLine(kind, header, line, lineEnd);
+
+		if (newline == nullptr) {
+			break;
+		}
+		line = newline + 1;
+	}
+}
+
+static void CountChunk(Chunk& p_chunk) {
+	ZoneScoped;
+	p_chunk.segments.push_back({ Section::Inherit, 0, 0 });
+	ForEachLine(p_chunk, [&p_chunk](LineKind kind, Section header, const char*, const char*) {
+		if (kind == LineKind::Header) {
+			p_chunk.segments.push_back({ header, 0, 0 });
+		} else if (kind == LineKind::Data) {
+			p_chunk.segments.back().lines++;
+		}
+	});
+}
+
+static bool ParseChunk(const Chunk& p_chunk, Vertex* p_vertices, uint32_t* p_indices) {
+	ZoneScoped;
+	size_t segment = 0;
+	size_t item = p_chunk.segments[0].firstItem;
+	bool valid = true;
+
+	ForEachLine(p_chunk, [&](LineKind kind, Section, const char* line, const char* lineEnd) {
+		if (kind == LineKind::Header) {
+			item = p_chunk.segments[++segment].firstItem;
+			return;
+		}
+		if (kind != LineKind::Data || !valid) {
+			return;
+		}
+
+		Section section = p_chunk.segments[segment].section;
+		if (section == Section::Points) {
+			// x, y, z, r, g, b
+			Vertex& vertex = p_vertices[item++];
+			valid = ParseNumber(line, lineEnd, vertex.position.x) && ParseNumber(line, lineEnd, vertex.position.y)
+					&& ParseNumber(line, lineEnd, vertex.position.z) && ParseNumber(line, lineEnd, vertex.color.r)
+					&& ParseNumber(line, lineEnd, vertex.color.g) && ParseNumber(line, lineEnd, vertex.color.b);
+		} else if (section == Section::Indices) {
+			// Corners #0 #1 and #2
+			uint32_t* corners = p_indices + item;
+			item += 3;
+			valid = ParseNumber(line, lineEnd, corners[0]) && ParseNumber(line, lineEnd, corners[1])
+					&& ParseNumber(line, lineEnd, corners[2]);
+		}
+	});
+	return valid;
+}
+
+// @brief Parse the whole text in two passes over line-aligned chunks, one thread per chunk.
+// The first pass counts data lines per section so the outputs are sized once, the second pass writes every
+// vertex and index in place. Nothing is allocated per line.
+bool GeometryParseText(std::string_view p_text, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+	ZoneScoped;
+	std::vector<std::string_view> pieces = ParseSplitLines(p_text);
+	std::vector<Chunk> chunks(pieces.size());
+	for (size_t i = 0; i < pieces.size(); ++i) {
+		chunks[i].begin = pieces[i].data();
+		chunks[i].end = pieces[i].data() + pieces[i].size();
+	}
+
+	ParseRunParallel(chunks, CountChunk);
+
+	// Resolve the section every segment belongs to and where its output starts.
+	Section section = Section::None;
+	size_t vertexCount = 0;
+	size_t indexCount = 0;
+	for (Chunk& chunk : chunks) {
+		for (Segment& segment : chunk.segments) {
+			if (segment.section != Section::Inherit) {
+				section = segment.section;
+			}
+			segment.section = section;
+			if (section == Section::Points) {
+				segment.firstItem = vertexCount;
+				vertexCount += segment.lines;
+			} else if (section == Section::Indices) {
+				segment.firstItem = indexCount;
+				indexCount += size_t(segment.lines) * 3;
+			}
+		}
+	}
+
+	vertices.resize(vertexCount);
+	indices.resize(indexCount);
+
+	std::atomic<bool> valid = true;
+	ParseRunParallel(chunks, [&](const Chunk& chunk) {
+		if (!ParseChunk(chunk, vertices.data(), indices.data())) {
+			valid = false;
+		}
+	});
+
+	if (!valid) {
+		LOG_ERROR("Malformed geometry text, expected 6 floats per point and 3 indices per triangle");
+		vertices.clear();
+		indices.clear();
+		return false;
+	}
+	// The CPU passes after loading index vertices directly, an index past the points must not get that far.
+	auto outOfRange = std::find_if(indices.begin(), indices.end(), [vertexCount](uint32_t index) {
+		return index >= vertexCount;
+	});
+	if (outOfRange != indices.end()) {
+		LOG_ERROR("Geometry index %u is out of range, the text has %zu points", *outOfRange, vertexCount);
+		vertices.clear();
+		indices.clear();
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "../renderer/Vertex.hpp"
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Parse the `[points]`/`[indices]` text geometry format, see resources/pyramid.txt.
+// Large inputs are split across threads at line boundaries, the outputs are resized exactly once.
+bool GeometryParseText(std::string_view p_text, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
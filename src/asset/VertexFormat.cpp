@@ -0,0 +1,124 @@
+#include "VertexFormat.hpp"
+
+#include "tracy/Tracy.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+static constexpr float SNORM16_MAX = 32767.0f;
+static constexpr float UNORM16_MAX = 65535.0f;
+static constexpr float UNORM8_MAX = 255.0f;
+
+static uint32_t PositionSize(RdPositionFormat p_format) {
+	return p_format == RdPositionFormat::Float32x3 ? 3 * sizeof(float) : 4 * sizeof(uint16_t);
+}
+
+static uint32_t ColorSize(RdColorFormat p_format) {
+	return p_format == RdColorFormat::Float32x3 ? 3 * sizeof(float) : 4 * sizeof(uint8_t);
+}
+
+uint32_t RdVertexFormat::ColorOffset() const {
+	return PositionSize(position);
+}
+
+uint32_t RdVertexFormat::Stride() const {
+	return PositionSize(position) + ColorSize(color);
+}
+
+// @brief Fit the quantization range to the bounds of p_vertices, flat axes keep a scale of 1
+RdVertexDequant VertexDequantCompute(RdPositionFormat p_format, std::span<const Vertex> p_vertices) {
+	ZoneScoped;
+	RdVertexDequant dequant;
+	if (p_format == RdPositionFormat::Float32x3 || p_vertices.empty()) {
+		return dequant;
+	}
+
+	glm::vec3 min(std::numeric_limits<float>::max());
+	glm::vec3 max(std::numeric_limits<float>::lowest());
+	for (const Vertex& vertex : p_vertices) {
+		min = glm::min(min, vertex.position);
+		max = glm::max(max, vertex.position);
+	}
+
+	glm::vec3 extent = max - min;
+	for (int axis = 0; axis < 3; ++axis) {
+		if (extent[axis] <= 0.0f) {
+			extent[axis] = 2.0f;
+		}
+	}
+
+	float steps = 0.0f;
+	if (p_format == RdPositionFormat::Snorm16x4) {
+		dequant.scale = extent * 0.5f;
+		dequant.offset = (min + max) * 0.5f;
+		steps = SNORM16_MAX;
+	} else {
+		dequant.scale = extent;
+		dequant.offset = min;
+		steps = UNORM16_MAX;
+	}
+	dequant.error = glm::length(dequant.scale) * 0.5f / steps;
+	return dequant;
+}
+
+bool VertexDequantCovers(RdPositionFormat p_format, const RdVertexDequant& p_dequant, const glm::vec3& p_position) {
+	if (p_format == RdPositionFormat::Float32x3) {
+		return true;
+	}
+	glm::vec3 normalized = (p_position - p_dequant.offset) / p_dequant.scale;
+	float low = p_format == RdPositionFormat::Snorm16x4 ? -1.0f : 0.0f;
+	return glm::all(glm::greaterThanEqual(normalized, glm::vec3(low)))
+			&& glm::all(glm::lessThanEqual(normalized, glm::vec3(1.0f)));
+}
+
+void VertexEncode(
+		const RdVertexFormat& p_format,
+		const RdVertexDequant& p_dequant,
+		std::span<const Vertex> p_vertices,
+		std::byte* p_destination
+) {
+	ZoneScoped;
+	const uint32_t stride = p_format.Stride();
+	const uint32_t colorOffset = p_format.ColorOffset();
+	const glm::vec3 inverseScale = 1.0f / p_dequant.scale;
+
+	for (const Vertex& vertex : p_vertices) {
+		switch (p_format.position) {
+			case RdPositionFormat::Float32x3:
+				std::memcpy(p_destination, &vertex.position, sizeof(glm::vec3));
+				break;
+			case RdPositionFormat::Snorm16x4: {
+				glm::vec3 normalized = glm::clamp((vertex.position - p_dequant.offset) * inverseScale, -1.0f, 1.0f);
+				int16_t packed[4] = {};
+				for (int axis = 0; axis < 3; ++axis) {
+					packed[axis] = static_cast<int16_t>(std::lround(normalized[axis] * SNORM16_MAX));
+				}
+				std::memcpy(p_destination, packed, sizeof(packed));
+				break;
+			}
+			case RdPositionFormat::Unorm16x4: {
+				glm::vec3 normalized = glm::clamp((vertex.position - p_dequant.offset) * inverseScale, 0.0f, 1.0f);
+				uint16_t packed[4] = {};
+				for (int axis = 0; axis < 3; ++axis) {
+					packed[axis] = static_cast<uint16_t>(std::lround(normalized[axis] * UNORM16_MAX));
+				}
+				std::memcpy(p_destination, packed, sizeof(packed));
+				break;
+			}
+		}
+
+		if (p_format.color == RdColorFormat::Float32x3) {
+			std::memcpy(p_destination + colorOffset, &vertex.color, sizeof(glm::vec3));
+		} else {
+			glm::vec3 normalized = glm::clamp(vertex.color, 0.0f, 1.0f);
+			uint8_t packed[4] = { 0, 0, 0, static_cast<uint8_t>(UNORM8_MAX) };
+			for (int channel = 0; channel < 3; ++channel) {
+				packed[channel] = static_cast<uint8_t>(std::lround(normalized[channel] * UNORM8_MAX));
+			}
+			std::memcpy(p_destination + colorOffset, packed, sizeof(packed));
+		}
+		p_destination += stride;
+	}
+}
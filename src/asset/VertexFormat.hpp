@@ -0,0 +1,55 @@
+#pragma once
+
+#include "../renderer/Vertex.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// ~~~~~~~~~~~~~
+// GPU layouts of Vertex. Float32x3 keeps the attribute as is, the others quantize it:
+//
+//   Snorm16x4  position mapped to [-1, 1] around the center of the mesh bounds, w unused
+//   Unorm16x4  position mapped to [0, 1] from the minimum corner of the mesh bounds, w unused
+//   Unorm8x4   color clamped to [0, 1], alpha 1
+//
+// Vertices are 24 bytes unquantized and 12 with Snorm16x4 positions and Unorm8x4 colors. Attributes are packed
+// in this order, each starting at a multiple of 4 bytes.
+// ~~~~~~~~~~~~~
+enum class RdPositionFormat : uint8_t {
+	Float32x3,
+	Snorm16x4,
+	Unorm16x4,
+};
+
+enum class RdColorFormat : uint8_t {
+	Float32x3,
+	Unorm8x4,
+};
+
+struct RdVertexFormat {
+	RdPositionFormat position = RdPositionFormat::Snorm16x4;
+	RdColorFormat color = RdColorFormat::Unorm8x4;
+
+	uint32_t ColorOffset() const;
+	uint32_t Stride() const;
+};
+
+// Per-mesh transform back from quantized positions, position = decoded * scale + offset.
+struct RdVertexDequant {
+	glm::vec3 scale = glm::vec3(1.0f);
+	glm::vec3 offset = glm::vec3(0.0f);
+	// Largest distance between a position and its quantized value, bounds have to grow by it.
+	float error = 0.0f;
+};
+
+RdVertexDequant VertexDequantCompute(RdPositionFormat p_format, std::span<const Vertex> p_vertices);
+// @brief Whether p_position can be encoded with p_dequant without clamping
+bool VertexDequantCovers(RdPositionFormat p_format, const RdVertexDequant& p_dequant, const glm::vec3& p_position);
+// @brief Write p_vertices in p_format to p_destination, p_vertices.size() * p_format.Stride() bytes
+void VertexEncode(
+		const RdVertexFormat& p_format,
+		const RdVertexDequant& p_dequant,
+		std::span<const Vertex> p_vertices,
+		std::byte* p_destination
+);
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+// ~~~~~~~~~~~~~
+// Micro-benchmarks for the CPU side of the engine, run as `bench <name> [args...]`.
+// Every benchmark prints its own results through LOG_INFO and returns a process exit code.
+// ~~~~~~~~~~~~~
+int BenchGeometryParse(int argc, char** argv);
+int BenchGeometryImport(int argc, char** argv);
+int BenchFrustumCull(int argc, char** argv);
+int BenchSceneUpdate(int argc, char** argv);
+int BenchJobScaling(int argc, char** argv);
+int BenchMeshOptimize(int argc, char** argv);
+int BenchMeshLod(int argc, char** argv);
+int BenchMeshlets(int argc, char** argv);
+int BenchLogContention(int argc, char** argv);
+
+inline double BenchNowSeconds() {
+	using namespace std::chrono;
+	return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+// "1000,10000,100000" -> { 1000, 10000, 100000 }
+inline std::vector<size_t> BenchParseSizes(const char* p_list) {
+	std::vector<size_t> sizes;
+	for (const char* cursor = p_list; *cursor != '\0';) {
+		char* end = nullptr;
+		size_t value = static_cast<size_t>(std::strtoull(cursor, &end, 10));
+		if (end == cursor) {
+			break;
+		}
+		sizes.push_back(value);
+		cursor = *end == ',' ? end + 1 : end;
+	}
+	return sizes;
+}
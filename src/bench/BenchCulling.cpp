@@ -0,0 +1,103 @@
+#include "Bench.hpp"
+
+#include "../scene/Bvh.hpp"
+#include "../scene/FrustumCull.hpp"
+#include "logging_macros.h"
+#include "tracy/Tracy.hpp"
+
+#include <ext/matrix_clip_space.hpp>
+#include <ext/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// @brief p_count boxes scattered through a cube of side 2 * p_extent, a camera in the middle sees part of them
+static RdAabbSoA GenerateBoxes(size_t p_count, float p_extent) {
+	ZoneScoped;
+	uint32_t state = 0x12345678u;
+	auto random = [&state]() {
+		state = state * 1664525u + 1013904223u;
+		return static_cast<float>(state >> 8) / static_cast<float>(1u << 24);
+	};
+
+	RdAabbSoA boxes;
+	boxes.Resize(p_count);
+	for (size_t i = 0; i < p_count; ++i) {
+		glm::vec3 center = (glm::vec3(random(), random(), random()) * 2.0f - 1.0f) * p_extent;
+		glm::vec3 half = glm::vec3(random(), random(), random()) * 0.9f + 0.1f;
+		boxes.Set(i, { .min = center - half, .max = center + half });
+	}
+	return boxes;
+}
+
+// bench frustum-cull [--boxes 1000000] [--runs 20]
+int BenchFrustumCull(int argc, char** argv) {
+	size_t count = 1'000'000;
+	int runs = 20;
+	for (int i = 0; i + 1 < argc; i += 2) {
+		if (strcmp(argv[i], "--boxes") == 0) {
+			count = static_cast<size_t>(std::strtoull(argv[i + 1], nullptr, 10));
+		} else if (strcmp(argv[i], "--runs") == 0) {
+			runs = std::max(1, atoi(argv[i + 1]));
+		}
+	}
+
+	RdAabbSoA boxes = GenerateBoxes(count, 100.0f);
+	glm::mat4 projection = glm::perspectiveRH_ZO(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 150.0f);
+	glm::mat4 view = glm::lookAtRH(glm::vec3(0.0f), glm::vec3(1.0f, 0.2f, 0.5f), glm::vec3(0.0f, 1.0f, 0.0f));
+	RdFrustum frustum = RdFrustum::FromMatrix(projection * view);
+
+	std::vector<uint32_t> visible;
+	visible.reserve(count);
+	std::vector<uint32_t> reference;
+
+	auto measure = [&](auto&& cull) {
+		double best = 1e30;
+		for (int run = 0; run < runs; ++run) {
+			visible.clear();
+			double start = BenchNowSeconds();
+			cull();
+			best = std::min(best, BenchNowSeconds() - start);
+		}
+		std::sort(visible.begin(), visible.end());
+		return best;
+	};
+
+	LOG_INFO("%zu boxes, best of %d runs", count, runs);
+
+	bool matches = true;
+	double scalarSeconds = 0.0;
+	for (RdCullPath path : { RdCullPath::Scalar, RdCullPath::Sse, RdCullPath::Avx }) {
+		if (!FrustumCullSupported(path)) {
+			LOG_INFO("  ~  %-7s  unsupported", FrustumCullPathName(path));
+			continue;
+		}
+		double seconds = measure([&]() { FrustumCull(path, frustum, boxes, 0, count, nullptr, visible); });
+		if (path == RdCullPath::Scalar) {
+			scalarSeconds = seconds;
+			reference = visible;
+		}
+		bool same = visible == reference;
+		matches &= same;
+		LOG_INFO("  ~  %-7s  %8.1f boxes/us  (%.3f ms)  x%.1f  %zu visible%s",
+				 FrustumCullPathName(path), static_cast<double>(count) / seconds * 1e-6, seconds * 1e3,
+				 scalarSeconds / seconds, visible.size(), same ? "" : " (MISMATCH)");
+	}
+
+	RdBvh bvh;
+	double buildStart = BenchNowSeconds();
+	bvh.Build(boxes);
+	double buildSeconds = BenchNowSeconds() - buildStart;
+
+	double seconds = measure([&]() { bvh.Cull(frustum, visible); });
+	// Whole nodes inside the frustum skip the per-box test, boxes right on a plane may land differently.
+	size_t difference = visible.size() > reference.size() ? visible.size() - reference.size() : reference.size() - visible.size();
+	LOG_INFO("  ~  %-7s  %8.1f boxes/us  (%.3f ms)  x%.1f  %zu visible, %zu nodes built in %.1f ms%s",
+			 "bvh", static_cast<double>(count) / seconds * 1e-6, seconds * 1e3, scalarSeconds / seconds,
+			 visible.size(), bvh.nodes.size(), buildSeconds * 1e3, difference * 1000 > count ? " (MISMATCH)" : "");
+	matches &= difference * 1000 <= count;
+
+	return matches ? 0 : 1;
+}
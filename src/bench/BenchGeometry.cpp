@@ -0,0 +1,302 @@
+#include "Bench.hpp"
+
+#include "../asset/GltfGeometry.hpp"
+#include "../asset/MappedFile.hpp"
+#include "../asset/ObjGeometry.hpp"
+#include "../asset/TextGeometry.hpp"
+#include "logging_macros.h"
+#include "tracy/Tracy.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// The line-by-line iostream parser GeometryLoad used before the chunked one, kept as the baseline.
+static bool LegacyGeometryParse(std::istream& file, std::vector<Vertex>& vertices, std::vector<uint16_t>& indices) {
+	vertices.clear();
+	indices.clear();
+
+	enum class Section {
+		None,
+		Points,
+		Indices,
+	};
+	Section currentSection = Section::None;
+
+	uint16_t index;
+	std::string line;
+	while (!file.eof()) {
+		getline(file, line);
+
+		if (!line.empty() && line.back() == '\r') {
+			line.pop_back();
+		}
+
+		if (line == "[points]") {
+			currentSection = Section::Points;
+		} else if (line == "[indices]") {
+			currentSection = Section::Indices;
+		} else if (line[0] == '#' || line.empty()) {
+		} else if (currentSection == Section::Points) {
+			std::istringstream iss(line);
+			Vertex vertex;
+			iss >> vertex.position.x >> vertex.position.y >> vertex.position.z;
+			iss >> vertex.color.r >> vertex.color.g >> vertex.color.b;
+			vertices.push_back(vertex);
+		} else if (currentSection == Section::Indices) {
+			std::istringstream iss(line);
+			for (int i = 0; i < 3; ++i) {
+				iss >> index;
+				indices.push_back(index);
+			}
+		}
+	}
+	return true;
+}
+
+static bool GenerateGeometryFile(const std::filesystem::path& p_path, size_t p_vertexCount) {
+	ZoneScoped;
+	FILE* file = std::fopen(p_path.string().c_str(), "wb");
+	if (file == nullptr) {
+		return false;
+	}
+
+	uint32_t state = 0x12345678u;
+	auto random = [&state]() {
+		state = state * 1664525u + 1013904223u;
+		return static_cast<float>(state >> 8) / static_cast<float>(1u << 24);
+	};
+
+	std::fprintf(file, "[points]\n# x y z r g b\n");
+	for (size_t i = 0; i < p_vertexCount; ++i) {
+		std::fprintf(file, "%+.5f %+.5f %+.5f %.4f %.4f %.4f\n",
+					 random() * 2.0f - 1.0f, random() * 2.0f - 1.0f, random() * 2.0f - 1.0f,
+					 random(), random(), random());
+	}
+
+	// One triangle per vertex, indices stay below the 16-bit limit.
+	std::fprintf(file, "\n[indices]\n");
+	for (size_t i = 0; i < p_vertexCount; ++i) {
+		std::fprintf(file, "%zu %zu %zu\n", i % 65536, (i + 1) % 65536, (i + 2) % 65536);
+	}
+
+	return std::fclose(file) == 0;
+}
+
+// bench geometry-parse [--vertices 1000000,10000000] [--runs 3] [--dir <tmp>]
+int BenchGeometryParse(int argc, char** argv) {
+	std::vector<size_t> sizes = { 1'000'000, 10'000'000 };
+	int runs = 3;
+	std::filesystem::path directory = std::filesystem::temp_directory_path();
+	for (int i = 0; i + 1 < argc; i += 2) {
+		if (strcmp(argv[i], "--vertices") == 0) {
+			sizes = BenchParseSizes(argv[i + 1]);
+		} else if (strcmp(argv[i], "--runs") == 0) {
+			runs = std::max(1, atoi(argv[i + 1]));
+		} else if (strcmp(argv[i], "--dir") == 0) {
+			directory = argv[i + 1];
+		}
+	}
+
+	for (size_t vertexCount : sizes) {
+		std::filesystem::path path = directory / ("rengpu-bench-" + std::to_string(vertexCount) + ".txt");
+		if (!GenerateGeometryFile(path, vertexCount)) {
+			LOG_ERROR("Failed to generate %s", path.string().c_str());
+			return 1;
+		}
+		double megabytes = static_cast<double>(std::filesystem::file_size(path)) / 1e6;
+
+		double legacyBest = 1e30;
+		double chunkedBest = 1e30;
+		std::vector<Vertex> legacyVertices, vertices;
+		std::vector<uint16_t> legacyIndices;
+		std::vector<uint32_t> indices = {};
+		for (int run = 0; run < runs; ++run) {
+			double start = BenchNowSeconds();
+			std::ifstream stream(path);
+			LegacyGeometryParse(stream, legacyVertices, legacyIndices);
+			legacyBest = std::min(legacyBest, BenchNowSeconds() - start);
+
+			start = BenchNowSeconds();
+			RdMappedFile file;
+			file.Open(path);
+			GeometryParseText({ reinterpret_cast<const char*>(file.data), file.size }, vertices, indices);
+			chunkedBest = std::min(chunkedBest, BenchNowSeconds() - start);
+		}
+
+		bool matches = vertices.size() == legacyVertices.size()
+				&& std::equal(indices.begin(), indices.end(), legacyIndices.begin(), legacyIndices.end())
+				&& std::memcmp(vertices.data(), legacyVertices.data(), vertices.size() * sizeof(Vertex)) == 0;
+
+		LOG_INFO("%zu vertices, %.1f MB%s", vertexCount, megabytes, matches ? "" : " (OUTPUT MISMATCH)");
+		LOG_INFO("  ~  iostream  %8.1f MB/s  (%.3f s)", megabytes / legacyBest, legacyBest);
+		LOG_INFO("  ~  chunked   %8.1f MB/s  (%.3f s)  x%.1f", megabytes / chunkedBest, chunkedBest, legacyBest / chunkedBest);
+
+		std::filesystem::remove(path);
+		if (!matches) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+// @brief Write the same random mesh as text geometry, OBJ and GLB. Coordinates are printed with enough digits to
+// parse back to the exact floats the GLB stores, the three imports can be compared bit for bit.
+static bool GenerateImportFiles(const std::filesystem::path& p_stem, size_t p_vertexCount) {
+	ZoneScoped;
+	uint32_t state = 0x9E3779B9u;
+	auto random = [&state]() {
+		state = state * 1664525u + 1013904223u;
+		return static_cast<float>(state >> 8) / static_cast<float>(1u << 24);
+	};
+	std::vector<Vertex> vertices(p_vertexCount);
+	for (Vertex& vertex : vertices) {
+		vertex.position = glm::vec3(random(), random(), random()) * 2.0f - 1.0f;
+		vertex.color = glm::vec3(random(), random(), random());
+	}
+	std::vector<uint32_t> indices(p_vertexCount * 3);
+	for (size_t i = 0; i < p_vertexCount; ++i) {
+		for (size_t corner = 0; corner < 3; ++corner) {
+			indices[i * 3 + corner] = static_cast<uint32_t>((i + corner * 7919) % p_vertexCount);
+		}
+	}
+
+	FILE* text = std::fopen((p_stem.string() + ".txt").c_str(), "wb");
+	FILE* obj = std::fopen((p_stem.string() + ".obj").c_str(), "wb");
+	FILE* glb = std::fopen((p_stem.string() + ".glb").c_str(), "wb");
+	if (text == nullptr || obj == nullptr || glb == nullptr) {
+		for (FILE* file : { text, obj, glb }) {
+			if (file != nullptr) {
+				std::fclose(file);
+			}
+		}
+		return false;
+	}
+
+	std::fprintf(text, "[points]\n");
+	std::fprintf(obj, "# rengpu bench\no mesh\n");
+	for (const Vertex& vertex : vertices) {
+		const glm::vec3& p = vertex.position;
+		const glm::vec3& c = vertex.color;
+		std::fprintf(text, "%.9g %.9g %.9g %.9g %.9g %.9g\n", p.x, p.y, p.z, c.r, c.g, c.b);
+		std::fprintf(obj, "v %.9g %.9g %.9g %.9g %.9g %.9g\n", p.x, p.y, p.z, c.r, c.g, c.b);
+	}
+	std::fprintf(text, "\n[indices]\n");
+	for (size_t i = 0; i < indices.size(); i += 3) {
+		std::fprintf(text, "%u %u %u\n", indices[i], indices[i + 1], indices[i + 2]);
+		std::fprintf(obj, "f %u %u %u\n", indices[i] + 1, indices[i + 1] + 1, indices[i + 2] + 1);
+	}
+
+	// Interleaved like Vertex: one strided view for both attributes, one for the indices.
+	size_t vertexBytes = vertices.size() * sizeof(Vertex);
+	size_t indexBytes = indices.size() * sizeof(uint32_t);
+	char jsonBuffer[2048];
+	int jsonLength = std::snprintf(jsonBuffer, sizeof(jsonBuffer),
+			R"({"asset":{"version":"2.0"},"scene":0,"scenes":[{"nodes":[0]}],"nodes":[{"mesh":0}],)"
+			R"("meshes":[{"primitives":[{"attributes":{"POSITION":0,"COLOR_0":1},"indices":2}]}],)"
+			R"("accessors":[{"bufferView":0,"componentType":5126,"count":%zu,"type":"VEC3"},)"
+			R"({"bufferView":0,"byteOffset":12,"componentType":5126,"count":%zu,"type":"VEC3"},)"
+			R"({"bufferView":1,"componentType":5125,"count":%zu,"type":"SCALAR"}],)"
+			R"("bufferViews":[{"buffer":0,"byteLength":%zu,"byteStride":%zu},)"
+			R"({"buffer":0,"byteOffset":%zu,"byteLength":%zu}],"buffers":[{"byteLength":%zu}]})",
+			vertices.size(), vertices.size(), indices.size(), vertexBytes, sizeof(Vertex), vertexBytes, indexBytes,
+			vertexBytes + indexBytes);
+	std::string json(jsonBuffer, static_cast<size_t>(jsonLength));
+	json.resize((json.size() + 3) & ~size_t(3), ' ');
+	uint32_t binaryLength = static_cast<uint32_t>(vertexBytes + indexBytes);
+	uint32_t header[] = { 0x46546C67, 2, static_cast<uint32_t>(12 + 8 + json.size() + 8 + binaryLength) };
+	uint32_t jsonChunk[] = { static_cast<uint32_t>(json.size()), 0x4E4F534A };
+	uint32_t binaryChunk[] = { binaryLength, 0x004E4942 };
+	std::fwrite(header, sizeof(header), 1, glb);
+	std::fwrite(jsonChunk, sizeof(jsonChunk), 1, glb);
+	std::fwrite(json.data(), json.size(), 1, glb);
+	std::fwrite(binaryChunk, sizeof(binaryChunk), 1, glb);
+	std::fwrite(vertices.data(), vertexBytes, 1, glb);
+	std::fwrite(indices.data(), indexBytes, 1, glb);
+
+	bool closed = std::fclose(text) == 0;
+	closed = std::fclose(obj) == 0 && closed;
+	return std::fclose(glb) == 0 && closed;
+}
+
+// bench geometry-import [--vertices 1000000,4000000] [--runs 3] [--dir <tmp>]
+int BenchGeometryImport(int argc, char** argv) {
+	std::vector<size_t> sizes = { 1'000'000, 4'000'000 };
+	int runs = 3;
+	std::filesystem::path directory = std::filesystem::temp_directory_path();
+	for (int i = 0; i + 1 < argc; i += 2) {
+		if (strcmp(argv[i], "--vertices") == 0) {
+			sizes = BenchParseSizes(argv[i + 1]);
+		} else if (strcmp(argv[i], "--runs") == 0) {
+			runs = std::max(1, atoi(argv[i + 1]));
+		} else if (strcmp(argv[i], "--dir") == 0) {
+			directory = argv[i + 1];
+		}
+	}
+
+	struct Format {
+		const char* name;
+		const char* extension;
+		double best = 1e30;
+		double megabytes = 0.0;
+		std::vector<Vertex> vertices = {};
+		std::vector<uint32_t> indices = {};
+	};
+
+	for (size_t vertexCount : sizes) {
+		std::filesystem::path stem = directory / ("rengpu-import-" + std::to_string(vertexCount));
+		if (!GenerateImportFiles(stem, vertexCount)) {
+			LOG_ERROR("Failed to generate %s", stem.string().c_str());
+			return 1;
+		}
+
+		Format formats[] = { { "text", ".txt" }, { "obj", ".obj" }, { "glb", ".glb" } };
+		for (Format& format : formats) {
+			std::filesystem::path path = stem.string() + format.extension;
+			format.megabytes = static_cast<double>(std::filesystem::file_size(path)) / 1e6;
+			for (int run = 0; run < runs; ++run) {
+				double start = BenchNowSeconds();
+				if (format.extension == std::string_view(".glb")) {
+					GeometryParseGltf(path, format.vertices, format.indices);
+				} else {
+					RdMappedFile file;
+					file.Open(path);
+					std::string_view text(reinterpret_cast<const char*>(file.data), file.size);
+					if (format.extension == std::string_view(".obj")) {
+						GeometryParseObj(text, format.vertices, format.indices);
+					} else {
+						GeometryParseText(text, format.vertices, format.indices);
+					}
+				}
+				format.best = std::min(format.best, BenchNowSeconds() - start);
+			}
+			std::filesystem::remove(path);
+		}
+
+		// glTF colors are converted from linear, only positions and indices compare exactly.
+		const Format& reference = formats[0];
+		bool matches = true;
+		for (const Format& format : formats) {
+			matches = matches && format.vertices.size() == reference.vertices.size() && format.indices == reference.indices;
+			for (size_t v = 0; matches && v < format.vertices.size(); ++v) {
+				matches = format.vertices[v].position == reference.vertices[v].position;
+			}
+		}
+
+		LOG_INFO("%zu vertices, %zu triangles%s", vertexCount, vertexCount, matches ? "" : " (OUTPUT MISMATCH)");
+		for (const Format& format : formats) {
+			LOG_INFO("  ~  %-5s %8.1f MB  %8.1f ms  %8.1f MB/s  x%.1f", format.name, format.megabytes, format.best * 1e3,
+					 format.megabytes / format.best, reference.best / format.best);
+		}
+		if (!matches) {
+			return 1;
+		}
+	}
+	return 0;
+}
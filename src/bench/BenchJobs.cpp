@@ -0,0 +1,120 @@
+#include "Bench.hpp"
+
+#include "../jobs/JobSystem.hpp"
+#include "../scene/Bvh.hpp"
+#include "../scene/Scene.hpp"
+#include "logging_macros.h"
+#include "tracy/Tracy.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// @brief Roots scattered over the unit square, every other one with a child orbiting it
+static void SceneFill(RdScene& p_scene, size_t p_count) {
+	ZoneScoped;
+	uint32_t state = 0x9e3779b9u;
+	auto random = [&state]() {
+		state = state * 1664525u + 1013904223u;
+		return static_cast<float>(state >> 8) / static_cast<float>(1u << 24);
+	};
+
+	p_scene.Clear();
+	p_scene.Reserve(p_count);
+	glm::quat identity(1.0f, 0.0f, 0.0f, 0.0f);
+	for (size_t i = 0; i < p_count; ++i) {
+		if (i % 2 == 1) {
+			p_scene.Add(static_cast<uint32_t>(i - 1), glm::vec3(1.5f, 0.0f, 0.0f), identity, 0.5f, random() * 2.0f,
+						glm::vec4(1.0f));
+			continue;
+		}
+		glm::vec3 position(random() * 2.0f - 1.0f, random() * 2.0f - 1.0f, 0.0f);
+		p_scene.Add(RdScene::NO_PARENT, position, identity, 0.01f, random() * 2.0f, glm::vec4(1.0f));
+	}
+}
+
+// bench job-scaling [--entities 1000000] [--threads 1,2,4] [--frames 30] [--jobs 100000]
+int BenchJobScaling(int argc, char** argv) {
+	size_t count = 1'000'000;
+	size_t emptyJobs = 100'000;
+	std::vector<size_t> threads;
+	for (size_t threadCount = 1; threadCount <= std::max(std::thread::hardware_concurrency(), 1u); threadCount *= 2) {
+		threads.push_back(threadCount);
+	}
+	int frames = 30;
+	for (int i = 0; i + 1 < argc; i += 2) {
+		if (strcmp(argv[i], "--entities") == 0) {
+			count = static_cast<size_t>(std::strtoull(argv[i + 1], nullptr, 10));
+		} else if (strcmp(argv[i], "--threads") == 0) {
+			threads = BenchParseSizes(argv[i + 1]);
+		} else if (strcmp(argv[i], "--frames") == 0) {
+			frames = std::max(1, atoi(argv[i + 1]));
+		} else if (strcmp(argv[i], "--jobs") == 0) {
+			emptyJobs = std::max<size_t>(1, std::strtoull(argv[i + 1], nullptr, 10));
+		}
+	}
+
+	RdScene scene;
+	SceneFill(scene, count);
+	std::vector<Instance> instances(count);
+	RdAabbSoA bounds;
+	bounds.Resize(count);
+	RdBvh bvh;
+	RdFrustum frustum;
+	// The box |x|, |y| <= 0.5 out of the [-1, 1] square the roots are spread over.
+	const glm::vec3 normals[6] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+	for (int i = 0; i < 6; ++i) {
+		frustum.planes[i] = { normals[i], 0.5f };
+	}
+	std::vector<uint32_t> visible;
+	visible.reserve(count);
+
+	LOG_INFO("%zu entities, transforms -> refit -> cull, %d frames; %zu empty jobs", count, frames, emptyJobs);
+	double single = 0.0;
+	for (size_t threadCount : threads) {
+		RdJobSystem jobs;
+		jobs.Initialize(static_cast<uint32_t>(std::max<size_t>(threadCount, 1) - 1));
+
+		float time = 0.0f;
+		RdJobGraph graph;
+		RdJobGraph::Node transforms = graph.Add("Transforms", [&]() {
+			scene.Update(time, 1.0f, jobs, instances.data(), &bounds);
+		});
+		RdJobGraph::Node refit = graph.Add("BVH Refit", [&]() { bvh.UpdateAll(bounds); }, { transforms });
+		graph.Add("Cull", [&]() {
+			visible.clear();
+			bvh.Cull(frustum, visible);
+		}, { refit });
+
+		// The first frame sorts the levels and builds the tree.
+		graph.Run(jobs);
+		double start = BenchNowSeconds();
+		for (int frame = 0; frame < frames; ++frame) {
+			time = static_cast<float>(frame) / 60.0f;
+			graph.Run(jobs);
+		}
+		double milliseconds = (BenchNowSeconds() - start) * 1e3 / frames;
+		if (single == 0.0) {
+			single = milliseconds;
+		}
+
+		// Scheduling cost alone: submit, run and retire jobs doing nothing.
+		std::vector<RdJob> empty(emptyJobs);
+		RdJobCounter counter = static_cast<uint32_t>(emptyJobs);
+		start = BenchNowSeconds();
+		for (RdJob& job : empty) {
+			job.name = "Empty";
+			job.function = []() {};
+			job.counter = &counter;
+			jobs.Submit(&job);
+		}
+		jobs.Wait(counter);
+		double nanoseconds = (BenchNowSeconds() - start) * 1e9 / static_cast<double>(emptyJobs);
+
+		LOG_INFO("  ~  %2u threads  %7.3f ms/frame  x%.2f  %zu visible  %6.1f ns/empty job",
+				 jobs.Threads(), milliseconds, single / milliseconds, visible.size(), nanoseconds);
+	}
+	return 0;
+}
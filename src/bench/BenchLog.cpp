@@ -0,0 +1,118 @@
+#include "Bench.hpp"
+
+#include "logging_macros.h"
+#include "tracy/Tracy.hpp"
+
+#include <algorithm>
+#include <barrier>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+static constexpr const char* NULL_DEVICE = "NUL";
+#else
+static constexpr const char* NULL_DEVICE = "/dev/null";
+#endif	// _WIN32
+
+// What every LOG_* call did before the asynchronous backend: format on the stack, then a blocking fprintf.
+static void SyncLog(FILE* p_stream, int p_frame, double p_milliseconds, const char* p_name) {
+	char message[RD_LOG_MESSAGE_SIZE];
+	std::snprintf(message, sizeof(message), "frame %d took %.3f ms on %s", p_frame, p_milliseconds, p_name);
+	std::fprintf(p_stream, "%s[%s:%d %s()][%s]%s %s\n", LOG_COLORS[LL_INFO], __FILE__, __LINE__, __func__,
+				 LOG_LEVEL_STR[LL_INFO], RESET_COLOR, message);
+}
+
+enum class LogMode {
+	Sync,
+	Async,
+	Filtered,
+};
+
+// @brief Mean nanoseconds per call over p_threads threads logging p_messages each per round. The logger thread
+// catches up between rounds, outside of the timed loops, so no ring runs full.
+static double MeasureLog(LogMode p_mode, Logger& p_logger, size_t p_threads, size_t p_messages, int p_rounds) {
+	ZoneScoped;
+	std::vector<double> seconds(p_threads, 0.0);
+	std::barrier sync(static_cast<std::ptrdiff_t>(p_threads), []() noexcept { RdLogFlush(); });
+
+	auto run = [&](size_t p_thread) {
+		const char* name = "bench";
+		for (int round = 0; round < p_rounds; ++round) {
+			double start = BenchNowSeconds();
+			for (size_t i = 0; i < p_messages; ++i) {
+				int frame = static_cast<int>(i);
+				double milliseconds = static_cast<double>(i) * 0.001;
+				if (p_mode == LogMode::Sync) {
+					SyncLog(p_logger.stream, frame, milliseconds, name);
+				} else if (p_mode == LogMode::Async) {
+					LOG(p_logger, LL_INFO, "frame %d took %.3f ms on %s", frame, milliseconds, name);
+				} else {
+					LOG(p_logger, LL_TRACE, "frame %d took %.3f ms on %s", frame, milliseconds, name);
+				}
+			}
+			seconds[p_thread] += BenchNowSeconds() - start;
+			sync.arrive_and_wait();
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (size_t t = 1; t < p_threads; ++t) {
+		workers.emplace_back(run, t);
+	}
+	run(0);
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+
+	double total = 0.0;
+	for (double threadSeconds : seconds) {
+		total += threadSeconds;
+	}
+	return total * 1e9 / static_cast<double>(p_threads * p_messages * static_cast<size_t>(p_rounds));
+}
+
+// bench log-contention [--threads 1,2,4,8] [--messages 2000] [--rounds 50]
+int BenchLogContention(int argc, char** argv) {
+	std::vector<size_t> threads = { 1, 2, 4, 8 };
+	size_t messages = 2000;
+	int rounds = 50;
+	for (int i = 0; i + 1 < argc; i += 2) {
+		if (strcmp(argv[i], "--threads") == 0) {
+			threads = BenchParseSizes(argv[i + 1]);
+		} else if (strcmp(argv[i], "--messages") == 0) {
+			messages = std::max<size_t>(1, std::strtoull(argv[i + 1], nullptr, 10));
+		} else if (strcmp(argv[i], "--rounds") == 0) {
+			rounds = std::max(1, atoi(argv[i + 1]));
+		}
+	}
+
+	// Output goes nowhere, what is measured is the cost on the logging threads.
+	FILE* sink = std::fopen(NULL_DEVICE, "w");
+	if (sink == nullptr) {
+		LOG_ERROR("Failed to open %s", NULL_DEVICE);
+		return 1;
+	}
+	Logger logger = { sink, LL_INFO };
+
+	LOG_INFO("%zu messages per thread and round, %d rounds, minimum level %s", messages, rounds, LOG_LEVEL_STR[LOG_MIN_LEVEL]);
+	LOG_INFO("  ~  threads      sync ns    async ns  filtered ns   speedup");
+	uint64_t droppedBefore = RdLogBackend::Get().DroppedCount();
+	for (size_t threadCount : threads) {
+		threadCount = std::max<size_t>(threadCount, 1);
+		double sync = MeasureLog(LogMode::Sync, logger, threadCount, messages, rounds);
+		double async = MeasureLog(LogMode::Async, logger, threadCount, messages, rounds);
+		double filtered = MeasureLog(LogMode::Filtered, logger, threadCount, messages, rounds);
+		LOG_INFO("  ~  %7zu  %10.1f  %10.1f  %11.2f  %7.1fx", threadCount, sync, async, filtered, sync / async);
+	}
+	uint64_t dropped = RdLogBackend::Get().DroppedCount() - droppedBefore;
+	if (dropped > 0) {
+		LOG_WARN("%llu records dropped, the rounds are too long for the rings", static_cast<unsigned long long>(dropped));
+	}
+
+	RdLogFlush();
+	std::fclose(sink);
+	return 0;
+}
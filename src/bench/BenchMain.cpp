@@ -0,0 +1,39 @@
+#include "Bench.hpp"
+#include "logging_macros.h"
+#include "tracy/Tracy.hpp"
+
+#include <cstring>
+
+struct BenchEntry {
+	const char* name;
+	const char* description;
+	int (*run)(int argc, char** argv);
+};
+
+static const BenchEntry BENCHMARKS[] = {
+	{ "geometry-parse", "text geometry parser vs. the iostream baseline, MB/s", BenchGeometryParse },
+	{ "geometry-import", "text, OBJ and GLB import of the same mesh, ms and speedup over text", BenchGeometryImport },
+	{ "frustum-cull", "scalar, SSE, AVX and BVH frustum culling of random boxes, boxes/us", BenchFrustumCull },
+	{ "scene-update", "hierarchical transform update over 1..N threads, ms per frame", BenchSceneUpdate },
+	{ "job-scaling", "frame job graph and empty job overhead over 1..N threads", BenchJobScaling },
+	{ "mesh-optimize", "ACMR/ATVR of a shuffled scan through every optimization stage", BenchMeshOptimize },
+	{ "mesh-lod", "LOD chain of a scan and the triangles a dense instanced grid draws with it", BenchMeshLod },
+	{ "meshlets", "Meshlets of a scan and the triangles frustum and cone culling keep of it", BenchMeshlets },
+	{ "log-contention", "ns per LOG_* call over 1..N threads, synchronous vs. asynchronous", BenchLogContention },
+};
+
+int main(int argc, char** argv) {
+	if (argc >= 2) {
+		for (const BenchEntry& entry : BENCHMARKS) {
+			if (strcmp(argv[1], entry.name) == 0) {
+				return entry.run(argc - 2, argv + 2);
+			}
+		}
+	}
+
+	LOG_INFO("Usage: %s <benchmark> [args...]", argv[0]);
+	for (const BenchEntry& entry : BENCHMARKS) {
+		LOG_INFO("  ~  %-20s %s", entry.name, entry.description);
+	}
+	return argc >= 2 ? 1 : 0;
+}
@@ -0,0 +1,188 @@
+#include "Bench.hpp"
+
+#include "../asset/MeshLod.hpp"
+#include "../asset/Meshlet.hpp"
+#include "../asset/MeshOptimize.hpp"
+#include "logging_macros.h"
+#include "tracy/Tracy.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+// @brief A p_side x p_side grid bent into a half sphere, as an unindexed triangle soup in random order.
+// That is what a scanner export looks like: every corner duplicated and no locality left in the triangle order.
+static void GenerateScan(uint32_t p_side, std::vector<Vertex>& p_vertices, std::vector<uint32_t>& p_indices) {
+	ZoneScoped;
+	auto corner = [p_side](uint32_t x, uint32_t y) {
+		float u = static_cast<float>(x) / static_cast<float>(p_side) * 2.0f - 1.0f;
+		float v = static_cast<float>(y) / static_cast<float>(p_side) * 2.0f - 1.0f;
+		float z = std::sqrt(std::max(0.0f, 2.0f - u * u - v * v));
+		return Vertex{ glm::vec3(u, v, z), glm::vec3(0.5f * u + 0.5f, 0.5f * v + 0.5f, 0.5f) };
+	};
+
+	std::vector<uint32_t> order(2 * p_side * p_side);
+	std::iota(order.begin(), order.end(), 0u);
+	uint32_t state = 0x9e3779b9u;
+	for (size_t i = order.size(); i > 1; --i) {
+		state = state * 1664525u + 1013904223u;
+		std::swap(order[i - 1], order[state % i]);
+	}
+
+	p_vertices.clear();
+	p_indices.clear();
+	for (uint32_t triangle : order) {
+		uint32_t cell = triangle / 2;
+		uint32_t x = cell % p_side;
+		uint32_t y = cell / p_side;
+		Vertex corners[4] = { corner(x, y), corner(x + 1, y), corner(x, y + 1), corner(x + 1, y + 1) };
+		static constexpr int PICKS[2][3] = { { 0, 1, 2 }, { 2, 1, 3 } };
+		for (int pick : PICKS[triangle % 2]) {
+			p_indices.push_back(static_cast<uint32_t>(p_vertices.size()));
+			p_vertices.push_back(corners[pick]);
+		}
+	}
+}
+
+// bench mesh-optimize [--side 512]
+int BenchMeshOptimize(int argc, char** argv) {
+	uint32_t side = 512;
+	for (int i = 0; i + 1 < argc; i += 2) {
+		if (strcmp(argv[i], "--side") == 0) {
+			side = static_cast<uint32_t>(std::max(1, atoi(argv[i + 1])));
+		}
+	}
+
+	std::vector<Vertex> vertices;
+	std::vector<uint32_t> indices;
+	GenerateScan(side, vertices, indices);
+	LOG_INFO("Mesh optimize: %zu triangles, %zu vertices in", indices.size() / 3, vertices.size());
+	LOG_INFO("  ~  %-14s %10s %8s %8s %10s", "stage", "vertices", "ACMR", "ATVR", "ms");
+
+	auto report = [&](const char* stage, double seconds) {
+		RdVertexCacheStats stats = MeshAnalyzeVertexCache(indices, vertices.size());
+		LOG_INFO("  ~  %-14s %10zu %8.3f %8.3f %10.2f", stage, vertices.size(), stats.acmr, stats.atvr, seconds * 1e3);
+	};
+
+	report("input", 0.0);
+	double start = BenchNowSeconds();
+	MeshDeduplicate(vertices, indices);
+	report("deduplicate", BenchNowSeconds() - start);
+
+	start = BenchNowSeconds();
+	MeshOptimizeVertexCache(indices, vertices.size());
+	report("vertex cache", BenchNowSeconds() - start);
+
+	start = BenchNowSeconds();
+	MeshOptimizeOverdraw(indices, vertices);
+	report("overdraw", BenchNowSeconds() - start);
+
+	start = BenchNowSeconds();
+	MeshOptimizeVertexFetch(vertices, indices);
+	report("vertex fetch", BenchNowSeconds() - start);
+	return 0;
+}
+
+// bench mesh-lod [--side 256] [--instances 10000] [--error 1]
+// Builds the chain of the optimized scan, then picks a level for every instance of a grid laid out like
+// Application::InstancesSet in an 800 pixel wide view, and counts the triangles drawn with and without levels.
+int BenchMeshLod(int argc, char** argv) {
+	uint32_t side = 256;
+	uint32_t instanceCount = 10000;
+	float errorPixels = 1.0f;
+	for (int i = 0; i + 1 < argc; i += 2) {
+		if (strcmp(argv[i], "--side") == 0) {
+			side = static_cast<uint32_t>(std::max(1, atoi(argv[i + 1])));
+		} else if (strcmp(argv[i], "--instances") == 0) {
+			instanceCount = static_cast<uint32_t>(std::max(1, atoi(argv[i + 1])));
+		} else if (strcmp(argv[i], "--error") == 0) {
+			errorPixels = std::max(static_cast<float>(atof(argv[i + 1])), 1e-3f);
+		}
+	}
+
+	std::vector<Vertex> vertices;
+	std::vector<uint32_t> indices;
+	GenerateScan(side, vertices, indices);
+	MeshOptimize(vertices, indices);
+
+	double start = BenchNowSeconds();
+	std::vector<RdMeshLod> lods = MeshLodChainBuild(vertices, indices);
+	double seconds = BenchNowSeconds() - start;
+	LOG_INFO("Mesh LOD: %u triangles, chain built in %.2f ms", lods[0].indexCount / 3, seconds * 1e3);
+	LOG_INFO("  ~  %5s %10s %12s", "level", "triangles", "error");
+	for (size_t l = 0; l < lods.size(); ++l) {
+		LOG_INFO("  ~  %5zu %10u %12.6f", l, lods[l].indexCount / 3, lods[l].error);
+	}
+
+	// The mesh spans [-1, 1]^2 while the pyramid spans half that, scale instances to cover their cell alike.
+	uint32_t gridSide = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(instanceCount))));
+	float scale = 2.0f / static_cast<float>(gridSide) * 0.15f;
+	float pixelsPerUnit = scale * 800.0f * 0.5f / errorPixels;
+
+	std::vector<uint32_t> selected(instanceCount);
+	start = BenchNowSeconds();
+	for (uint32_t i = 0; i < instanceCount; ++i) {
+		// Every fourth copy is a smaller moon in the application.
+		selected[i] = MeshLodSelect(lods, pixelsPerUnit * (i % 4 == 3 ? 0.4f : 1.0f));
+	}
+	seconds = BenchNowSeconds() - start;
+
+	uint64_t full = static_cast<uint64_t>(instanceCount) * (lods[0].indexCount / 3);
+	uint64_t drawn = 0;
+	for (uint32_t level : selected) {
+		drawn += lods[level].indexCount / 3;
+	}
+	LOG_INFO("Dense scene: %u instances, %.2f px tolerated, selection %.2f ns per instance",
+			 instanceCount, errorPixels, seconds * 1e9 / instanceCount);
+	LOG_INFO("  ~  triangles %llu -> %llu (/ %.1f)", static_cast<unsigned long long>(full),
+			 static_cast<unsigned long long>(drawn), static_cast<double>(full) / static_cast<double>(std::max<uint64_t>(drawn, 1)));
+	return 0;
+}
+
+// bench meshlets [--side 512]
+// Builds the meshlets of the optimized scan, then counts the triangles meshlets.wgsl would keep while zooming onto
+// the middle of the dome, seen from the outside it faces and from the inside.
+int BenchMeshlets(int argc, char** argv) {
+	uint32_t side = 512;
+	for (int i = 0; i + 1 < argc; i += 2) {
+		if (strcmp(argv[i], "--side") == 0) {
+			side = static_cast<uint32_t>(std::max(1, atoi(argv[i + 1])));
+		}
+	}
+
+	std::vector<Vertex> vertices;
+	std::vector<uint32_t> indices;
+	GenerateScan(side, vertices, indices);
+	MeshOptimize(vertices, indices);
+
+	double start = BenchNowSeconds();
+	std::vector<RdMeshlet> meshlets = MeshletsBuild(vertices, indices);
+	double seconds = BenchNowSeconds() - start;
+	LOG_INFO("Meshlets: %zu triangles, %zu meshlets built in %.2f ms", indices.size() / 3, meshlets.size(), seconds * 1e3);
+
+	// Orthographic views along z, the dome bulges towards +z.
+	LOG_INFO("  ~  %6s %8s %10s %12s %8s", "zoom", "view", "meshlets", "triangles", "kept");
+	for (float zoom : { 1.0f, 4.0f, 16.0f }) {
+		for (float direction : { -1.0f, 1.0f }) {
+			glm::vec2 extent(1.0f / zoom, 0.75f / zoom);
+			size_t keptMeshlets = 0;
+			size_t keptTriangles = 0;
+			for (const RdMeshlet& meshlet : meshlets) {
+				glm::vec2 offset = glm::abs(glm::vec2(meshlet.center));
+				if (offset.x - meshlet.radius > extent.x || offset.y - meshlet.radius > extent.y
+					|| MeshletBackfacing(meshlet, meshlet.coneAxis, glm::vec3(0.0f, 0.0f, direction))) {
+					continue;
+				}
+				keptMeshlets++;
+				keptTriangles += meshlet.indexCount / 3;
+			}
+			LOG_INFO("  ~  %6.0f %8s %10zu %12zu %7.1f%%", zoom, direction < 0.0f ? "outside" : "inside",
+					 keptMeshlets, keptTriangles,
+					 100.0 * static_cast<double>(keptTriangles) / static_cast<double>(indices.size() / 3));
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,86 @@
+#include "Bench.hpp"
+
+#include "../scene/Scene.hpp"
+#include "logging_macros.h"
+#include "tracy/Tracy.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// @brief Roots scattered over the unit square, each with three children and one grandchild
+static void SceneFill(RdScene& p_scene, size_t p_count) {
+	ZoneScoped;
+	uint32_t state = 0x12345678u;
+	auto random = [&state]() {
+		state = state * 1664525u + 1013904223u;
+		return static_cast<float>(state >> 8) / static_cast<float>(1u << 24);
+	};
+
+	p_scene.Clear();
+	p_scene.Reserve(p_count);
+	glm::quat identity(1.0f, 0.0f, 0.0f, 0.0f);
+	for (size_t i = 0; i < p_count; ++i) {
+		uint32_t parent = RdScene::NO_PARENT;
+		if (i % 5 == 4) {
+			parent = static_cast<uint32_t>(i - 1);
+		} else if (i % 5 != 0) {
+			parent = static_cast<uint32_t>(i - i % 5);
+		}
+		glm::vec3 position = parent == RdScene::NO_PARENT
+				? glm::vec3(random() * 2.0f - 1.0f, random() * 2.0f - 1.0f, 0.0f)
+				: glm::vec3(1.5f, 0.0f, 0.0f);
+		p_scene.Add(parent, position, identity, 0.5f, random() * 2.0f, glm::vec4(random(), random(), random(), 1.0f));
+	}
+}
+
+// bench scene-update [--entities 100000,1000000] [--threads 1,2,4] [--frames 100]
+int BenchSceneUpdate(int argc, char** argv) {
+	std::vector<size_t> sizes = { 100'000, 1'000'000 };
+	std::vector<size_t> threads;
+	for (size_t count = 1; count <= std::max(std::thread::hardware_concurrency(), 1u); count *= 2) {
+		threads.push_back(count);
+	}
+	int frames = 100;
+	for (int i = 0; i + 1 < argc; i += 2) {
+		if (strcmp(argv[i], "--entities") == 0) {
+			sizes = BenchParseSizes(argv[i + 1]);
+		} else if (strcmp(argv[i], "--threads") == 0) {
+			threads = BenchParseSizes(argv[i + 1]);
+		} else if (strcmp(argv[i], "--frames") == 0) {
+			frames = std::max(1, atoi(argv[i + 1]));
+		}
+	}
+
+	for (size_t count : sizes) {
+		RdScene scene;
+		SceneFill(scene, count);
+		std::vector<Instance> instances(count);
+		RdAabbSoA bounds;
+		bounds.Resize(count);
+
+		LOG_INFO("%zu entities, %d frames", count, frames);
+		double single = 0.0;
+		for (size_t threadCount : threads) {
+			RdJobSystem jobs;
+			jobs.Initialize(static_cast<uint32_t>(std::max<size_t>(threadCount, 1) - 1));
+			// The first update sorts the levels, keep it out of the measurement.
+			scene.Update(0.0f, 1.0f, jobs, instances.data(), &bounds);
+
+			double start = BenchNowSeconds();
+			for (int frame = 0; frame < frames; ++frame) {
+				scene.Update(static_cast<float>(frame) / 60.0f, 1.0f, jobs, instances.data(), &bounds);
+			}
+			double milliseconds = (BenchNowSeconds() - start) * 1e3 / frames;
+			if (single == 0.0) {
+				single = milliseconds;
+			}
+			LOG_INFO("  ~  %2u threads  %7.3f ms/frame  %7.1f entities/us  x%.1f",
+					 jobs.Threads(), milliseconds, static_cast<double>(count) / milliseconds * 1e-3,
+					 single / milliseconds);
+		}
+	}
+	return 0;
+}
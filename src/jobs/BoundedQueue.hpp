@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+// @brief Fixed capacity multi-producer multi-consumer queue after Vyukov: every cell carries a sequence number
+// telling whether it is ready to be written or read in the current lap, producers and consumers claim cells with
+// a compare-exchange on their own cursor and never wait on each other. p_capacity has to be a power of two.
+template <typename T, size_t p_capacity>
+struct RdBoundedQueue {
+	static_assert(p_capacity >= 2 && (p_capacity & (p_capacity - 1)) == 0, "Capacity has to be a power of two");
+
+	RdBoundedQueue() {
+		for (size_t i = 0; i < p_capacity; ++i) {
+			m_cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	RdBoundedQueue(const RdBoundedQueue&) = delete;
+	RdBoundedQueue& operator=(const RdBoundedQueue&) = delete;
+
+	// @brief Any thread, false when the queue is full
+	bool Push(T p_value) {
+		size_t position = m_tail.load(std::memory_order_relaxed);
+		for (;;) {
+			Cell& cell = m_cells[position & (p_capacity - 1)];
+			size_t sequence = cell.sequence.load(std::memory_order_acquire);
+			intptr_t lap = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+			if (lap == 0) {
+				if (m_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+					cell.value = std::move(p_value);
+					cell.sequence.store(position + 1, std::memory_order_release);
+					return true;
+				}
+			} else if (lap < 0) {
+				return false;
+			} else {
+				position = m_tail.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	// @brief Any thread, oldest value first, empty when the queue is
+	std::optional<T> Pop() {
+		size_t position = m_head.load(std::memory_order_relaxed);
+		for (;;) {
+			Cell& cell = m_cells[position & (p_capacity - 1)];
+			size_t sequence = cell.sequence.load(std::memory_order_acquire);
+			intptr_t lap = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+			if (lap == 0) {
+				if (m_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+					T value = std::move(cell.value);
+					cell.sequence.store(position + p_capacity, std::memory_order_release);
+					return value;
+				}
+			} else if (lap < 0) {
+				return std::nullopt;
+			} else {
+				position = m_head.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	// @brief Values pushed and not popped yet, only exact while no other thread touches the queue
+	size_t Size() const {
+		size_t tail = m_tail.load(std::memory_order_relaxed);
+		size_t head = m_head.load(std::memory_order_relaxed);
+		return tail >= head ? tail - head : 0;
+	}
+
+private:
+	struct Cell {
+		std::atomic<size_t> sequence;
+		T value;
+	};
+
+	Cell m_cells[p_capacity];
+	alignas(64) std::atomic<size_t> m_tail = 0;
+	alignas(64) std::atomic<size_t> m_head = 0;
+};
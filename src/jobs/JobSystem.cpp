@@ -0,0 +1,217 @@
+#include "JobSystem.hpp"
+
+#include "logging_macros.h"
+#include "tracy/Tracy.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+static thread_local uint32_t s_threadIndex = RdJobSystem::FOREIGN_THREAD;
+
+void RdJobSystem::Initialize(uint32_t p_workers) {
+	ZoneScoped;
+	Terminate();
+	if (p_workers == AUTO_WORKERS) {
+		p_workers = std::max(std::thread::hardware_concurrency(), 1u) - 1;
+	}
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+	// Without pthreads every job runs on the thread that submits it.
+	p_workers = 0;
+#endif	// __EMSCRIPTEN__
+
+	s_threadIndex = 0;
+	m_deques.clear();
+	for (uint32_t i = 0; i <= p_workers; ++i) {
+		m_deques.push_back(std::make_unique<RdWorkDeque>());
+	}
+	m_running = true;
+	for (uint32_t i = 1; i <= p_workers; ++i) {
+		m_workers.emplace_back(&RdJobSystem::Worker, this, i);
+	}
+	LOG_INFO("Job system: %u threads", Threads());
+}
+
+void RdJobSystem::Terminate() {
+	if (!m_running) {
+		return;
+	}
+	{
+		std::lock_guard lock(m_mutex);
+		m_running = false;
+	}
+	m_wake.notify_all();
+	for (std::thread& worker : m_workers) {
+		worker.join();
+	}
+	m_workers.clear();
+	LOG_TRACE("Job system terminated");
+}
+
+uint32_t RdJobSystem::Threads() const {
+	return static_cast<uint32_t>(m_workers.size()) + 1;
+}
+
+uint32_t RdJobSystem::ThreadIndex() {
+	return s_threadIndex;
+}
+
+void RdJobSystem::Submit(RdJob* p_job) {
+	// Without workers, from a foreign thread or with a full deque, the submitting thread just runs the job.
+	if (m_workers.empty() || s_threadIndex == FOREIGN_THREAD || !m_deques[s_threadIndex]->Push(p_job)) {
+		Execute(p_job);
+		return;
+	}
+	m_queued.fetch_add(1, std::memory_order_seq_cst);
+	if (m_sleeping.load(std::memory_order_seq_cst) > 0) {
+		std::lock_guard lock(m_mutex);
+		m_wake.notify_one();
+	}
+}
+
+// @brief Own deque first, then steal going round the others starting after the own one
+RdJob* RdJobSystem::Find(uint32_t p_index) {
+	RdJob* job = p_index != FOREIGN_THREAD ? m_deques[p_index]->Pop() : nullptr;
+	uint32_t count = static_cast<uint32_t>(m_deques.size());
+	uint32_t start = p_index != FOREIGN_THREAD ? p_index + 1 : 0;
+	for (uint32_t i = 0; job == nullptr && i < count; ++i) {
+		uint32_t victim = (start + i) % count;
+		if (victim != p_index) {
+			job = m_deques[victim]->Steal();
+		}
+	}
+	if (job != nullptr) {
+		m_queued.fetch_sub(1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+void RdJobSystem::Execute(RdJob* p_job) {
+	ZoneScoped;
+	ZoneName(p_job->name, std::strlen(p_job->name));
+	p_job->function();
+
+	for (RdJob* successor : p_job->successors) {
+		if (successor->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			Submit(successor);
+		}
+	}
+	// The owner may free the job as soon as the counter drops, nothing touches it afterwards.
+	if (p_job->counter != nullptr) {
+		p_job->counter->fetch_sub(1, std::memory_order_release);
+	}
+}
+
+void RdJobSystem::Wait(const RdJobCounter& p_counter) {
+	ZoneScoped;
+	uint32_t index = s_threadIndex;
+	while (p_counter.load(std::memory_order_acquire) > 0) {
+		RdJob* job = m_workers.empty() ? nullptr : Find(index);
+		if (job != nullptr) {
+			Execute(job);
+		} else {
+			std::this_thread::yield();
+		}
+	}
+}
+
+void RdJobSystem::Worker(uint32_t p_index) {
+	s_threadIndex = p_index;
+	std::string name = "Job Worker " + std::to_string(p_index);
+	tracy::SetThreadName(name.c_str());
+
+	uint32_t idle = 0;
+	while (m_running.load(std::memory_order_relaxed)) {
+		RdJob* job = Find(p_index);
+		if (job != nullptr) {
+			Execute(job);
+			idle = 0;
+			continue;
+		}
+
+		// Spin a little before sleeping, frames submit bursts of short jobs.
+		if (++idle < 64) {
+			std::this_thread::yield();
+			continue;
+		}
+		std::unique_lock lock(m_mutex);
+		m_sleeping.fetch_add(1, std::memory_order_seq_cst);
+		m_wake.wait(lock, [this]() {
+			return !m_running.load(std::memory_order_relaxed) || m_queued.load(std::memory_order_seq_cst) > 0;
+		});
+		m_sleeping.fetch_sub(1, std::memory_order_seq_cst);
+		idle = 0;
+	}
+}
+
+void RdJobSystem::ParallelFor(
+		size_t p_count,
+		size_t p_batchSize,
+		const std::function<void(size_t, size_t)>& p_batch
+) {
+	ZoneScoped;
+	p_batchSize = std::max<size_t>(p_batchSize, 1);
+	// A single batch is not worth a job.
+	if (m_workers.empty() || p_count <= p_batchSize) {
+		if (p_count > 0) {
+			p_batch(0, p_count);
+		}
+		return;
+	}
+
+	size_t batches = (p_count + p_batchSize - 1) / p_batchSize;
+	std::vector<RdJob> jobs(batches);
+	RdJobCounter counter = static_cast<uint32_t>(batches);
+	for (size_t i = 0; i < batches; ++i) {
+		size_t begin = i * p_batchSize;
+		size_t end = std::min(begin + p_batchSize, p_count);
+		jobs[i].name = "Parallel Batch";
+		jobs[i].function = [&p_batch, begin, end]() { p_batch(begin, end); };
+		jobs[i].counter = &counter;
+		Submit(&jobs[i]);
+	}
+	Wait(counter);
+}
+
+RdJobSystem::~RdJobSystem() {
+	Terminate();
+}
+
+RdJobGraph::Node RdJobGraph::Add(
+		const char* p_name,
+		std::function<void()> p_function,
+		std::initializer_list<Node> p_dependencies
+) {
+	Node node = static_cast<Node>(m_jobs.size());
+	RdJob& job = m_jobs.emplace_back();
+	job.name = p_name;
+	job.function = std::move(p_function);
+	job.counter = &m_counter;
+	m_dependencies.push_back(static_cast<uint32_t>(p_dependencies.size()));
+	for (Node dependency : p_dependencies) {
+		m_jobs[dependency].successors.push_back(&job);
+	}
+	return node;
+}
+
+void RdJobGraph::Run(RdJobSystem& p_jobs) {
+	ZoneScoped;
+	m_counter = static_cast<uint32_t>(m_jobs.size());
+	// Roots are collected first, a root may finish and queue a successor before the loop reaches it.
+	std::vector<RdJob*> roots;
+	for (size_t i = 0; i < m_jobs.size(); ++i) {
+		m_jobs[i].pending.store(m_dependencies[i], std::memory_order_relaxed);
+		if (m_dependencies[i] == 0) {
+			roots.push_back(&m_jobs[i]);
+		}
+	}
+	for (RdJob* root : roots) {
+		p_jobs.Submit(root);
+	}
+	p_jobs.Wait(m_counter);
+}
+
+void RdJobGraph::Clear() {
+	m_jobs.clear();
+	m_dependencies.clear();
+}
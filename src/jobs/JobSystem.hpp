@@ -0,0 +1,88 @@
+#pragma once
+
+#include "WorkDeque.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Number of jobs still running, whoever waits on it owns the jobs and keeps them alive until it reaches 0.
+using RdJobCounter = std::atomic<uint32_t>;
+
+struct RdJob {
+	const char* name;
+	std::function<void()> function;
+	// Unfinished dependencies, the job is queued when the last one finishes.
+	std::atomic<uint32_t> pending = 0;
+	std::vector<RdJob*> successors;
+	RdJobCounter* counter = nullptr;
+};
+
+// @brief Work-stealing scheduler: every thread owns a deque, idle workers steal the oldest job of another one.
+// The thread that called Initialize() is thread 0 and may submit and wait, waiting threads run jobs meanwhile,
+// so jobs can submit and wait for jobs of their own. Other threads run what they submit themselves.
+struct RdJobSystem {
+	static constexpr uint32_t FOREIGN_THREAD = UINT32_MAX;
+	static constexpr uint32_t AUTO_WORKERS = UINT32_MAX;
+
+	// @brief Start p_workers threads besides the caller, by default one less than the hardware threads
+	void Initialize(uint32_t p_workers = AUTO_WORKERS);
+	void Terminate();
+
+	// @brief Queue p_job on the deque of the calling thread, it has to stay alive until its counter reaches 0
+	void Submit(RdJob* p_job);
+	void Wait(const RdJobCounter& p_counter);
+
+	// @brief Run p_batch(begin, end) over [0, p_count) in batches of p_batchSize and wait for all of them
+	void ParallelFor(size_t p_count, size_t p_batchSize, const std::function<void(size_t, size_t)>& p_batch);
+
+	// @brief Threads running jobs, the caller of Initialize() included
+	uint32_t Threads() const;
+	// @brief Index of the calling thread, 0 for the caller of Initialize(), FOREIGN_THREAD outside the system
+	static uint32_t ThreadIndex();
+
+	RdJobSystem() = default;
+	~RdJobSystem();
+
+	RdJobSystem(const RdJobSystem&) = delete;
+	RdJobSystem& operator=(const RdJobSystem&) = delete;
+
+private:
+	void Worker(uint32_t p_index);
+	RdJob* Find(uint32_t p_index);
+	void Execute(RdJob* p_job);
+
+	std::vector<std::unique_ptr<RdWorkDeque>> m_deques;
+	std::vector<std::thread> m_workers;
+	std::atomic<bool> m_running = false;
+
+	// Sleeping workers are woken through m_wake whenever a job is queued.
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::atomic<uint32_t> m_queued = 0;
+	std::atomic<uint32_t> m_sleeping = 0;
+};
+
+// @brief Jobs with dependencies between them, run to completion by each call to Run().
+struct RdJobGraph {
+	using Node = uint32_t;
+
+	Node Add(const char* p_name, std::function<void()> p_function, std::initializer_list<Node> p_dependencies = {});
+	// @brief Queue every job without dependencies and wait until the whole graph finished
+	void Run(RdJobSystem& p_jobs);
+	void Clear();
+
+private:
+	// A deque keeps the jobs in place while nodes are added.
+	std::deque<RdJob> m_jobs;
+	std::vector<uint32_t> m_dependencies;
+	RdJobCounter m_counter = 0;
+};
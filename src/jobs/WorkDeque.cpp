@@ -0,0 +1,50 @@
+#include "WorkDeque.hpp"
+
+// Sequentially consistent accesses on top and bottom stand in for the fences of the original algorithm.
+bool RdWorkDeque::Push(RdJob* p_job) {
+	int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+	int64_t top = m_top.load(std::memory_order_acquire);
+	if (bottom - top >= CAPACITY) {
+		return false;
+	}
+	m_jobs[bottom & (CAPACITY - 1)].store(p_job, std::memory_order_relaxed);
+	m_bottom.store(bottom + 1, std::memory_order_release);
+	return true;
+}
+
+RdJob* RdWorkDeque::Pop() {
+	int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+	m_bottom.store(bottom, std::memory_order_seq_cst);
+	int64_t top = m_top.load(std::memory_order_seq_cst);
+	if (top > bottom) {
+		m_bottom.store(bottom + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	RdJob* job = m_jobs[bottom & (CAPACITY - 1)].load(std::memory_order_relaxed);
+	if (top == bottom) {
+		// Last job, a thief may be taking it at the same time.
+		if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+			job = nullptr;
+		}
+		m_bottom.store(bottom + 1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+RdJob* RdWorkDeque::Steal() {
+	int64_t top = m_top.load(std::memory_order_seq_cst);
+	int64_t bottom = m_bottom.load(std::memory_order_seq_cst);
+	if (top >= bottom) {
+		return nullptr;
+	}
+	RdJob* job = m_jobs[top & (CAPACITY - 1)].load(std::memory_order_relaxed);
+	if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+		return nullptr;
+	}
+	return job;
+}
+
+bool RdWorkDeque::Empty() const {
+	return m_top.load(std::memory_order_relaxed) >= m_bottom.load(std::memory_order_relaxed);
+}
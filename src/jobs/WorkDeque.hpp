@@ -0,0 +1,26 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+struct RdJob;
+
+// @brief Fixed capacity Chase-Lev deque: the owning thread pushes and pops at the bottom without locking,
+// any other thread steals from the top, a compare-exchange on top settles races for the last job.
+struct RdWorkDeque {
+	static constexpr int64_t CAPACITY = 4096;
+
+	// @brief Owner only, false when the deque is full
+	bool Push(RdJob* p_job);
+	// @brief Owner only, newest job first
+	RdJob* Pop();
+	// @brief Any thread, oldest job first, nullptr when empty or another thread won the job
+	RdJob* Steal();
+	bool Empty() const;
+
+private:
+	alignas(64) std::atomic<int64_t> m_top = 0;
+	alignas(64) std::atomic<int64_t> m_bottom = 0;
+	std::atomic<RdJob*> m_jobs[CAPACITY] = {};
+};
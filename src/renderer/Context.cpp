@@ -8,7 +8,10 @@
 #include <webgpu/wgpu.h>   
 #endif  // WEBGPU_BACKEND_WGPU
 
+#include <algorithm>
+#include <cstring>
 #include <utility>
+#include <vector>
 
 
 #ifdef __EMSCRIPTEN__
@@ -59,7 +62,6 @@ void RdContext::Initialize(WGPUInstance p_instance, RdSurface p_rdSurface, RdDri
     ERR(p_rdSurface.surface == nullptr, "Surface is null when initializing renderer context");
 	rdSurface = std::move(p_rdSurface);
 
-	// ~~~~~~~~~ ADAPTER ~~~~~~~~~~
 	WGPURequestAdapterOptions options = {
 		.nextInChain = nullptr,
 		.compatibleSurface = rdSurface.surface,
@@ -68,9 +70,33 @@ void RdContext::Initialize(WGPUInstance p_instance, RdSurface p_rdSurface, RdDri
 		.forceFallbackAdapter = false,
 	};
 
+	DeviceRequest(options, p_driver);
+}
+
+// @brief Initialize a context without a window, frames are rendered into an offscreen target.
+// With p_forceFallbackAdapter the adapter is a software one, so it runs on machines without a GPU.
+void RdContext::InitializeHeadless(WGPUInstance p_instance, bool p_forceFallbackAdapter, RdDriver* p_driver) {
+    ZoneScoped;
+	instance = p_instance;
+	headless = true;
+
+	WGPURequestAdapterOptions options = {
+		.nextInChain = nullptr,
+		.compatibleSurface = nullptr,
+		.powerPreference = WGPUPowerPreference_Undefined,
+		.backendType = WGPUBackendType_Undefined,
+		.forceFallbackAdapter = p_forceFallbackAdapter,
+	};
+
+	DeviceRequest(options, p_driver);
+}
+
+void RdContext::DeviceRequest(const WGPURequestAdapterOptions& p_options, RdDriver* p_driver) {
+    ZoneScoped;
+	// ~~~~~~~~~ ADAPTER ~~~~~~~~~~
 	adapter = nullptr;
 	LOG_TRACE("WEBGPU adapter requested");
-	wgpuInstanceRequestAdapter(instance, &options, onAdapterRequestEnded, this);
+	wgpuInstanceRequestAdapter(instance, &p_options, onAdapterRequestEnded, this);
 
 #ifdef __EMSCRIPTEN__
 	while (adapter == nullptr) {
@@ -82,12 +108,43 @@ void RdContext::Initialize(WGPUInstance p_instance, RdSurface p_rdSurface, RdDri
 		"Adapter is null when requested ended, probably browser is not supported");
 
 	// ~~~~~~~~~ DEVICE ~~~~~~~~~~
+	WGPURequiredLimits requiredLimits = {
+		.nextInChain = nullptr,
+		.limits = {},
+	};
+	bool limitsKnown = LimitsNegotiate(requiredLimits);
+
+#ifdef WEBGPU_BACKEND_DAWN
+	// Dawn hands compiled pipeline blobs to the cache, which keeps them on disk between launches.
+	p_driver->pipelineCache.directory = std::filesystem::path(CACHE_DIR) / "pipelines";
+	WGPUDawnCacheDeviceDescriptor cacheDesc = {
+		.chain = {
+			.next = nullptr,
+			.sType = WGPUSType_DawnCacheDeviceDescriptor,
+		},
+		.isolationKey = "rengpu",
+		.loadDataFunction = RdPipelineCache::DiskLoad,
+		.storeDataFunction = RdPipelineCache::DiskStore,
+		.functionUserdata = &p_driver->pipelineCache,
+	};
+	const WGPUChainedStruct* deviceChain = &cacheDesc.chain;
+#else
+	// No persistent pipeline cache through webgpu.h here, pipelines are only deduplicated in memory.
+	const WGPUChainedStruct* deviceChain = nullptr;
+#endif	// WEBGPU_BACKEND_DAWN
+
+	// Optional features are only requested when the adapter has them, what they back is turned off otherwise.
+	std::vector<WGPUFeatureName> features;
+	if (wgpuAdapterHasFeature(adapter, WGPUFeatureName_TimestampQuery)) {
+		features.push_back(WGPUFeatureName_TimestampQuery);
+	}
+
 	WGPUDeviceDescriptor deviceDesc = {
-        .nextInChain = nullptr,
+        .nextInChain = deviceChain,
         .label = "My Device",
-        .requiredFeatureCount = 0,
-        .requiredFeatures = nullptr,
-        .requiredLimits = nullptr,
+        .requiredFeatureCount = features.size(),
+        .requiredFeatures = features.data(),
+        .requiredLimits = limitsKnown ? &requiredLimits : nullptr,
         .defaultQueue = {
             .nextInChain = nullptr,
             .label = "My Queue",
@@ -95,11 +152,16 @@ void RdContext::Initialize(WGPUInstance p_instance, RdSurface p_rdSurface, RdDri
         .deviceLostCallback = nullptr,
         .deviceLostUserdata = nullptr,
 #ifdef WEBGPU_BACKEND_WGPU
-        .uncapturedErrorCallbackInfo = {},
+        // Failed pipeline compiles are reported to the thread that ran them, see RdErrorCapture.
+        .uncapturedErrorCallbackInfo = {
+            .nextInChain = nullptr,
+            .callback = RdDriver::OnUncapturedError,
+            .userdata = p_driver,
+        },
 #endif  // WEBGPU_BACKEND_WGPU
     };
 
-#ifndef __EMSCRIPTEN__
+#if !defined(__EMSCRIPTEN__) && !defined(WEBGPU_BACKEND_WGPU)
         deviceDesc.uncapturedErrorCallbackInfo = {};
 #endif	// __EMSCRIPTEN__
 
@@ -116,6 +178,32 @@ void RdContext::Initialize(WGPUInstance p_instance, RdSurface p_rdSurface, RdDri
 	ERR(p_driver->device == nullptr,
 		"Device is null when requested ended, probably browser is not supported");
 
+	WGPUSupportedLimits deviceLimits = {
+		.nextInChain = nullptr,
+		.limits = requiredLimits.limits,
+	};
+	wgpuDeviceGetLimits(p_driver->device, &deviceLimits);
+	limits = deviceLimits.limits;
+
+	// cull.wgsl binds three storage buffers and runs 64 invocations per workgroup.
+	computeCulling = limits.maxStorageBuffersPerShaderStage >= 3
+			&& limits.maxComputeInvocationsPerWorkgroup >= 64
+			&& limits.maxComputeWorkgroupSizeX >= 64;
+	LOG_TRACE("  ~  max buffer size: %llu", static_cast<unsigned long long>(limits.maxBufferSize));
+	LOG_TRACE("  ~  max storage binding: %llu", static_cast<unsigned long long>(limits.maxStorageBufferBindingSize));
+	LOG_TRACE("  ~  max storage buffers per stage: %u", limits.maxStorageBuffersPerShaderStage);
+	WARN_COND(!computeCulling, "Device limits too low for GPU culling, every instance is drawn");
+
+	timestampQueries = wgpuDeviceHasFeature(p_driver->device, WGPUFeatureName_TimestampQuery);
+	LOG_TRACE("  ~  timestamp queries: %s", timestampQueries ? "yes" : "no");
+
+#if defined(WEBGPU_BACKEND_WGPU) && !defined(__EMSCRIPTEN__)
+	// wgpu-native objects are thread safe, Dawn devices only with implicit synchronization, which is not enabled.
+	parallelEncoding = true;
+#else
+	parallelEncoding = false;
+#endif	// WEBGPU_BACKEND_WGPU
+
 	// ~~~~~~~~~ QUEUE ~~~~~~~~~~
 	p_driver->queue = wgpuDeviceGetQueue(p_driver->device);
 	LOG_TRACE("WebGPU queue created");
@@ -124,11 +212,52 @@ void RdContext::Initialize(WGPUInstance p_instance, RdSurface p_rdSurface, RdDri
 }
 
 
+// Storage buffers bound by the widest compute pass, meshlets.wgsl, cull.wgsl binds three.
+static constexpr uint32_t STORAGE_BUFFERS_PER_STAGE = 6;
+
+// @brief Raise only the limits the renderer needs past the defaults, everything else keeps the default so code that
+// would not run on another machine fails here too. Storage bindings and buffers get as large as the adapter allows:
+// instance and meshlet buffers grow with the scene, and culling falls back to the CPU once they exceed the binding
+// size. False when the adapter reported nothing, the device then gets the defaults. Optional paths like the compute
+// culling pre-pass are checked against the limits the device ends up with and turned off rather than failing.
+bool RdContext::LimitsNegotiate(WGPURequiredLimits& p_required) {
+    ZoneScoped;
+	WGPUSupportedLimits supported = {
+		.nextInChain = nullptr,
+		.limits = {},
+	};
+	if (!wgpuAdapterGetLimits(adapter, &supported)) {
+		LOG_WARN("Adapter limits unavailable, requesting the defaults");
+		return false;
+	}
+
+	// Every field is a uint32_t or uint64_t, all bits set is WGPU_LIMIT_U32_UNDEFINED or WGPU_LIMIT_U64_UNDEFINED,
+	// which asks for the default.
+	std::memset(&p_required.limits, 0xff, sizeof(p_required.limits));
+	p_required.limits.maxStorageBufferBindingSize = supported.limits.maxStorageBufferBindingSize;
+	p_required.limits.maxBufferSize = supported.limits.maxBufferSize;
+	p_required.limits.maxStorageBuffersPerShaderStage =
+			std::min(STORAGE_BUFFERS_PER_STAGE, supported.limits.maxStorageBuffersPerShaderStage);
+	return true;
+}
+
 RdContext::RdContext() {
     ZoneScoped;
 	instance = nullptr;
 	adapter = nullptr;
     yieldToBrowser = false;
+	headless = false;
+	offscreenTexture = nullptr;
+	depthTexture = nullptr;
+	depthView = nullptr;
+	frameTextureAllocations = 0;
+	totalTextureAllocations = 0;
+	limits = {};
+	preferredPresentMode = WGPUPresentMode_Fifo;
+	presentMode = WGPUPresentMode_Fifo;
+	computeCulling = false;
+	timestampQueries = false;
+	parallelEncoding = false;
 }
 
 RdContext::~RdContext() {
@@ -145,6 +274,15 @@ RdContext::~RdContext() {
 	// } else {
 	//     LOG_WARN("Surface is null when destroying renderer context");
 	// }
+	if (offscreenTexture) {
+		wgpuTextureRelease(offscreenTexture);
+		LOG_TRACE("Offscreen texture released");
+	}
+	if (depthView) {
+		wgpuTextureViewRelease(depthView);
+		wgpuTextureRelease(depthTexture);
+		LOG_TRACE("Depth texture released");
+	}
 	if (adapter) {
 		wgpuAdapterRelease(adapter);
         LOG_TRACE("Adapter released");
@@ -158,29 +296,217 @@ void RdContext::ConfigureSurface(const int& width, const int& height, const WGPU
     ZoneScoped;
 	ERR(adapter == nullptr, "Adapter is null, possibly context is not initialized");
 
+	if (headless) {
+		rdSurface.width = static_cast<uint32_t>(width);
+		rdSurface.height = static_cast<uint32_t>(height);
+		ConfigureOffscreen(p_device);
+		ConfigureDepth(p_device);
+		return;
+	}
+
 	WGPUSurfaceCapabilities capabilities = {};
 	wgpuSurfaceGetCapabilities(rdSurface.surface, adapter, &capabilities);
+	WGPUPresentMode selectedMode = PresentModeSelect(capabilities, preferredPresentMode);
+	if (selectedMode != presentMode) {
+		LOG_INFO("Present mode %s, %s requested", PresentModeName(selectedMode), PresentModeName(preferredPresentMode));
+	}
+	presentMode = selectedMode;
+
+	WGPUTextureFormat format = SurfaceFormatSelect(capabilities);
+	if (format == WGPUTextureFormat_Undefined) {
+#ifndef __EMSCRIPTEN__
+		wgpuSurfaceCapabilitiesFreeMembers(capabilities);
+#endif	// __EMSCRIPTEN__
+		LOG_ERROR("Surface reports no texture formats, it is left unconfigured");
+		return;
+	}
+
 	WGPUSurfaceConfiguration config = {
 		.nextInChain = nullptr,
 		.device = p_device,
-		.format = rdSurface.format = capabilities.formats[0],
+		.format = rdSurface.format = format,
 		.usage = WGPUTextureUsage_RenderAttachment,
 		.viewFormatCount = 0,
 		.viewFormats = nullptr,
 		.alphaMode = WGPUCompositeAlphaMode_Auto,
 		.width = rdSurface.width = static_cast<uint32_t>(width),
 		.height = rdSurface.height = static_cast<uint32_t>(height),
-		.presentMode = WGPUPresentMode_Fifo,
+		.presentMode = presentMode,
 	};
+#ifndef __EMSCRIPTEN__
+	wgpuSurfaceCapabilitiesFreeMembers(capabilities);
+#endif	// __EMSCRIPTEN__
 
     rdSurface.depthTextureFormat = WGPUTextureFormat_Depth24Plus;
 
 	wgpuSurfaceConfigure(rdSurface.surface, &config);
 	LOG_TRACE("Surface configured");
+
+	ConfigureDepth(p_device);
+}
+
+// @brief p_preferred when the surface offers it, otherwise the closest mode with lower latency before Fifo.
+// Mailbox and Immediate both skip the vsync wait, Mailbox without tearing.
+WGPUPresentMode RdContext::PresentModeSelect(const WGPUSurfaceCapabilities& p_capabilities, WGPUPresentMode p_preferred) {
+	auto supported = [&p_capabilities](WGPUPresentMode mode) {
+		const WGPUPresentMode* end = p_capabilities.presentModes + p_capabilities.presentModeCount;
+		return std::find(p_capabilities.presentModes, end, mode) != end;
+	};
+
+	std::vector<WGPUPresentMode> candidates = { p_preferred };
+	if (p_preferred == WGPUPresentMode_Mailbox) {
+		candidates.push_back(WGPUPresentMode_Immediate);
+	} else if (p_preferred == WGPUPresentMode_Immediate) {
+		candidates.push_back(WGPUPresentMode_Mailbox);
+	}
+	for (WGPUPresentMode mode : candidates) {
+		if (supported(mode)) {
+			return mode;
+		}
+	}
+	return WGPUPresentMode_Fifo;
+}
+
+// @brief First 8 bit RGBA or BGRA format of the surface, the pipelines and ImGui expect one. The preferred format
+// is listed first, so it wins whenever it is one of them. Undefined when the surface reports no format at all.
+WGPUTextureFormat RdContext::SurfaceFormatSelect(const WGPUSurfaceCapabilities& p_capabilities) {
+	if (p_capabilities.formatCount == 0) {
+		return WGPUTextureFormat_Undefined;
+	}
+	for (size_t i = 0; i < p_capabilities.formatCount; ++i) {
+		switch (p_capabilities.formats[i]) {
+			case WGPUTextureFormat_BGRA8Unorm:
+			case WGPUTextureFormat_BGRA8UnormSrgb:
+			case WGPUTextureFormat_RGBA8Unorm:
+			case WGPUTextureFormat_RGBA8UnormSrgb:
+				return p_capabilities.formats[i];
+			default:
+				break;
+		}
+	}
+	return p_capabilities.formats[0];
+}
+
+const char* RdContext::PresentModeName(WGPUPresentMode p_mode) {
+	switch (p_mode) {
+		case WGPUPresentMode_Fifo:
+			return "fifo";
+		case WGPUPresentMode_FifoRelaxed:
+			return "fifo-relaxed";
+		case WGPUPresentMode_Immediate:
+			return "immediate";
+		case WGPUPresentMode_Mailbox:
+			return "mailbox";
+		default:
+			return "unknown";
+	}
+}
+
+// @brief Create the depth attachment, it is kept across frames until the surface size or depth format changes
+void RdContext::ConfigureDepth(const WGPUDevice& p_device) {
+    ZoneScoped;
+	if (depthTexture
+		&& wgpuTextureGetWidth(depthTexture) == rdSurface.width
+		&& wgpuTextureGetHeight(depthTexture) == rdSurface.height
+		&& wgpuTextureGetFormat(depthTexture) == rdSurface.depthTextureFormat) {
+		return;
+	}
+
+	if (depthView) {
+		wgpuTextureViewRelease(depthView);
+		wgpuTextureRelease(depthTexture);
+	}
+
+    WGPUTextureDescriptor depthDescriptor = {
+        .nextInChain = nullptr,
+        .label = "Depth texture",
+        .usage = WGPUTextureUsage_RenderAttachment,
+        .dimension = WGPUTextureDimension_2D,
+        .size = {rdSurface.width, rdSurface.height, 1},
+        .format = rdSurface.depthTextureFormat,
+        .mipLevelCount = 1,
+        .sampleCount = 1,
+        .viewFormatCount = 1,
+        .viewFormats = &rdSurface.depthTextureFormat,
+    };
+    depthTexture = TextureCreate(p_device, depthDescriptor);
+
+    WGPUTextureViewDescriptor viewDescriptor = {
+        .nextInChain = nullptr,
+        .label = "Depth texture view",
+        .format = rdSurface.depthTextureFormat,
+        .dimension = WGPUTextureViewDimension_2D,
+        .baseMipLevel = 0,
+        .mipLevelCount = 1,
+        .baseArrayLayer = 0,
+        .arrayLayerCount = 1,
+        .aspect = WGPUTextureAspect_DepthOnly,
+    };
+    depthView = wgpuTextureCreateView(depthTexture, &viewDescriptor);
+	LOG_TRACE("Depth texture configured: %u x %u", rdSurface.width, rdSurface.height);
+}
+
+WGPUTextureView RdContext::DepthView() const {
+	return depthView;
+}
+
+WGPUTexture RdContext::TextureCreate(const WGPUDevice& p_device, const WGPUTextureDescriptor& p_descriptor) {
+	++frameTextureAllocations;
+	++totalTextureAllocations;
+	return wgpuDeviceCreateTexture(p_device, &p_descriptor);
+}
+
+// @brief Create the offscreen color target that stands in for the swapchain in headless mode, it is kept until the
+// surface size or format changes like the depth attachment
+void RdContext::ConfigureOffscreen(const WGPUDevice& p_device) {
+    ZoneScoped;
+	rdSurface.format = WGPUTextureFormat_RGBA8UnormSrgb;
+    rdSurface.depthTextureFormat = WGPUTextureFormat_Depth24Plus;
+
+	if (offscreenTexture
+		&& wgpuTextureGetWidth(offscreenTexture) == rdSurface.width
+		&& wgpuTextureGetHeight(offscreenTexture) == rdSurface.height
+		&& wgpuTextureGetFormat(offscreenTexture) == rdSurface.format) {
+		return;
+	}
+
+	if (offscreenTexture) {
+		wgpuTextureRelease(offscreenTexture);
+	}
+
+	WGPUTextureDescriptor colorDescriptor = {
+		.nextInChain = nullptr,
+		.label = "Offscreen color texture",
+		.usage = WGPUTextureUsage_RenderAttachment | WGPUTextureUsage_CopySrc,
+		.dimension = WGPUTextureDimension_2D,
+		.size = {rdSurface.width, rdSurface.height, 1},
+		.format = rdSurface.format,
+		.mipLevelCount = 1,
+		.sampleCount = 1,
+		.viewFormatCount = 0,
+		.viewFormats = nullptr,
+	};
+	offscreenTexture = TextureCreate(p_device, colorDescriptor);
+	LOG_TRACE("Offscreen target configured: %u x %u", rdSurface.width, rdSurface.height);
 }
 
 WGPUTextureView RdContext::NextTextureView() {
     ZoneScoped;
+	if (headless) {
+		WGPUTextureViewDescriptor viewDescriptor = {
+			.nextInChain = nullptr,
+			.label = "Offscreen texture view",
+			.format = rdSurface.format,
+			.dimension = WGPUTextureViewDimension_2D,
+			.baseMipLevel = 0,
+			.mipLevelCount = 1,
+			.baseArrayLayer = 0,
+			.arrayLayerCount = 1,
+			.aspect = WGPUTextureAspect_All,
+		};
+		return offscreenTexture ? wgpuTextureCreateView(offscreenTexture, &viewDescriptor) : nullptr;
+	}
+
 	WGPUSurfaceTexture surfaceTexture = {};
 	wgpuSurfaceGetCurrentTexture(rdSurface.surface, &surfaceTexture);
 
@@ -212,13 +538,31 @@ WGPUTextureView RdContext::NextTextureView() {
 }
 
 
-void RdContext::Polltick(const WGPUDevice& p_device) {
+void RdContext::Present() {
+    ZoneScoped;
+	// Present closes the frame in both swapchain and headless mode, so the allocation counters roll over here.
+	TracyPlot("Texture allocations per frame", static_cast<int64_t>(frameTextureAllocations));
+	TracyPlot("Texture allocations total", static_cast<int64_t>(totalTextureAllocations));
+	frameTextureAllocations = 0;
+
+	if (headless) {
+		return;
+	}
+#ifndef __EMSCRIPTEN__
+	wgpuSurfacePresent(rdSurface.surface);
+#endif
+}
+
+// @brief Process pending device callbacks. With p_wait the call blocks until submitted work is done
+// on backends that support it, Dawn only ticks so callers waiting on a callback have to loop.
+void RdContext::Polltick(const WGPUDevice& p_device, bool p_wait) {
     (void)p_device;
+    (void)p_wait;
     ZoneScoped;
     #if defined(WEBGPU_BACKEND_DAWN)
     wgpuDeviceTick(p_device);
 #elif defined(WEBGPU_BACKEND_WGPU)
-    wgpuDevicePoll(p_device, false, nullptr);
+    wgpuDevicePoll(p_device, p_wait, nullptr);
 #elif defined(WEBGPU_BACKEND_EMSCRIPTEN)
     if (yieldToBrowser) {
         emscripten_sleep(100);
@@ -8,9 +8,14 @@ class Window;
 
 struct RdContext {
 	void Initialize(WGPUInstance p_instance, RdSurface p_rdSurface, RdDriver* p_driver);
+	void InitializeHeadless(WGPUInstance p_instance, bool p_forceFallbackAdapter, RdDriver* p_driver);
     void ConfigureSurface(const int& p_width, const int& p_height, const WGPUDevice& p_device);
-    void Polltick(const WGPUDevice& p_device);
+    void Polltick(const WGPUDevice& p_device, bool p_wait = false);
+    void Present();
     WGPUTextureView NextTextureView();
+    WGPUTextureView DepthView() const;
+
+	static const char* PresentModeName(WGPUPresentMode p_mode);
 
 	RdContext();
 	~RdContext();
@@ -22,4 +27,39 @@ struct RdContext {
 	RdSurface rdSurface;
 	WGPUAdapter adapter;
     bool yieldToBrowser;
+
+	// Present mode asked for before configuring the surface, and the one it got. Modes the surface lacks fall back
+	// to the next one with lower latency, Fifo is always available.
+	WGPUPresentMode preferredPresentMode;
+	WGPUPresentMode presentMode;
+
+	// Headless contexts render into an offscreen color target instead of a swapchain.
+	bool headless;
+	WGPUTexture offscreenTexture;
+
+	// Depth attachment shared by every frame, only recreated when the surface size or depth format changes.
+	// Frames still in flight keep a released texture alive until the GPU is done with them.
+	WGPUTexture depthTexture;
+	WGPUTextureView depthView;
+
+	// Limits the device was created with, and whether they allow the compute culling pre-pass.
+	WGPULimits limits;
+	bool computeCulling;
+	// Whether passes can write timestamps, the GPU profiler stays off without.
+	bool timestampQueries;
+	// Whether several threads may encode against the device at once, render bundles are recorded in parallel then.
+	bool parallelEncoding;
+
+	// Texture allocations made since the last Present(), plotted in Tracy to catch per-frame churn.
+	uint32_t frameTextureAllocations;
+	uint64_t totalTextureAllocations;
+
+private:
+	static WGPUPresentMode PresentModeSelect(const WGPUSurfaceCapabilities& p_capabilities, WGPUPresentMode p_preferred);
+	static WGPUTextureFormat SurfaceFormatSelect(const WGPUSurfaceCapabilities& p_capabilities);
+	void DeviceRequest(const WGPURequestAdapterOptions& p_options, RdDriver* p_driver);
+	bool LimitsNegotiate(WGPURequiredLimits& p_required);
+	void ConfigureOffscreen(const WGPUDevice& p_device);
+	void ConfigureDepth(const WGPUDevice& p_device);
+	WGPUTexture TextureCreate(const WGPUDevice& p_device, const WGPUTextureDescriptor& p_descriptor);
 };
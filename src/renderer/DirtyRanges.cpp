@@ -0,0 +1,59 @@
+#include "DirtyRanges.hpp"
+
+#include <tracy/Tracy.hpp>
+
+#include <algorithm>
+
+void RdDirtyRanges::Mark(uint64_t p_offset, uint64_t p_size) {
+	if (p_size == 0) {
+		return;
+	}
+	// Consecutive edits usually touch the same or the next element, extend the last range in place.
+	if (!ranges.empty()) {
+		RdRange& last = ranges.back();
+		if (p_offset >= last.offset && p_offset <= last.offset + last.size) {
+			last.size = std::max(last.size, p_offset + p_size - last.offset);
+			return;
+		}
+	}
+	ranges.push_back({ p_offset, p_size });
+}
+
+void RdDirtyRanges::MarkAll(uint64_t p_size) {
+	ranges.clear();
+	Mark(0, p_size);
+}
+
+void RdDirtyRanges::Clear() {
+	ranges.clear();
+}
+
+bool RdDirtyRanges::Empty() const {
+	return ranges.empty();
+}
+
+const std::vector<RdRange>& RdDirtyRanges::Coalesce(uint64_t p_mergeGap, uint64_t p_limit) {
+	ZoneScoped;
+	for (RdRange& range : ranges) {
+		uint64_t end = std::min((range.offset + range.size + 3) & ~uint64_t(3), p_limit);
+		range.offset &= ~uint64_t(3);
+		range.size = end > range.offset ? end - range.offset : 0;
+	}
+
+	std::sort(ranges.begin(), ranges.end(), [](const RdRange& a, const RdRange& b) { return a.offset < b.offset; });
+
+	size_t merged = 0;
+	for (const RdRange& range : ranges) {
+		if (range.size == 0) {
+			continue;
+		}
+		if (merged > 0 && range.offset <= ranges[merged - 1].offset + ranges[merged - 1].size + p_mergeGap) {
+			RdRange& last = ranges[merged - 1];
+			last.size = std::max(last.offset + last.size, range.offset + range.size) - last.offset;
+		} else {
+			ranges[merged++] = range;
+		}
+	}
+	ranges.resize(merged);
+	return ranges;
+}
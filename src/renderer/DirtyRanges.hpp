@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+struct RdRange {
+	uint64_t offset;
+	uint64_t size;
+};
+
+// Byte ranges of a CPU-side buffer that changed since its last upload.
+// Mutators Mark() what they touch, the upload coalesces the ranges and clears them.
+struct RdDirtyRanges {
+	void Mark(uint64_t p_offset, uint64_t p_size);
+	void MarkAll(uint64_t p_size);
+	void Clear();
+	bool Empty() const;
+
+	// Sort and merge ranges that overlap or are less than p_mergeGap bytes apart, widened to the 4 byte copy
+	// alignment and clamped to p_limit, which has to be a multiple of 4 itself.
+	const std::vector<RdRange>& Coalesce(uint64_t p_mergeGap, uint64_t p_limit);
+
+	std::vector<RdRange> ranges;
+};
@@ -15,30 +15,251 @@
 #include "Driver.hpp"
 #include "logging_macros.h"
 
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
 
-WGPURenderPipeline RdDriver::PipelineCreate(const RdSurface& p_rdSurface, const WGPUPipelineLayout& p_pipelineLayout) {
+
+WGPUIndexFormat IndexFormatToWGPU(RdIndexFormat p_format) {
+	return p_format == RdIndexFormat::Uint32 ? WGPUIndexFormat_Uint32 : WGPUIndexFormat_Uint16;
+}
+
+WGPUVertexFormat PositionFormatToWGPU(RdPositionFormat p_format) {
+	switch (p_format) {
+		case RdPositionFormat::Snorm16x4:
+			return WGPUVertexFormat_Snorm16x4;
+		case RdPositionFormat::Unorm16x4:
+			return WGPUVertexFormat_Unorm16x4;
+		default:
+			return WGPUVertexFormat_Float32x3;
+	}
+}
+
+WGPUVertexFormat ColorFormatToWGPU(RdColorFormat p_format) {
+	return p_format == RdColorFormat::Unorm8x4 ? WGPUVertexFormat_Unorm8x4 : WGPUVertexFormat_Float32x3;
+}
+
+// @brief The pipeline drawing Vertex meshes into p_rdSurface, shared by every caller asking for the same state
+WGPURenderPipeline RdDriver::PipelineCreate(
+		const RdSurface& p_rdSurface,
+		const WGPUPipelineLayout& p_pipelineLayout,
+		const RdVertexFormat& p_vertexFormat
+) {
     ZoneScoped;
-	WGPUShaderModule module = ShaderModuleLoad("triangles.wgsl");
+	return PipelineGet(PipelineDescMesh(p_rdSurface, p_vertexFormat), p_pipelineLayout);
+}
 
-	WGPUVertexAttribute posAttribute = {
-		.format = WGPUVertexFormat_Float32x3,
-		.offset = 0,
-		.shaderLocation = 0,
+// @brief Vertex attributes follow p_vertexFormat, triangles.wgsl reads every format as floats and dequantizes
+// positions with the scale and offset of the uniforms. Meshes are triangle lists, which take their index format
+// from the draw, so the pipeline is the same for 16 and 32-bit indices.
+RdPipelineDesc RdDriver::PipelineDescMesh(const RdSurface& p_rdSurface, const RdVertexFormat& p_vertexFormat) {
+	return {
+		.shader = "triangles.wgsl",
+		.attributes = {
+			{
+				.format = PositionFormatToWGPU(p_vertexFormat.position),
+				.offset = 0,
+				.shaderLocation = 0,
+			},
+			{
+				.format = ColorFormatToWGPU(p_vertexFormat.color),
+				.offset = p_vertexFormat.ColorOffset(),
+				.shaderLocation = 1,
+			},
+		},
+		.vertexStride = p_vertexFormat.Stride(),
+		.instanceAttributes = {
+			{
+				.format = WGPUVertexFormat_Float32x4,
+				.offset = offsetof(Instance, position),
+				.shaderLocation = 2,
+			},
+			{
+				.format = WGPUVertexFormat_Float32x4,
+				.offset = offsetof(Instance, rotation),
+				.shaderLocation = 3,
+			},
+			{
+				.format = WGPUVertexFormat_Float32x4,
+				.offset = offsetof(Instance, color),
+				.shaderLocation = 4,
+			},
+		},
+		.instanceStride = sizeof(Instance),
+		.topology = WGPUPrimitiveTopology_TriangleList,
+		.stripIndexFormat = WGPUIndexFormat_Undefined,
+		.cullMode = WGPUCullMode_None,
+		.colorFormat = p_rdSurface.format,
+		.blend = true,
+		.depthFormat = p_rdSurface.depthTextureFormat,
+		.depthWrite = true,
+		.depthCompare = WGPUCompareFunction_Less,
 	};
+}
 
-	WGPUVertexAttribute colorAttribute = {
-		.format = WGPUVertexFormat_Float32x3,
-		.offset = 3 * sizeof(float),
-		.shaderLocation = 1,
-	};
+// @brief Return the cached pipeline for p_desc, compiling it on the first request.
+// The shader source is part of the key, so an edited shader gets a pipeline of its own.
+WGPURenderPipeline RdDriver::PipelineGet(const RdPipelineDesc& p_desc, const WGPUPipelineLayout& p_pipelineLayout) {
+    ZoneScoped;
+	const RdPipelineCache::Source& shader = ShaderSourceGet(p_desc.shader);
+	const std::string& source = shader.text;
+	uint64_t sourceHash = shader.hash;
+	uint64_t hash = RdPipelineCache::DescHash(p_desc, sourceHash, p_pipelineLayout);
+
+	auto cached = pipelineCache.pipelines.find(hash);
+	if (cached != pipelineCache.pipelines.end()) {
+		pipelineCache.hits++;
+		pipelineCache.StatsPlot();
+		return cached->second;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	WGPUShaderModule module = ShaderModuleGet(p_desc.shader, source, sourceHash);
+	WGPURenderPipeline pipeline = PipelineCompile(p_desc, module, p_pipelineLayout);
+	double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	pipelineCache.misses++;
+	pipelineCache.compileMs += elapsedMs;
+	pipelineCache.pipelines.emplace(hash, pipeline);
+	pipelineCache.StatsPlot();
+	LOG_INFO("Pipeline compiled in %.2f ms: %s", elapsedMs, p_desc.shader.c_str());
+	return pipeline;
+}
+
+// @brief Start compiling p_desc in the background and return the handle PipelineReady() takes, 0 on failure.
+// Cached and already compiling descriptions are not compiled again.
+uint64_t RdDriver::PipelineRequest(const RdPipelineDesc& p_desc, const WGPUPipelineLayout& p_pipelineLayout) {
+    ZoneScoped;
+	const RdPipelineCache::Source* shader = nullptr;
+	try {
+		shader = &ShaderSourceGet(p_desc.shader);
+	} catch (const std::exception& e) {
+		LOG_ERROR("%s", e.what());
+		return 0;
+	}
+	const std::string& source = shader->text;
+	uint64_t sourceHash = shader->hash;
+	uint64_t hash = RdPipelineCache::DescHash(p_desc, sourceHash, p_pipelineLayout);
+
+	if (pipelineCache.pipelines.contains(hash)) {
+		pipelineCache.hits++;
+		return hash;
+	}
+	if (!pipelineCache.pending.insert(hash).second) {
+		return hash;
+	}
+
+	RdPipelineCache::Request request = { &pipelineCache, hash, std::chrono::steady_clock::now() };
+#ifdef WEBGPU_BACKEND_WGPU
+	// wgpu-native does not implement wgpuDeviceCreateRenderPipelineAsync, its device is thread safe though, so the
+	// pipeline is compiled on a worker instead. Error scopes are one stack per device and would catch the errors of
+	// whichever thread fails while they are open, the failures are captured per thread instead, see OnUncapturedError.
+	RdErrorCapture capture(p_desc.shader.c_str());
+	WGPUShaderModule module = ShaderModuleGet(p_desc.shader, source, sourceHash);
+	if (capture.Failed()) {
+		wgpuShaderModuleRelease(module);
+		pipelineCache.shaderModules.erase(sourceHash);
+		pipelineCache.pending.erase(hash);
+		pipelineCache.failures++;
+		return 0;
+	}
+
+	pipelineCache.workers.emplace(hash, std::thread([this, desc = p_desc, module, p_pipelineLayout, request]() {
+		RdErrorCapture capture(desc.shader.c_str());
+		WGPURenderPipeline pipeline = PipelineCompile(desc, module, p_pipelineLayout);
+		if (capture.Failed()) {
+			wgpuRenderPipelineRelease(pipeline);
+			pipeline = nullptr;
+		}
+		pipelineCache.Complete(request, pipeline);
+	}));
+#else
+	WGPUShaderModule module = ShaderModuleGet(p_desc.shader, source, sourceHash);
+	PipelineCompile(p_desc, module, p_pipelineLayout, new RdPipelineCache::Request(request));
+#endif	// WEBGPU_BACKEND_WGPU
+	pipelineCache.StatsPlot();
+	return hash;
+}
+
+// @brief False while p_request is compiling. Once it finished p_pipeline is set, nullptr if compilation failed.
+// Finished compiles are collected here, the callbacks themselves fire while the device is ticked.
+bool RdDriver::PipelineReady(uint64_t p_request, WGPURenderPipeline& p_pipeline) {
+    ZoneScoped;
+	pipelineCache.Collect();
+	if (pipelineCache.pending.contains(p_request)) {
+		return false;
+	}
+	auto cached = pipelineCache.pipelines.find(p_request);
+	p_pipeline = cached != pipelineCache.pipelines.end() ? cached->second : nullptr;
+	return true;
+}
+
+#ifdef WEBGPU_BACKEND_WGPU
+// The capture set on the calling thread, nullptr while none is.
+static thread_local RdErrorCapture* t_errorCapture = nullptr;
+
+RdErrorCapture::RdErrorCapture(const char* p_what) : what(p_what), failed(false), previous(t_errorCapture) {
+	t_errorCapture = this;
+}
+
+RdErrorCapture::~RdErrorCapture() {
+	t_errorCapture = previous;
+}
+
+// @brief wgpu-native reports every error outside of an error scope here, before the failing call returns and on the
+// thread that made it. Errors of captured calls are recorded in their capture, any other error is fatal.
+void RdDriver::OnUncapturedError(WGPUErrorType p_type, const char* p_message, void* p_userdata) {
+	(void)p_userdata;
+	const char* message = p_message ? p_message : "unknown error";
+	if (t_errorCapture != nullptr) {
+		LOG_ERROR("%s: %s", t_errorCapture->what, message);
+		t_errorCapture->failed = true;
+		return;
+	}
+	LOG_ERROR("Uncaptured WebGPU error %d: %s", static_cast<int>(p_type), message);
+	RdLogFlush();
+	std::abort();
+}
+#endif	// WEBGPU_BACKEND_WGPU
 
-	std::vector<WGPUVertexAttribute> attributes = { posAttribute, colorAttribute };
+// @brief Shader files rewritten since the last call, their sources are read again by the next request
+std::vector<std::string> RdDriver::ShadersChanged() {
+    ZoneScoped;
+	std::vector<std::string> changed = shaderWatcher.Changed();
+	for (const std::string& name : changed) {
+		pipelineCache.sources.erase(name);
+	}
+	return changed;
+}
 
-	WGPUVertexBufferLayout vertexBufferLayout = {
-		.arrayStride = 6 * sizeof(float),
-		.stepMode = WGPUVertexStepMode_Vertex,
-		.attributeCount = 2,
-		.attributes = attributes.data(),
+// @brief Watch RESOURCE_DIR so edited shaders can be recompiled while running
+bool RdDriver::ShaderWatchStart(std::function<void()> p_notify) {
+    ZoneScoped;
+	return shaderWatcher.Start(RESOURCE_DIR, ".wgsl", std::move(p_notify));
+}
+
+WGPURenderPipeline RdDriver::PipelineCompile(
+		const RdPipelineDesc& p_desc,
+		const WGPUShaderModule& p_module,
+		const WGPUPipelineLayout& p_pipelineLayout,
+		RdPipelineCache::Request* p_async
+) {
+    ZoneScoped;
+	WGPUVertexBufferLayout vertexBufferLayouts[] = {
+		{
+			.arrayStride = p_desc.vertexStride,
+			.stepMode = WGPUVertexStepMode_Vertex,
+			.attributeCount = p_desc.attributes.size(),
+			.attributes = p_desc.attributes.data(),
+		},
+		{
+			.arrayStride = p_desc.instanceStride,
+			.stepMode = WGPUVertexStepMode_Instance,
+			.attributeCount = p_desc.instanceAttributes.size(),
+			.attributes = p_desc.instanceAttributes.data(),
+		},
 	};
 
 	WGPUBlendState blendState = {
@@ -56,14 +277,14 @@ WGPURenderPipeline RdDriver::PipelineCreate(const RdSurface& p_rdSurface, const
 
 	WGPUColorTargetState colorTargetState = {
 		.nextInChain = nullptr,
-		.format = p_rdSurface.format,
-		.blend = &blendState,
+		.format = p_desc.colorFormat,
+		.blend = p_desc.blend ? &blendState : nullptr,
 		.writeMask = WGPUColorWriteMask_All,
 	};
 
 	WGPUFragmentState fragmentState = {
 		.nextInChain = nullptr,
-		.module = module,
+		.module = p_module,
 		.entryPoint = "fs_main",
 		.constantCount = 0,
 		.constants = nullptr,
@@ -73,9 +294,9 @@ WGPURenderPipeline RdDriver::PipelineCreate(const RdSurface& p_rdSurface, const
 
     WGPUDepthStencilState depthStencilState = {
         .nextInChain = nullptr,
-        .format = p_rdSurface.depthTextureFormat,
-        .depthWriteEnabled = true,
-        .depthCompare = WGPUCompareFunction_Less,
+        .format = p_desc.depthFormat,
+        .depthWriteEnabled = p_desc.depthWrite,
+        .depthCompare = p_desc.depthCompare,
         .stencilFront = {
             .compare = WGPUCompareFunction_Always,
             .failOp = WGPUStencilOperation_Keep,
@@ -101,19 +322,19 @@ WGPURenderPipeline RdDriver::PipelineCreate(const RdSurface& p_rdSurface, const
         .layout = p_pipelineLayout,
         .vertex = {
             .nextInChain = nullptr,
-            .module = module,
+            .module = p_module,
             .entryPoint = "vs_main",
             .constantCount = 0,
             .constants = nullptr,
-            .bufferCount = 1,
-            .buffers = &vertexBufferLayout,
+            .bufferCount = p_desc.instanceStride > 0 ? 2u : 1u,
+            .buffers = vertexBufferLayouts,
         },
         .primitive = {
             .nextInChain = nullptr,
-            .topology = WGPUPrimitiveTopology_TriangleList,
-            .stripIndexFormat = WGPUIndexFormat_Undefined,
+            .topology = p_desc.topology,
+            .stripIndexFormat = p_desc.stripIndexFormat,
             .frontFace = WGPUFrontFace_CCW,
-            .cullMode = WGPUCullMode_None,
+            .cullMode = p_desc.cullMode,
         },
         .depthStencil = &depthStencilState,
         .multisample = {
@@ -125,19 +346,21 @@ WGPURenderPipeline RdDriver::PipelineCreate(const RdSurface& p_rdSurface, const
         .fragment = &fragmentState,  
     };
 
-	LOG_INFO("Pipeline created");
-
+    if (p_async != nullptr) {
+        wgpuDeviceCreateRenderPipelineAsync(device, &pipelineDesc, RdPipelineCache::OnPipelineCreated, p_async);
+        return nullptr;
+    }
     return wgpuDeviceCreateRenderPipeline(device, &pipelineDesc);
 }
 
 
-WGPUBindGroup RdDriver::BindGroupCreate(const WGPUBindGroupLayout& p_layout, const WGPUBuffer& p_buffer) {
+WGPUBindGroup RdDriver::BindGroupCreate(const WGPUBindGroupLayout& p_layout, const WGPUBuffer& p_buffer, uint64_t p_size) {
 	WGPUBindGroupEntry bindGroupEntry = {
 		.nextInChain = nullptr,
 		.binding = 0,
 		.buffer = p_buffer,
 		.offset = 0,
-		.size = 4 * sizeof(float),
+		.size = p_size,
 		.sampler = nullptr,
 		.textureView = nullptr,
 	};
@@ -153,7 +376,23 @@ WGPUBindGroup RdDriver::BindGroupCreate(const WGPUBindGroupLayout& p_layout, con
     return wgpuDeviceCreateBindGroup(device, &bindGroupDesc);
 }
 
-WGPUBindGroupLayout RdDriver::BindGroupLayoutCreate() {
+// @brief Encoder for a bundle executed in the main render pass, it has to match the pass attachments
+WGPURenderBundleEncoder RdDriver::BundleEncoderCreate(const RdSurface& p_rdSurface, const char* p_label) {
+	ZoneScoped;
+	WGPURenderBundleEncoderDescriptor encoderDesc = {
+		.nextInChain = nullptr,
+		.label = p_label,
+		.colorFormatCount = 1,
+		.colorFormats = &p_rdSurface.format,
+		.depthStencilFormat = p_rdSurface.depthTextureFormat,
+		.sampleCount = 1,
+		.depthReadOnly = false,
+		.stencilReadOnly = true,
+	};
+	return wgpuDeviceCreateRenderBundleEncoder(device, &encoderDesc);
+}
+
+WGPUBindGroupLayout RdDriver::BindGroupLayoutCreate(uint64_t p_uniformSize) {
 	WGPUBindGroupLayoutEntry bindGroupLayoutEntry = {
         .nextInChain = nullptr,
         .binding = 0,
@@ -163,7 +402,7 @@ WGPUBindGroupLayout RdDriver::BindGroupLayoutCreate() {
             .type = WGPUBufferBindingType_Uniform,
 
             .hasDynamicOffset = false,
-            .minBindingSize = 4 * sizeof(float),
+            .minBindingSize = p_uniformSize,
         },
         .sampler = {
             .nextInChain = nullptr,
@@ -193,7 +432,7 @@ WGPUBindGroupLayout RdDriver::BindGroupLayoutCreate() {
     return wgpuDeviceCreateBindGroupLayout(device, &bindGroupLayoutDesc);
 }
 
-WGPUShaderModule RdDriver::ShaderModuleLoad(const std::filesystem::path& filename) {
+std::string RdDriver::ShaderSourceLoad(const std::filesystem::path& filename) {
     ZoneScoped;
     std::ifstream file(std::string(RESOURCE_DIR) / filename, std::ios::binary);
     if (!file) {
@@ -202,19 +441,47 @@ WGPUShaderModule RdDriver::ShaderModuleLoad(const std::filesystem::path& filenam
     LOG_TRACE("Shader file opened: %s", filename.c_str());
     std::ostringstream contents;
     contents << file.rdbuf();
-    std::string source = contents.str();
+    return contents.str();
+}
+
+WGPUShaderModule RdDriver::ShaderModuleLoad(const std::filesystem::path& filename) {
+    ZoneScoped;
+    const RdPipelineCache::Source& source = ShaderSourceGet(filename.string());
+    return ShaderModuleGet(filename.string(), source.text, source.hash);
+}
+
+// @brief The source of p_shader and its hash, read from disk on the first call and again only after
+// ShadersChanged() reported the file, so cache hits never touch the disk
+const RdPipelineCache::Source& RdDriver::ShaderSourceGet(const std::string& p_shader) {
+    ZoneScoped;
+    auto cached = pipelineCache.sources.find(p_shader);
+    if (cached != pipelineCache.sources.end()) {
+        return cached->second;
+    }
+    std::string text = ShaderSourceLoad(p_shader);
+    uint64_t hash = RdPipelineCache::Hash(text.data(), text.size());
+    return pipelineCache.sources.emplace(p_shader, RdPipelineCache::Source{ std::move(text), hash }).first->second;
+}
+
+// @brief Modules are keyed by their source alone, the cache owns them
+WGPUShaderModule RdDriver::ShaderModuleGet(const std::string& p_label, const std::string& p_source, uint64_t p_sourceHash) {
+    ZoneScoped;
+    auto cached = pipelineCache.shaderModules.find(p_sourceHash);
+    if (cached != pipelineCache.shaderModules.end()) {
+        return cached->second;
+    }
 
     WGPUShaderModuleWGSLDescriptor shaderDesc = {
         .chain = {
             .next = nullptr,
             .sType = WGPUSType_ShaderModuleWGSLDescriptor,
         },
-        .code = source.c_str(),
+        .code = p_source.c_str(),
     };
 
     WGPUShaderModuleDescriptor moduleDesc = {
         .nextInChain = reinterpret_cast<WGPUChainedStruct*>(&shaderDesc),
-        .label = filename.c_str(),
+        .label = p_label.c_str(),
 #ifdef WEBGPU_BACKEND_WGPU
         .hintCount = 0,
         .hints = nullptr,
@@ -222,108 +489,65 @@ WGPUShaderModule RdDriver::ShaderModuleLoad(const std::filesystem::path& filenam
     };
 
     WGPUShaderModule module = wgpuDeviceCreateShaderModule(device, &moduleDesc);
-    LOG_INFO("Shader module loaded: %s", filename.c_str());
+    pipelineCache.shaderModules.emplace(p_sourceHash, module);
+    LOG_INFO("Shader module loaded: %s", p_label.c_str());
 
     return module;
 }
 
-bool RdDriver::GeometryLoad(
-		const std::filesystem::path& path,
-		std::vector<Vertex>& vertices,
-		std::vector<uint16_t>& indices
-) {
-	ZoneScoped;
-	std::ifstream file(std::string(RESOURCE_DIR) / path);
-	if (!file.is_open()) {
-		return false;
-	}
-
-	vertices.clear();
-	indices.clear();
-
-	enum class Section {
-		None,
-		Points,
-		Indices,
+// @brief Create a buffer already holding p_data, the data is copied once into memory mapped at creation
+WGPUBuffer RdDriver::BufferCreate(WGPUBufferUsageFlags p_usage, const void* p_data, uint64_t p_size, const char* p_label) {
+    ZoneScoped;
+	WGPUBufferDescriptor bufferDesc = {
+		.nextInChain = nullptr,
+		.label = p_label,
+		.usage = p_usage,
+		.size = (p_size + 3) & ~uint64_t(3),
+		.mappedAtCreation = true,
 	};
-	Section currentSection = Section::None;
-
-	float value;
-	uint16_t index;
-	std::string line;
-	while (!file.eof()) {
-		getline(file, line);
+	WGPUBuffer buffer = wgpuDeviceCreateBuffer(device, &bufferDesc);
 
-		// overcome the `CRLF` problem
-		if (!line.empty() && line.back() == '\r') {
-			line.pop_back();
-		}
+	void* mapped = wgpuBufferGetMappedRange(buffer, 0, bufferDesc.size);
+	std::memcpy(mapped, p_data, p_size);
+	wgpuBufferUnmap(buffer);
 
-		if (line == "[points]") {
-			currentSection = Section::Points;
-		} else if (line == "[indices]") {
-			currentSection = Section::Indices;
-		} else if (line[0] == '#' || line.empty()) {
-			// Do nothing, this is a comment
-		} else if (currentSection == Section::Points) {
-			std::istringstream iss(line);
-			// Get x, y, z, r, g, b
-            Vertex vertex;
-			for (int i = 0; i < 6; ++i) {
-                iss >> value;
-                if (i == 0) { vertex.position.x = value; }
-                if (i == 1) { vertex.position.y = value; }
-                if (i == 2) { vertex.position.z = value; }
-                if (i == 3) { vertex.color.r = value; }
-                if (i == 4) { vertex.color.g = value; }
-                if (i == 5) { vertex.color.b = value; }
-			}
-            vertices.push_back(vertex);
-
-		} else if (currentSection == Section::Indices) {
-			std::istringstream iss(line);
-			// Get corners #0 #1 and #2
-			for (int i = 0; i < 3; ++i) {
-				iss >> index;
-				indices.push_back(index);
-			}
-		}
-	}
-    LOG_INFO("Geometry loaded: %s", path.c_str());
-	return true;
+	return buffer;
 }
 
-WGPUTextureView RdDriver::NextDepthView(const RdSurface& rdSurface) {
+// @brief Stage the coalesced dirty ranges of p_data for p_buffer and clear them, returns the bytes staged.
+// The copies are recorded by the next staging.Flush(), nothing is staged when nothing changed.
+uint64_t RdDriver::BufferUploadDirty(
+		const WGPUBuffer& p_buffer,
+		const void* p_data,
+		uint64_t p_size,
+		RdDirtyRanges& p_dirty
+) {
     ZoneScoped;
+	if (p_dirty.Empty()) {
+		return 0;
+	}
 
-    WGPUTextureDescriptor depthDescriptor = {
-        .nextInChain = nullptr,
-        .label = "Depth texture",
-        .usage = WGPUTextureUsage_RenderAttachment,
-        .dimension = WGPUTextureDimension_2D,
-        .size = {rdSurface.width, rdSurface.height, 1},
-        .format = rdSurface.depthTextureFormat,
-        .mipLevelCount = 1,
-        .sampleCount = 1,
-        .viewFormatCount = 1,
-        .viewFormats = &rdSurface.depthTextureFormat,
-    };
-    WGPUTexture depthTexture = wgpuDeviceCreateTexture(device, &depthDescriptor);
+	// Ranges closer than this are cheaper to send as one write than as two.
+	constexpr uint64_t MERGE_GAP = 256;
 
-    WGPUTextureViewDescriptor viewDescriptor = {
-        .nextInChain = nullptr,
-        .label = "Depth texture view",
-        .format = rdSurface.depthTextureFormat,
-        .dimension = WGPUTextureViewDimension_2D,
-        .baseMipLevel = 0,
-        .mipLevelCount = 1,
-        .baseArrayLayer = 0,
-        .arrayLayerCount = 1,
-        .aspect = WGPUTextureAspect_DepthOnly,
-    };
-    WGPUTextureView depthView = wgpuTextureCreateView(depthTexture, &viewDescriptor);
+	uint64_t uploaded = 0;
+	for (const RdRange& range : p_dirty.Coalesce(MERGE_GAP, p_size)) {
+		staging.Upload(p_buffer, range.offset, static_cast<const std::byte*>(p_data) + range.offset, range.size);
+		uploaded += range.size;
+	}
+	p_dirty.Clear();
+	return uploaded;
+}
 
-	wgpuTextureRelease(depthTexture);
+// @brief Where filename lives in the resource directory, for loaders that open files on their own
+std::filesystem::path RdDriver::ResourcePath(const std::filesystem::path& filename) const {
+	return std::string(RESOURCE_DIR) / filename;
+}
 
-    return depthView;
+void RdDriver::Terminate() {
+	ZoneScoped;
+	shaderWatcher.Stop();
+	staging.Terminate();
+	profiler.Terminate();
+	pipelineCache.Release();
 }
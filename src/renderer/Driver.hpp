@@ -1,24 +1,88 @@
 #pragma once
 
+#include "DirtyRanges.hpp"
+#include "FramePacer.hpp"
+#include "GpuProfiler.hpp"
+#include "PipelineCache.hpp"
+#include "StagingRing.hpp"
 #include "Surface.hpp"
 #include "Vertex.hpp"
+#include "../asset/FileWatcher.hpp"
+#include "../asset/MeshFile.hpp"
+#include "../asset/VertexFormat.hpp"
 #include <webgpu/webgpu.h>
 #include <filesystem>
+#include <functional>
+#include <string>
 #include <vector>
 
+WGPUIndexFormat IndexFormatToWGPU(RdIndexFormat p_format);
+WGPUVertexFormat PositionFormatToWGPU(RdPositionFormat p_format);
+WGPUVertexFormat ColorFormatToWGPU(RdColorFormat p_format);
+
+#ifdef WEBGPU_BACKEND_WGPU
+// @brief Record the errors of the WebGPU calls made on this thread while it lives, instead of aborting on them.
+// Unlike error scopes, which are shared by every thread using the device, a capture only sees its own thread.
+struct RdErrorCapture {
+	explicit RdErrorCapture(const char* p_what);
+	~RdErrorCapture();
+	RdErrorCapture(const RdErrorCapture&) = delete;
+	RdErrorCapture& operator=(const RdErrorCapture&) = delete;
+
+	bool Failed() const { return failed; }
+
+	const char* what;
+	bool failed;
+	RdErrorCapture* previous;
+};
+#endif	// WEBGPU_BACKEND_WGPU
+
 struct RdDriver {
-    WGPURenderPipeline PipelineCreate(const RdSurface& p_rdSurface, const WGPUPipelineLayout& p_pipelineLayout);
-    WGPUBindGroupLayout BindGroupLayoutCreate();
-    WGPUBindGroup BindGroupCreate(const WGPUBindGroupLayout& p_layout, const WGPUBuffer& p_buffer);
-    WGPUTextureView NextDepthView(const RdSurface& rdSurface);
+    WGPURenderPipeline PipelineCreate(
+			const RdSurface& p_rdSurface,
+			const WGPUPipelineLayout& p_pipelineLayout,
+			const RdVertexFormat& p_vertexFormat
+	);
+    RdPipelineDesc PipelineDescMesh(const RdSurface& p_rdSurface, const RdVertexFormat& p_vertexFormat);
+    WGPURenderPipeline PipelineGet(const RdPipelineDesc& p_desc, const WGPUPipelineLayout& p_pipelineLayout);
+    uint64_t PipelineRequest(const RdPipelineDesc& p_desc, const WGPUPipelineLayout& p_pipelineLayout);
+    bool PipelineReady(uint64_t p_request, WGPURenderPipeline& p_pipeline);
+    bool ShaderWatchStart(std::function<void()> p_notify = nullptr);
+    std::vector<std::string> ShadersChanged();
+    WGPUBindGroupLayout BindGroupLayoutCreate(uint64_t p_uniformSize);
+    WGPUBindGroup BindGroupCreate(const WGPUBindGroupLayout& p_layout, const WGPUBuffer& p_buffer, uint64_t p_size);
+    WGPURenderBundleEncoder BundleEncoderCreate(const RdSurface& p_rdSurface, const char* p_label);
     WGPUShaderModule ShaderModuleLoad(const std::filesystem::path& filename);
-	bool GeometryLoad(
-			const std::filesystem::path& filename,
-			std::vector<Vertex>& vertices,
-			std::vector<uint16_t>& indices
+    std::string ShaderSourceLoad(const std::filesystem::path& filename);
+    const RdPipelineCache::Source& ShaderSourceGet(const std::string& p_shader);
+    WGPUBuffer BufferCreate(WGPUBufferUsageFlags p_usage, const void* p_data, uint64_t p_size, const char* p_label);
+    uint64_t BufferUploadDirty(
+			const WGPUBuffer& p_buffer,
+			const void* p_data,
+			uint64_t p_size,
+			RdDirtyRanges& p_dirty
 	);
+	std::filesystem::path ResourcePath(const std::filesystem::path& filename) const;
+	void Terminate();
+#ifdef WEBGPU_BACKEND_WGPU
+	static void OnUncapturedError(WGPUErrorType p_type, const char* p_message, void* p_userdata);
+#endif	// WEBGPU_BACKEND_WGPU
 
 	WGPUDevice device;
 	WGPUQueue queue;
+	RdStagingRing staging;
+	RdGpuProfiler profiler;
+	RdFramePacer pacer;
+	RdPipelineCache pipelineCache;
+	RdFileWatcher shaderWatcher;
+
+private:
+	WGPUShaderModule ShaderModuleGet(const std::string& p_label, const std::string& p_source, uint64_t p_sourceHash);
+	WGPURenderPipeline PipelineCompile(
+			const RdPipelineDesc& p_desc,
+			const WGPUShaderModule& p_module,
+			const WGPUPipelineLayout& p_pipelineLayout,
+			RdPipelineCache::Request* p_async = nullptr
+	);
 };
 
@@ -0,0 +1,118 @@
+#include "FramePacer.hpp"
+
+#ifdef WEBGPU_BACKEND_WGPU
+#include <webgpu/wgpu.h>
+#endif	// WEBGPU_BACKEND_WGPU
+
+#include "logging_macros.h"
+#include "tracy/Tracy.hpp"
+
+#include <thread>
+
+static double ElapsedMs(std::chrono::steady_clock::time_point p_from, std::chrono::steady_clock::time_point p_to) {
+	return std::chrono::duration<double, std::milli>(p_to - p_from).count();
+}
+
+void RdFramePacer::Initialize(const WGPUDevice& p_device, const WGPUQueue& p_queue, uint32_t p_maxFramesInFlight) {
+	ZoneScoped;
+	m_device = p_device;
+	m_queue = p_queue;
+	maxFramesInFlight = p_maxFramesInFlight;
+	if (maxFramesInFlight == UNLIMITED) {
+		LOG_INFO("Frame pacing: frames in flight unlimited");
+	} else {
+		LOG_INFO("Frame pacing: at most %u frames in flight", maxFramesInFlight);
+	}
+}
+
+// @brief Whether submitted frames are not reported done yet, their userdata has to outlive the callbacks
+bool RdFramePacer::Busy() {
+	Retire();
+	return !m_frames.empty();
+}
+
+void RdFramePacer::FrameWait() {
+	ZoneScoped;
+	Retire();
+#ifndef __EMSCRIPTEN__
+	if (maxFramesInFlight == UNLIMITED || m_frames.size() < maxFramesInFlight) {
+		return;
+	}
+
+	[[maybe_unused]] Clock::time_point start = Clock::now();
+	while (m_frames.size() >= maxFramesInFlight) {
+#if defined(WEBGPU_BACKEND_WGPU)
+		// Blocks until the oldest frame is done without waiting on the ones queued after it.
+		WGPUWrappedSubmissionIndex oldest = {
+			.queue = m_queue,
+			.submissionIndex = m_frames.front()->submissionIndex,
+		};
+		wgpuDevicePoll(m_device, true, &oldest);
+#elif defined(WEBGPU_BACKEND_DAWN)
+		// Ticking is the only way to get callbacks out of Dawn here, sleeping in between keeps the core free.
+		wgpuDeviceTick(m_device);
+		std::this_thread::sleep_for(std::chrono::microseconds(200));
+#endif
+		Retire();
+	}
+	TracyPlot("Frame pacing wait ms", ElapsedMs(start, Clock::now()));
+#endif	// __EMSCRIPTEN__
+}
+
+void RdFramePacer::InputReceived() {
+	if (!m_hasInput) {
+		m_hasInput = true;
+		m_input = Clock::now();
+	}
+}
+
+void RdFramePacer::Submit(const WGPUCommandBuffer& p_commandBuffer) {
+	ZoneScoped;
+	Frame* frame = m_frames.emplace_back(std::make_unique<Frame>(Frame{
+		.submissionIndex = 0,
+		.hasInput = m_hasInput,
+		.input = m_input,
+		.done = {},
+		.finished = false,
+	})).get();
+	m_hasInput = false;
+
+#ifdef WEBGPU_BACKEND_WGPU
+	frame->submissionIndex = wgpuQueueSubmitForIndex(m_queue, 1, &p_commandBuffer);
+#else
+	wgpuQueueSubmit(m_queue, 1, &p_commandBuffer);
+#endif	// WEBGPU_BACKEND_WGPU
+	wgpuQueueOnSubmittedWorkDone(m_queue, OnFrameWorkDone, frame);
+	TracyPlot("Frames in flight", static_cast<int64_t>(m_frames.size()));
+}
+
+void RdFramePacer::Presented() {
+	if (m_frames.empty() || !m_frames.back()->hasInput) {
+		return;
+	}
+	inputToPresentMs = ElapsedMs(m_frames.back()->input, Clock::now());
+	TracyPlot("Input to present ms", inputToPresentMs);
+}
+
+uint32_t RdFramePacer::FramesInFlight() const {
+	return static_cast<uint32_t>(m_frames.size());
+}
+
+// @brief Drop the frames the GPU finished, they complete in submission order
+void RdFramePacer::Retire() {
+	while (!m_frames.empty() && m_frames.front()->finished) {
+		const Frame& frame = *m_frames.front();
+		if (frame.hasInput) {
+			inputToDoneMs = ElapsedMs(frame.input, frame.done);
+			TracyPlot("Input to GPU done ms", inputToDoneMs);
+		}
+		m_frames.pop_front();
+	}
+}
+
+void RdFramePacer::OnFrameWorkDone(WGPUQueueWorkDoneStatus p_status, void* p_userdata) {
+	(void)p_status;
+	Frame& frame = *reinterpret_cast<Frame*>(p_userdata);
+	frame.done = std::chrono::steady_clock::now();
+	frame.finished = true;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <webgpu/webgpu.h>
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+
+// @brief Keeps the CPU at most maxFramesInFlight frames ahead of the GPU and measures input to present latency.
+// Frames are counted from submission until wgpuQueueOnSubmittedWorkDone reports them done. FrameWait() blocks before
+// the next frame samples its input, so queued frames never add their GPU time to the latency of new input.
+// In the browser the page is paced by requestAnimationFrame and FrameWait() never blocks.
+struct RdFramePacer {
+	// No limit, the CPU queues as many frames as the backend accepts.
+	static constexpr uint32_t UNLIMITED = 0;
+
+	void Initialize(const WGPUDevice& p_device, const WGPUQueue& p_queue, uint32_t p_maxFramesInFlight);
+	bool Busy();
+
+	// @brief Block until fewer than maxFramesInFlight frames are queued
+	void FrameWait();
+	// @brief Note that input arrived for the frame being built, its first event is where latency starts
+	void InputReceived();
+	void Submit(const WGPUCommandBuffer& p_commandBuffer);
+	// @brief Call once the surface presented the frame submitted last
+	void Presented();
+
+	uint32_t FramesInFlight() const;
+
+	uint32_t maxFramesInFlight = 2;
+	// Latencies of the last frame that carried input, from its first event to the present call and to the GPU
+	// finishing it. What the compositor and display add on top is out of reach of WebGPU.
+	double inputToPresentMs = 0.0;
+	double inputToDoneMs = 0.0;
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	struct Frame {
+		uint64_t submissionIndex;
+		bool hasInput;
+		Clock::time_point input;
+		Clock::time_point done;
+		bool finished;
+	};
+
+	void Retire();
+	static void OnFrameWorkDone(WGPUQueueWorkDoneStatus p_status, void* p_userdata);
+
+	WGPUDevice m_device = nullptr;
+	WGPUQueue m_queue = nullptr;
+	std::deque<std::unique_ptr<Frame>> m_frames;
+	bool m_hasInput = false;
+	Clock::time_point m_input;
+};
@@ -0,0 +1,230 @@
+#include "GpuCulling.hpp"
+
+#include "Driver.hpp"
+#include "logging_macros.h"
+#include "tracy/Tracy.hpp"
+
+#include <cstddef>
+#include <vector>
+
+// Matches @workgroup_size in cull.wgsl.
+static constexpr uint32_t WORKGROUP_SIZE = 64;
+// Size of DrawIndexedIndirect in cull.wgsl.
+static constexpr uint64_t INDIRECT_SIZE = 5 * sizeof(uint32_t);
+
+// Mirrors CullParams in cull.wgsl.
+struct CullParams {
+	uint32_t instanceCount;
+	float radius;
+	float ratio;
+	uint32_t lodCount;
+	float lodScale;
+	float padding[3];
+	float lodErrors[RD_MESH_MAX_LODS];
+};
+static_assert(sizeof(CullParams) == 48, "CullParams has to match its WGSL layout");
+
+// @brief Build the culling pipeline, its bind group layout is derived from cull.wgsl
+bool RdGpuCulling::Initialize(RdDriver& p_driver, const WGPUBuffer& p_uniformBuffer) {
+	ZoneScoped;
+	uniformBuffer = p_uniformBuffer;
+
+	WGPUComputePipelineDescriptor pipelineDesc = {
+		.nextInChain = nullptr,
+		.label = "Culling Pipeline",
+		.layout = nullptr,
+		.compute = {
+			.nextInChain = nullptr,
+			.module = p_driver.ShaderModuleLoad("cull.wgsl"),
+			.entryPoint = "cs_main",
+			.constantCount = 0,
+			.constants = nullptr,
+		},
+	};
+	pipeline = wgpuDeviceCreateComputePipeline(p_driver.device, &pipelineDesc);
+	if (pipeline == nullptr) {
+		LOG_ERROR("Failed to create the culling pipeline");
+		return false;
+	}
+	bindGroupLayout = wgpuComputePipelineGetBindGroupLayout(pipeline, 0);
+
+	LOG_INFO("GPU culling initialized");
+	return true;
+}
+
+// @brief Size the output buffers for p_instanceCount instances and bind them, false when they exceed the limits
+bool RdGpuCulling::InstancesBind(
+		RdDriver& p_driver,
+		const WGPUBuffer& p_instanceBuffer,
+		uint32_t p_instanceCount,
+		std::span<const RdMeshLod> p_lods,
+		float p_meshRadius,
+		float p_lodScale,
+		uint64_t p_maxBindingSize
+) {
+	ZoneScoped;
+	BuffersRelease();
+	instanceCount = 0;
+	lodCount = 0;
+
+	uint64_t instanceBytes = wgpuBufferGetSize(p_instanceBuffer);
+	uint64_t visibleBytes = instanceBytes * p_lods.size();
+	if (visibleBytes > p_maxBindingSize) {
+		LOG_WARN("%llu bytes of visible instances exceed the storage binding limit, GPU culling disabled",
+				 static_cast<unsigned long long>(visibleBytes));
+		return false;
+	}
+
+	CullParams params = {
+		.instanceCount = p_instanceCount,
+		.radius = p_meshRadius,
+		.ratio = 800.0f / 600.0f,  // Same constant as vs_main in triangles.wgsl
+		.lodCount = static_cast<uint32_t>(p_lods.size()),
+		.lodScale = p_lodScale,
+		.padding = {},
+		.lodErrors = {},
+	};
+	for (size_t l = 0; l < p_lods.size(); ++l) {
+		params.lodErrors[l] = p_lods[l].error;
+	}
+	paramsBuffer = p_driver.BufferCreate(
+			WGPUBufferUsage_Uniform | WGPUBufferUsage_CopyDst, &params, sizeof(params), "Culling Params"
+	);
+
+	// One draw per level. Everything but the instance counts stays fixed, those are cleared before every dispatch.
+	std::vector<uint32_t> indirect;
+	for (const RdMeshLod& lod : p_lods) {
+		indirect.insert(indirect.end(), { lod.indexCount, 0, lod.firstIndex, 0, 0 });
+	}
+	indirectBuffer = p_driver.BufferCreate(
+			WGPUBufferUsage_Indirect | WGPUBufferUsage_Storage | WGPUBufferUsage_CopyDst,
+			indirect.data(),
+			indirect.size() * sizeof(uint32_t),
+			"Culling Indirect Draw"
+	);
+
+	WGPUBufferDescriptor visibleDesc = {
+		.nextInChain = nullptr,
+		.label = "Culling Visible Instances",
+		.usage = WGPUBufferUsage_Vertex | WGPUBufferUsage_Storage,
+		.size = visibleBytes,
+		.mappedAtCreation = false,
+	};
+	visibleBuffer = wgpuDeviceCreateBuffer(p_driver.device, &visibleDesc);
+
+	auto entry = [](uint32_t binding, WGPUBuffer buffer, uint64_t size) {
+		return WGPUBindGroupEntry{
+			.nextInChain = nullptr,
+			.binding = binding,
+			.buffer = buffer,
+			.offset = 0,
+			.size = size,
+			.sampler = nullptr,
+			.textureView = nullptr,
+		};
+	};
+	WGPUBindGroupEntry entries[] = {
+		entry(0, uniformBuffer, 4 * sizeof(float)),
+		entry(1, paramsBuffer, sizeof(CullParams)),
+		entry(2, p_instanceBuffer, instanceBytes),
+		entry(3, visibleBuffer, visibleBytes),
+		entry(4, indirectBuffer, INDIRECT_SIZE * p_lods.size()),
+	};
+
+	WGPUBindGroupDescriptor bindGroupDesc = {
+		.nextInChain = nullptr,
+		.label = "Culling Bind Group",
+		.layout = bindGroupLayout,
+		.entryCount = 5,
+		.entries = entries,
+	};
+	bindGroup = wgpuDeviceCreateBindGroup(p_driver.device, &bindGroupDesc);
+
+	instanceCount = p_instanceCount;
+	lodCount = static_cast<uint32_t>(p_lods.size());
+	return true;
+}
+
+// @brief Update the bounding radius after the mesh changed, through the next staging flush
+void RdGpuCulling::RadiusSet(RdStagingRing& p_staging, float p_meshRadius) {
+	if (paramsBuffer != nullptr) {
+		p_staging.Upload(paramsBuffer, offsetof(CullParams, radius), &p_meshRadius, sizeof(float));
+	}
+}
+
+// @brief Update the pixels per mesh unit levels are picked with after a resize, through the next staging flush
+void RdGpuCulling::LodScaleSet(RdStagingRing& p_staging, float p_lodScale) {
+	if (paramsBuffer != nullptr) {
+		p_staging.Upload(paramsBuffer, offsetof(CullParams, lodScale), &p_lodScale, sizeof(float));
+	}
+}
+
+bool RdGpuCulling::Ready() const {
+	return pipeline != nullptr && bindGroup != nullptr && instanceCount > 0;
+}
+
+void RdGpuCulling::Dispatch(const WGPUCommandEncoder& p_encoder, const WGPUComputePassTimestampWrites* p_timestampWrites) {
+	ZoneScoped;
+	for (uint32_t l = 0; l < lodCount; ++l) {
+		wgpuCommandEncoderClearBuffer(p_encoder, indirectBuffer, l * INDIRECT_SIZE + sizeof(uint32_t), sizeof(uint32_t));
+	}
+
+	WGPUComputePassDescriptor passDesc = {
+		.nextInChain = nullptr,
+		.label = "Culling Pass",
+		.timestampWrites = p_timestampWrites,
+	};
+	WGPUComputePassEncoder pass = wgpuCommandEncoderBeginComputePass(p_encoder, &passDesc);
+	wgpuComputePassEncoderSetPipeline(pass, pipeline);
+	wgpuComputePassEncoderSetBindGroup(pass, 0, bindGroup, 0, nullptr);
+	wgpuComputePassEncoderDispatchWorkgroups(pass, (instanceCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+	wgpuComputePassEncoderEnd(pass);
+	wgpuComputePassEncoderRelease(pass);
+}
+
+// @brief Draw the survivors of the last dispatch from level p_firstLod on, the index and vertex buffers of the mesh
+// have to be bound
+void RdGpuCulling::Draw(const WGPURenderPassEncoder& p_renderPass, uint32_t p_firstLod) {
+	ZoneScoped;
+	uint64_t regionBytes = wgpuBufferGetSize(visibleBuffer) / lodCount;
+	for (uint32_t l = p_firstLod; l < lodCount; ++l) {
+		wgpuRenderPassEncoderSetVertexBuffer(p_renderPass, 1, visibleBuffer, l * regionBytes, regionBytes);
+		wgpuRenderPassEncoderDrawIndexedIndirect(p_renderPass, indirectBuffer, l * INDIRECT_SIZE);
+	}
+}
+
+void RdGpuCulling::Draw(const WGPURenderBundleEncoder& p_bundle, uint32_t p_firstLod) {
+	ZoneScoped;
+	uint64_t regionBytes = wgpuBufferGetSize(visibleBuffer) / lodCount;
+	for (uint32_t l = p_firstLod; l < lodCount; ++l) {
+		wgpuRenderBundleEncoderSetVertexBuffer(p_bundle, 1, visibleBuffer, l * regionBytes, regionBytes);
+		wgpuRenderBundleEncoderDrawIndexedIndirect(p_bundle, indirectBuffer, l * INDIRECT_SIZE);
+	}
+}
+
+void RdGpuCulling::BuffersRelease() {
+	if (bindGroup != nullptr) {
+		wgpuBindGroupRelease(bindGroup);
+		bindGroup = nullptr;
+	}
+	for (WGPUBuffer* buffer : { &paramsBuffer, &visibleBuffer, &indirectBuffer }) {
+		if (*buffer != nullptr) {
+			wgpuBufferRelease(*buffer);
+			*buffer = nullptr;
+		}
+	}
+}
+
+void RdGpuCulling::Release() {
+	ZoneScoped;
+	BuffersRelease();
+	if (bindGroupLayout != nullptr) {
+		wgpuBindGroupLayoutRelease(bindGroupLayout);
+		bindGroupLayout = nullptr;
+	}
+	if (pipeline != nullptr) {
+		wgpuComputePipelineRelease(pipeline);
+		pipeline = nullptr;
+	}
+	LOG_TRACE("GPU culling released");
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "../asset/MeshLod.hpp"
+#include <webgpu/webgpu.h>
+
+#include <cstdint>
+#include <span>
+
+struct RdDriver;
+struct RdStagingRing;
+
+// @brief Compute pre-pass that frustum culls instances on the GPU and feeds an indexed indirect draw.
+// Survivors are compacted into visibleBuffer, which replaces the instance buffer when drawing, and their count
+// lands in the instanceCount of indirectBuffer, so the CPU never touches individual instances.
+// Every survivor also gets the coarsest level of detail whose projected error stays below the threshold. Levels
+// have their own region of visibleBuffer, instanceCount entries long, and their own draw in indirectBuffer.
+struct RdGpuCulling {
+	bool Initialize(RdDriver& p_driver, const WGPUBuffer& p_uniformBuffer);
+	bool InstancesBind(
+			RdDriver& p_driver,
+			const WGPUBuffer& p_instanceBuffer,
+			uint32_t p_instanceCount,
+			std::span<const RdMeshLod> p_lods,
+			float p_meshRadius,
+			float p_lodScale,
+			uint64_t p_maxBindingSize
+	);
+	void RadiusSet(RdStagingRing& p_staging, float p_meshRadius);
+	void LodScaleSet(RdStagingRing& p_staging, float p_lodScale);
+	void Dispatch(const WGPUCommandEncoder& p_encoder, const WGPUComputePassTimestampWrites* p_timestampWrites = nullptr);
+	void Draw(const WGPURenderPassEncoder& p_renderPass, uint32_t p_firstLod = 0);
+	void Draw(const WGPURenderBundleEncoder& p_bundle, uint32_t p_firstLod = 0);
+	void Release();
+
+	bool Ready() const;
+
+	WGPUComputePipeline pipeline = nullptr;
+	WGPUBindGroupLayout bindGroupLayout = nullptr;
+	WGPUBindGroup bindGroup = nullptr;
+	WGPUBuffer uniformBuffer = nullptr;
+	WGPUBuffer paramsBuffer = nullptr;
+	WGPUBuffer visibleBuffer = nullptr;
+	WGPUBuffer indirectBuffer = nullptr;
+	uint32_t instanceCount = 0;
+	uint32_t lodCount = 0;
+
+private:
+	void BuffersRelease();
+};
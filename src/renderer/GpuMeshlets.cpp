@@ -0,0 +1,231 @@
+#include "GpuMeshlets.hpp"
+
+#include "Driver.hpp"
+#include "GpuCulling.hpp"
+#include "logging_macros.h"
+#include "tracy/Tracy.hpp"
+
+#include <algorithm>
+#include <cstddef>
+
+// Matches @workgroup_size in meshlets.wgsl.
+static constexpr uint32_t WORKGROUP_SIZE = 64;
+// Size of ClusterDraw in meshlets.wgsl.
+static constexpr uint64_t INDIRECT_SIZE = 5 * sizeof(uint32_t);
+
+// Mirrors MeshletParams in meshlets.wgsl.
+struct MeshletParams {
+	uint32_t meshletCount;
+	uint32_t indexStride;
+	float ratio;
+	uint32_t cones;
+};
+static_assert(sizeof(MeshletParams) == 16, "MeshletParams has to match its WGSL layout");
+
+// @brief Build the meshlet culling pipeline, its bind group layout is derived from meshlets.wgsl
+bool RdGpuMeshlets::Initialize(RdDriver& p_driver, const WGPUBuffer& p_uniformBuffer) {
+	ZoneScoped;
+	uniformBuffer = p_uniformBuffer;
+
+	WGPUComputePipelineDescriptor pipelineDesc = {
+		.nextInChain = nullptr,
+		.label = "Meshlet Culling Pipeline",
+		.layout = nullptr,
+		.compute = {
+			.nextInChain = nullptr,
+			.module = p_driver.ShaderModuleLoad("meshlets.wgsl"),
+			.entryPoint = "cs_main",
+			.constantCount = 0,
+			.constants = nullptr,
+		},
+	};
+	pipeline = wgpuDeviceCreateComputePipeline(p_driver.device, &pipelineDesc);
+	if (pipeline == nullptr) {
+		LOG_ERROR("Failed to create the meshlet culling pipeline");
+		return false;
+	}
+	bindGroupLayout = wgpuComputePipelineGetBindGroupLayout(pipeline, 0);
+
+	LOG_INFO("GPU meshlet culling initialized");
+	return true;
+}
+
+// @brief Bind p_meshlets, ranges of p_meshIndexBuffer, to the level 0 output of p_culling. False when the culling
+// pass is not bound, culls more than MAX_INSTANCES instances or the buffers exceed the limits.
+bool RdGpuMeshlets::MeshletsBind(
+		RdDriver& p_driver,
+		std::span<const RdMeshlet> p_meshlets,
+		const WGPUBuffer& p_meshIndexBuffer,
+		uint32_t p_indexStride,
+		const RdGpuCulling& p_culling,
+		bool p_cones,
+		uint64_t p_maxBindingSize
+) {
+	ZoneScoped;
+	BuffersRelease();
+	meshletCount = 0;
+	if (!p_culling.Ready() || p_meshlets.empty()) {
+		return false;
+	}
+	if (p_culling.instanceCount > MAX_INSTANCES) {
+		LOG_INFO("Meshlet culling skipped for %u instances, it runs up to %u", p_culling.instanceCount, MAX_INSTANCES);
+		return false;
+	}
+
+	uint32_t indexCount = p_meshlets.back().firstIndex + p_meshlets.back().indexCount;
+	uint64_t meshIndexBytes = wgpuBufferGetSize(p_meshIndexBuffer);
+	uint64_t clusterIndexBytes = static_cast<uint64_t>(indexCount) * sizeof(uint32_t);
+	if (std::max(meshIndexBytes, clusterIndexBytes) > p_maxBindingSize) {
+		LOG_WARN("%llu bytes of meshlet indices exceed the storage binding limit, meshlet culling disabled",
+				 static_cast<unsigned long long>(clusterIndexBytes));
+		return false;
+	}
+
+	MeshletParams params = {
+		.meshletCount = static_cast<uint32_t>(p_meshlets.size()),
+		.indexStride = p_indexStride,
+		.ratio = 800.0f / 600.0f,  // Same constant as vs_main in triangles.wgsl
+		.cones = p_cones ? 1u : 0u,
+	};
+	paramsBuffer = p_driver.BufferCreate(
+			WGPUBufferUsage_Uniform | WGPUBufferUsage_CopyDst, &params, sizeof(params), "Meshlet Params"
+	);
+	meshletBuffer = p_driver.BufferCreate(
+			WGPUBufferUsage_Storage | WGPUBufferUsage_CopyDst,
+			p_meshlets.data(),
+			p_meshlets.size_bytes(),
+			"Meshlets"
+	);
+
+	// Both counts are written by the pass, the index count cleared before every dispatch.
+	uint32_t indirect[] = { 0, 0, 0, 0, 0 };
+	indirectBuffer = p_driver.BufferCreate(
+			WGPUBufferUsage_Indirect | WGPUBufferUsage_Storage | WGPUBufferUsage_CopyDst,
+			indirect,
+			sizeof(indirect),
+			"Meshlet Indirect Draw"
+	);
+
+	WGPUBufferDescriptor indexDesc = {
+		.nextInChain = nullptr,
+		.label = "Meshlet Indices",
+		.usage = WGPUBufferUsage_Index | WGPUBufferUsage_Storage,
+		.size = clusterIndexBytes,
+		.mappedAtCreation = false,
+	};
+	indexBuffer = wgpuDeviceCreateBuffer(p_driver.device, &indexDesc);
+
+	visibleBuffer = p_culling.visibleBuffer;
+	visibleBytes = wgpuBufferGetSize(visibleBuffer) / p_culling.lodCount;
+
+	auto entry = [](uint32_t binding, WGPUBuffer buffer, uint64_t size) {
+		return WGPUBindGroupEntry{
+			.nextInChain = nullptr,
+			.binding = binding,
+			.buffer = buffer,
+			.offset = 0,
+			.size = size,
+			.sampler = nullptr,
+			.textureView = nullptr,
+		};
+	};
+	WGPUBindGroupEntry entries[] = {
+		entry(0, uniformBuffer, 4 * sizeof(float)),
+		entry(1, paramsBuffer, sizeof(MeshletParams)),
+		entry(2, meshletBuffer, p_meshlets.size_bytes()),
+		entry(3, p_meshIndexBuffer, meshIndexBytes),
+		entry(4, visibleBuffer, visibleBytes),
+		entry(5, p_culling.indirectBuffer, INDIRECT_SIZE),
+		entry(6, indexBuffer, clusterIndexBytes),
+		entry(7, indirectBuffer, INDIRECT_SIZE),
+	};
+
+	WGPUBindGroupDescriptor bindGroupDesc = {
+		.nextInChain = nullptr,
+		.label = "Meshlet Culling Bind Group",
+		.layout = bindGroupLayout,
+		.entryCount = 8,
+		.entries = entries,
+	};
+	bindGroup = wgpuDeviceCreateBindGroup(p_driver.device, &bindGroupDesc);
+
+	meshletCount = static_cast<uint32_t>(p_meshlets.size());
+	return true;
+}
+
+// @brief Replace the meshlet bounds after the vertices moved, through the next staging flush
+void RdGpuMeshlets::BoundsSet(RdStagingRing& p_staging, std::span<const RdMeshlet> p_meshlets) {
+	if (meshletBuffer != nullptr && p_meshlets.size() == meshletCount) {
+		p_staging.Upload(meshletBuffer, 0, p_meshlets.data(), p_meshlets.size_bytes());
+	}
+}
+
+bool RdGpuMeshlets::Ready() const {
+	return pipeline != nullptr && bindGroup != nullptr && meshletCount > 0;
+}
+
+void RdGpuMeshlets::Dispatch(const WGPUCommandEncoder& p_encoder, const WGPUComputePassTimestampWrites* p_timestampWrites) {
+	ZoneScoped;
+	wgpuCommandEncoderClearBuffer(p_encoder, indirectBuffer, 0, sizeof(uint32_t));
+
+	WGPUComputePassDescriptor passDesc = {
+		.nextInChain = nullptr,
+		.label = "Meshlet Culling Pass",
+		.timestampWrites = p_timestampWrites,
+	};
+	WGPUComputePassEncoder pass = wgpuCommandEncoderBeginComputePass(p_encoder, &passDesc);
+	wgpuComputePassEncoderSetPipeline(pass, pipeline);
+	wgpuComputePassEncoderSetBindGroup(pass, 0, bindGroup, 0, nullptr);
+	wgpuComputePassEncoderDispatchWorkgroups(pass, (meshletCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+	wgpuComputePassEncoderEnd(pass);
+	wgpuComputePassEncoderRelease(pass);
+}
+
+// @brief Draw the surviving meshlets, this binds an index buffer of its own over the one of the mesh
+void RdGpuMeshlets::Draw(const WGPURenderPassEncoder& p_renderPass) {
+	ZoneScoped;
+	wgpuRenderPassEncoderSetIndexBuffer(
+			p_renderPass, indexBuffer, WGPUIndexFormat_Uint32, 0, wgpuBufferGetSize(indexBuffer)
+	);
+	wgpuRenderPassEncoderSetVertexBuffer(p_renderPass, 1, visibleBuffer, 0, visibleBytes);
+	wgpuRenderPassEncoderDrawIndexedIndirect(p_renderPass, indirectBuffer, 0);
+}
+
+void RdGpuMeshlets::Draw(const WGPURenderBundleEncoder& p_bundle) {
+	ZoneScoped;
+	wgpuRenderBundleEncoderSetIndexBuffer(
+			p_bundle, indexBuffer, WGPUIndexFormat_Uint32, 0, wgpuBufferGetSize(indexBuffer)
+	);
+	wgpuRenderBundleEncoderSetVertexBuffer(p_bundle, 1, visibleBuffer, 0, visibleBytes);
+	wgpuRenderBundleEncoderDrawIndexedIndirect(p_bundle, indirectBuffer, 0);
+}
+
+void RdGpuMeshlets::BuffersRelease() {
+	if (bindGroup != nullptr) {
+		wgpuBindGroupRelease(bindGroup);
+		bindGroup = nullptr;
+	}
+	for (WGPUBuffer* buffer : { &paramsBuffer, &meshletBuffer, &indexBuffer, &indirectBuffer }) {
+		if (*buffer != nullptr) {
+			wgpuBufferRelease(*buffer);
+			*buffer = nullptr;
+		}
+	}
+	// Owned by the culling pass.
+	visibleBuffer = nullptr;
+	visibleBytes = 0;
+}
+
+void RdGpuMeshlets::Release() {
+	ZoneScoped;
+	BuffersRelease();
+	if (bindGroupLayout != nullptr) {
+		wgpuBindGroupLayoutRelease(bindGroupLayout);
+		bindGroupLayout = nullptr;
+	}
+	if (pipeline != nullptr) {
+		wgpuComputePipelineRelease(pipeline);
+		pipeline = nullptr;
+	}
+	LOG_TRACE("GPU meshlet culling released");
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "../asset/Meshlet.hpp"
+#include <webgpu/webgpu.h>
+
+#include <cstdint>
+#include <span>
+
+struct RdDriver;
+struct RdGpuCulling;
+struct RdStagingRing;
+
+// @brief Compute pass culling the meshlets of the full mesh, run after RdGpuCulling on the instances it left at
+// level 0. The indices of every meshlet some of those instances see are compacted into indexBuffer and counted
+// in indirectBuffer, whose draw replaces the level 0 draw of RdGpuCulling. Coarser levels are small on screen
+// and stay whole.
+struct RdGpuMeshlets {
+	// Every meshlet thread tests the level 0 instances one by one, the pass costs meshlets times instances and is
+	// only bound up to this many instances. Past it the instances are small on screen and hide few meshlets anyway.
+	static constexpr uint32_t MAX_INSTANCES = 256;
+
+	bool Initialize(RdDriver& p_driver, const WGPUBuffer& p_uniformBuffer);
+	bool MeshletsBind(
+			RdDriver& p_driver,
+			std::span<const RdMeshlet> p_meshlets,
+			const WGPUBuffer& p_meshIndexBuffer,
+			uint32_t p_indexStride,
+			const RdGpuCulling& p_culling,
+			bool p_cones,
+			uint64_t p_maxBindingSize
+	);
+	void BoundsSet(RdStagingRing& p_staging, std::span<const RdMeshlet> p_meshlets);
+	void Dispatch(const WGPUCommandEncoder& p_encoder, const WGPUComputePassTimestampWrites* p_timestampWrites = nullptr);
+	void Draw(const WGPURenderPassEncoder& p_renderPass);
+	void Draw(const WGPURenderBundleEncoder& p_bundle);
+	void Release();
+
+	bool Ready() const;
+
+	WGPUComputePipeline pipeline = nullptr;
+	WGPUBindGroupLayout bindGroupLayout = nullptr;
+	WGPUBindGroup bindGroup = nullptr;
+	WGPUBuffer uniformBuffer = nullptr;
+	WGPUBuffer paramsBuffer = nullptr;
+	WGPUBuffer meshletBuffer = nullptr;
+	WGPUBuffer indexBuffer = nullptr;
+	WGPUBuffer indirectBuffer = nullptr;
+	// Level 0 region of the culling output, the instances the meshlet draw is instanced over.
+	WGPUBuffer visibleBuffer = nullptr;
+	uint64_t visibleBytes = 0;
+	uint32_t meshletCount = 0;
+
+private:
+	void BuffersRelease();
+};
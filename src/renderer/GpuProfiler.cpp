@@ -0,0 +1,269 @@
+#include "GpuProfiler.hpp"
+
+#include "logging_macros.h"
+#include "tracy/Tracy.hpp"
+
+#ifdef TRACY_ENABLE
+#include "client/TracyProfiler.hpp"
+#include "tracy/TracyC.h"
+#endif	// TRACY_ENABLE
+
+#include <cstring>
+#include <utility>
+
+// Two timestamps of 8 bytes per pass.
+static constexpr uint64_t SLOT_BYTES = RdGpuProfiler::MAX_PASSES * 2 * sizeof(uint64_t);
+
+void RdGpuProfiler::Initialize(const WGPUDevice& p_device, bool p_supported) {
+	ZoneScoped;
+	if (!p_supported) {
+		LOG_WARN("Timestamp queries unsupported, GPU passes are not profiled");
+		return;
+	}
+
+	WGPUQuerySetDescriptor querySetDesc = {
+		.nextInChain = nullptr,
+		.label = "Profiler Timestamps",
+		.type = WGPUQueryType_Timestamp,
+		.count = MAX_PASSES * 2,
+	};
+	m_querySet = wgpuDeviceCreateQuerySet(p_device, &querySetDesc);
+	if (m_querySet == nullptr) {
+		LOG_WARN("Failed to create the timestamp query set, GPU passes are not profiled");
+		return;
+	}
+
+	// Queries resolve into a buffer that cannot be mapped, the copy into a readback slot keeps it reusable
+	// next frame since the GPU runs both in order.
+	WGPUBufferDescriptor resolveDesc = {
+		.nextInChain = nullptr,
+		.label = "Profiler Resolve",
+		.usage = WGPUBufferUsage_QueryResolve | WGPUBufferUsage_CopySrc,
+		.size = SLOT_BYTES,
+		.mappedAtCreation = false,
+	};
+	m_resolveBuffer = wgpuDeviceCreateBuffer(p_device, &resolveDesc);
+
+	for (Slot& slot : m_slots) {
+		WGPUBufferDescriptor readbackDesc = {
+			.nextInChain = nullptr,
+			.label = "Profiler Readback",
+			.usage = WGPUBufferUsage_MapRead | WGPUBufferUsage_CopyDst,
+			.size = SLOT_BYTES,
+			.mappedAtCreation = false,
+		};
+		slot = {
+			.readback = wgpuDeviceCreateBuffer(p_device, &readbackDesc),
+			.state = SlotState::Free,
+			.frame = 0,
+			.passCount = 0,
+			.names = {},
+			.submitted = {},
+		};
+	}
+
+	LOG_INFO("GPU profiler initialized: %u passes per frame, %u frames of readback", MAX_PASSES, FRAMES);
+}
+
+void RdGpuProfiler::Terminate() {
+	ZoneScoped;
+	for (Slot& slot : m_slots) {
+		if (slot.readback != nullptr) {
+			// Destroying a buffer with a map pending cancels it, the callback then sees no readback and stays quiet.
+			WGPUBuffer readback = std::exchange(slot.readback, nullptr);
+			wgpuBufferDestroy(readback);
+			wgpuBufferRelease(readback);
+		}
+	}
+	if (m_resolveBuffer != nullptr) {
+		wgpuBufferRelease(m_resolveBuffer);
+		m_resolveBuffer = nullptr;
+	}
+	if (m_querySet != nullptr) {
+		wgpuQuerySetRelease(m_querySet);
+		m_querySet = nullptr;
+	}
+	m_current = nullptr;
+}
+
+bool RdGpuProfiler::Enabled() const {
+	return m_querySet != nullptr;
+}
+
+// @brief Results are published oldest frame first, a frame still mapping holds back the ones after it
+void RdGpuProfiler::FrameBegin() {
+	ZoneScoped;
+	m_current = nullptr;
+	if (!Enabled()) {
+		return;
+	}
+
+	for (;;) {
+		Slot* oldest = nullptr;
+		for (Slot& slot : m_slots) {
+			bool pending = slot.state == SlotState::InFlight || slot.state == SlotState::Mapped;
+			if (pending && (oldest == nullptr || slot.frame < oldest->frame)) {
+				oldest = &slot;
+			}
+		}
+		if (oldest == nullptr || oldest->state != SlotState::Mapped) {
+			break;
+		}
+
+		uint64_t timestamps[MAX_PASSES * 2];
+		std::memcpy(timestamps, wgpuBufferGetConstMappedRange(oldest->readback, 0, SLOT_BYTES), SLOT_BYTES);
+		wgpuBufferUnmap(oldest->readback);
+		Publish(*oldest, timestamps);
+		oldest->state = SlotState::Free;
+	}
+
+	for (Slot& slot : m_slots) {
+		if (slot.state == SlotState::Free) {
+			m_current = &slot;
+			break;
+		}
+	}
+	if (m_current == nullptr) {
+		TracyMessageL("GPU profiler readback full, frame not measured");
+		return;
+	}
+	m_current->state = SlotState::Recording;
+	m_current->frame = m_frame++;
+	m_current->passCount = 0;
+}
+
+uint32_t RdGpuProfiler::QueryAcquire(const char* p_name) {
+	if (m_current == nullptr || m_current->passCount == MAX_PASSES) {
+		return UINT32_MAX;
+	}
+	m_current->names[m_current->passCount] = p_name;
+	return 2 * m_current->passCount++;
+}
+
+const WGPURenderPassTimestampWrites* RdGpuProfiler::RenderPass(const char* p_name) {
+	uint32_t query = QueryAcquire(p_name);
+	if (query == UINT32_MAX) {
+		return nullptr;
+	}
+	m_renderWrites = {
+		.querySet = m_querySet,
+		.beginningOfPassWriteIndex = query,
+		.endOfPassWriteIndex = query + 1,
+	};
+	return &m_renderWrites;
+}
+
+const WGPUComputePassTimestampWrites* RdGpuProfiler::ComputePass(const char* p_name) {
+	uint32_t query = QueryAcquire(p_name);
+	if (query == UINT32_MAX) {
+		return nullptr;
+	}
+	m_computeWrites = {
+		.querySet = m_querySet,
+		.beginningOfPassWriteIndex = query,
+		.endOfPassWriteIndex = query + 1,
+	};
+	return &m_computeWrites;
+}
+
+void RdGpuProfiler::Resolve(const WGPUCommandEncoder& p_encoder) {
+	ZoneScoped;
+	if (m_current == nullptr || m_current->passCount == 0) {
+		return;
+	}
+	uint32_t queryCount = 2 * m_current->passCount;
+	uint64_t bytes = queryCount * sizeof(uint64_t);
+	wgpuCommandEncoderResolveQuerySet(p_encoder, m_querySet, 0, queryCount, m_resolveBuffer, 0);
+	wgpuCommandEncoderCopyBufferToBuffer(p_encoder, m_resolveBuffer, 0, m_current->readback, 0, bytes);
+}
+
+// @brief Map the readback of the submitted frame, the map only completes once the GPU executed it
+void RdGpuProfiler::FrameSubmitted() {
+	ZoneScoped;
+	if (m_current == nullptr) {
+		return;
+	}
+	if (m_current->passCount == 0) {
+		m_current->state = SlotState::Free;
+	} else {
+		m_current->state = SlotState::InFlight;
+		m_current->submitted = std::chrono::steady_clock::now();
+		wgpuBufferMapAsync(m_current->readback, WGPUMapMode_Read, 0, SLOT_BYTES, OnSlotMapped, m_current);
+	}
+	m_current = nullptr;
+}
+
+void RdGpuProfiler::OnSlotMapped(WGPUBufferMapAsyncStatus p_status, void* p_userdata) {
+	Slot& slot = *reinterpret_cast<Slot*>(p_userdata);
+	if (p_status != WGPUBufferMapAsyncStatus_Success) {
+		if (slot.readback != nullptr) {
+			LOG_WARN("Profiler readback map failed: %d", static_cast<int>(p_status));
+		}
+		slot.state = SlotState::Lost;
+		return;
+	}
+	slot.state = SlotState::Mapped;
+}
+
+// @brief Plot the duration of every pass and hand them to Tracy as GPU zones.
+// WebGPU timestamps are nanoseconds on a clock the CPU cannot read, so the Tracy context is created from the first
+// results assuming their first pass started on the GPU as the frame was submitted. Zones are then off by the submit latency of
+// that frame, their durations are exact.
+void RdGpuProfiler::Publish(const Slot& p_slot, const uint64_t* p_timestamps) {
+	ZoneScoped;
+	double frameMs = 0.0;
+	for (uint32_t pass = 0; pass < p_slot.passCount; ++pass) {
+		uint64_t begin = p_timestamps[2 * pass];
+		uint64_t end = p_timestamps[2 * pass + 1];
+		// Some drivers write zeros or reorder timestamps across power state changes, such passes are dropped.
+		if (begin == 0 || end < begin) {
+			continue;
+		}
+		double ms = static_cast<double>(end - begin) * 1e-6;
+		frameMs += ms;
+		TracyPlot(p_slot.names[pass], ms);
+
+#ifdef TRACY_ENABLE
+		if (!m_tracyContext) {
+			auto sinceSubmit = std::chrono::steady_clock::now() - p_slot.submitted;
+			int64_t gpuNow = static_cast<int64_t>(begin)
+					+ std::chrono::duration_cast<std::chrono::nanoseconds>(sinceSubmit).count();
+			m_tracyContextId = tracy::GetGpuCtxCounter().fetch_add(1, std::memory_order_relaxed);
+			___tracy_emit_gpu_new_context({
+				.gpuTime = gpuNow,
+				.period = 1.0f,
+				.context = m_tracyContextId,
+				.flags = 0,
+				.type = static_cast<uint8_t>(tracy::GpuContextType::Invalid),
+			});
+			static constexpr char CONTEXT_NAME[] = "WebGPU Queue";
+			___tracy_emit_gpu_context_name({
+				.context = m_tracyContextId,
+				.name = CONTEXT_NAME,
+				.len = sizeof(CONTEXT_NAME) - 1,
+			});
+			m_tracyContext = true;
+		}
+
+		const char* name = p_slot.names[pass];
+		uint64_t srcloc = ___tracy_alloc_srcloc_name(
+				__LINE__, __FILE__, sizeof(__FILE__) - 1, __func__, sizeof(__func__) - 1, name, std::strlen(name), 0
+		);
+		uint16_t beginQuery = m_tracyQuery++;
+		uint16_t endQuery = m_tracyQuery++;
+		___tracy_emit_gpu_zone_begin_alloc({ .srcloc = srcloc, .queryId = beginQuery, .context = m_tracyContextId });
+		___tracy_emit_gpu_time({
+			.gpuTime = static_cast<int64_t>(begin),
+			.queryId = beginQuery,
+			.context = m_tracyContextId,
+		});
+		___tracy_emit_gpu_zone_end({ .queryId = endQuery, .context = m_tracyContextId });
+		___tracy_emit_gpu_time({
+			.gpuTime = static_cast<int64_t>(end),
+			.queryId = endQuery,
+			.context = m_tracyContextId,
+		});
+#endif	// TRACY_ENABLE
+	}
+	TracyPlot("GPU frame ms", frameMs);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <webgpu/webgpu.h>
+
+#include <chrono>
+#include <cstdint>
+
+// @brief GPU durations of render and compute passes, measured with timestamp queries and published to Tracy.
+// Every pass that asks for timestampWrites gets two queries, they are resolved at the end of the frame and
+// copied into one of FRAMES readback buffers. Results are read once their map completed, a few frames later,
+// so the CPU never waits on the GPU. A frame whose readback buffer is still busy is simply not measured.
+// Without the timestamp-query feature every pass gets nullptr and nothing is recorded.
+struct RdGpuProfiler {
+	static constexpr uint32_t MAX_PASSES = 8;
+	static constexpr uint32_t FRAMES = 4;
+
+	void Initialize(const WGPUDevice& p_device, bool p_supported);
+	void Terminate();
+
+	// @brief Publish the frames whose results arrived and pick the readback buffer of the new frame
+	void FrameBegin();
+	// @brief Timestamp writes for the next pass, nullptr when the frame is not measured. p_name has to outlive the
+	// profiler, it names the Tracy zone and the plot of its milliseconds.
+	const WGPURenderPassTimestampWrites* RenderPass(const char* p_name);
+	const WGPUComputePassTimestampWrites* ComputePass(const char* p_name);
+	// @brief Resolve the queries of this frame into its readback buffer, last command before finishing p_encoder
+	void Resolve(const WGPUCommandEncoder& p_encoder);
+	// @brief Call once the command buffer holding the resolve was submitted
+	void FrameSubmitted();
+
+	bool Enabled() const;
+
+private:
+	enum class SlotState : uint8_t {
+		Free,		// Not holding any results.
+		Recording,	// Passes of the current frame write into it.
+		InFlight,	// Submitted, wgpuBufferMapAsync pending.
+		Mapped,		// Results readable.
+		Lost,		// Mapping failed, never used again.
+	};
+
+	struct Slot {
+		WGPUBuffer readback;
+		SlotState state;
+		uint64_t frame;
+		uint32_t passCount;
+		const char* names[MAX_PASSES];
+		std::chrono::steady_clock::time_point submitted;
+	};
+
+	// First of the two queries of the next pass, UINT32_MAX when the frame is not measured or out of passes.
+	uint32_t QueryAcquire(const char* p_name);
+	void Publish(const Slot& p_slot, const uint64_t* p_timestamps);
+	static void OnSlotMapped(WGPUBufferMapAsyncStatus p_status, void* p_userdata);
+
+	WGPUQuerySet m_querySet = nullptr;
+	WGPUBuffer m_resolveBuffer = nullptr;
+	Slot m_slots[FRAMES] = {};
+	Slot* m_current = nullptr;
+	uint64_t m_frame = 0;
+	WGPURenderPassTimestampWrites m_renderWrites = {};
+	WGPUComputePassTimestampWrites m_computeWrites = {};
+
+	// Tracy GPU context, created from the first results so their timestamps can be lined up with the CPU clock.
+	bool m_tracyContext = false;
+	uint8_t m_tracyContextId = 0;
+	uint16_t m_tracyQuery = 0;
+};
@@ -0,0 +1,189 @@
+#include "PipelineCache.hpp"
+
+#include "logging_macros.h"
+#include "tracy/Tracy.hpp"
+
+#include <cstdio>
+#include <functional>
+#include <system_error>
+
+// @brief 64-bit FNV-1a, p_seed chains several calls into one hash
+uint64_t RdPipelineCache::Hash(const void* p_data, size_t p_size, uint64_t p_seed) {
+	const auto* bytes = static_cast<const unsigned char*>(p_data);
+	uint64_t hash = p_seed;
+	for (size_t i = 0; i < p_size; ++i) {
+		hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+	}
+	return hash;
+}
+
+// @brief Hash every field one by one, the structs have padding that must not leak into the key
+uint64_t RdPipelineCache::DescHash(const RdPipelineDesc& p_desc, uint64_t p_sourceHash, WGPUPipelineLayout p_layout) {
+	uint64_t hash = Hash(&p_sourceHash, sizeof(p_sourceHash));
+	auto mix = [&hash](const auto& value) { hash = Hash(&value, sizeof(value), hash); };
+
+	// Layouts are not deduplicated, the handle identifies it.
+	mix(p_layout);
+	// The list sizes keep an attribute moved from one list to the other from hashing the same.
+	mix(p_desc.attributes.size());
+	for (const WGPUVertexAttribute& attribute : p_desc.attributes) {
+		mix(attribute.format);
+		mix(attribute.offset);
+		mix(attribute.shaderLocation);
+	}
+	mix(p_desc.vertexStride);
+	mix(p_desc.instanceAttributes.size());
+	for (const WGPUVertexAttribute& attribute : p_desc.instanceAttributes) {
+		mix(attribute.format);
+		mix(attribute.offset);
+		mix(attribute.shaderLocation);
+	}
+	mix(p_desc.instanceStride);
+	mix(p_desc.topology);
+	mix(p_desc.stripIndexFormat);
+	mix(p_desc.cullMode);
+	mix(p_desc.colorFormat);
+	mix(p_desc.blend);
+	mix(p_desc.depthFormat);
+	mix(p_desc.depthWrite);
+	mix(p_desc.depthCompare);
+	return hash;
+}
+
+static std::filesystem::path BlobPath(const std::filesystem::path& p_directory, const void* p_key, size_t p_keySize) {
+	char name[32];
+	std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(RdPipelineCache::Hash(p_key, p_keySize)));
+	return p_directory / name;
+}
+
+// @brief Dawn asks with p_value == nullptr for the blob size first, then again with a buffer to fill
+size_t RdPipelineCache::DiskLoad(const void* p_key, size_t p_keySize, void* p_value, size_t p_valueSize, void* p_userdata) {
+	ZoneScoped;
+	auto& cache = *static_cast<RdPipelineCache*>(p_userdata);
+	std::FILE* file = std::fopen(BlobPath(cache.directory, p_key, p_keySize).string().c_str(), "rb");
+	if (file == nullptr) {
+		return 0;
+	}
+
+	std::fseek(file, 0, SEEK_END);
+	size_t size = static_cast<size_t>(std::ftell(file));
+	if (p_value != nullptr) {
+		std::fseek(file, 0, SEEK_SET);
+		size = p_valueSize >= size ? std::fread(p_value, 1, size, file) : 0;
+		cache.diskHits += size > 0;
+	}
+	std::fclose(file);
+	return size;
+}
+
+// @brief Written under a name of its own and renamed into place, so a reader on another thread or in another process
+// finds either the whole blob or none
+void RdPipelineCache::DiskStore(const void* p_key, size_t p_keySize, const void* p_value, size_t p_valueSize, void* p_userdata) {
+	ZoneScoped;
+	auto& cache = *static_cast<RdPipelineCache*>(p_userdata);
+	std::error_code error;
+	std::filesystem::create_directories(cache.directory, error);
+
+	std::filesystem::path path = BlobPath(cache.directory, p_key, p_keySize);
+	static std::atomic<uint32_t> counter = 0;
+	char suffix[64];
+	std::snprintf(suffix, sizeof(suffix), ".%zx.%llx.%u.tmp", std::hash<std::thread::id>()(std::this_thread::get_id()),
+				  static_cast<unsigned long long>(std::chrono::steady_clock::now().time_since_epoch().count()),
+				  counter++);
+	std::filesystem::path temporary = path;
+	temporary += suffix;
+
+	std::FILE* file = std::fopen(temporary.string().c_str(), "wb");
+	if (file == nullptr) {
+		LOG_WARN("Failed to store pipeline cache blob: %s", path.string().c_str());
+		return;
+	}
+	bool written = std::fwrite(p_value, 1, p_valueSize, file) == p_valueSize;
+	if (std::fclose(file) != 0 || !written) {
+		LOG_WARN("Failed to write pipeline cache blob: %s", path.string().c_str());
+		std::filesystem::remove(temporary, error);
+		return;
+	}
+	std::filesystem::rename(temporary, path, error);
+	if (error) {
+		LOG_WARN("Failed to move pipeline cache blob into place: %s", path.string().c_str());
+		std::filesystem::remove(temporary, error);
+		return;
+	}
+	cache.diskStores++;
+}
+
+void RdPipelineCache::OnPipelineCreated(
+		WGPUCreatePipelineAsyncStatus p_status,
+		WGPURenderPipeline p_pipeline,
+		const char* p_message,
+		void* p_userdata
+) {
+	auto* request = static_cast<Request*>(p_userdata);
+	if (p_status != WGPUCreatePipelineAsyncStatus_Success) {
+		LOG_ERROR("Pipeline compilation failed: %s", p_message ? p_message : "unknown error");
+		p_pipeline = nullptr;
+	}
+	request->cache->Complete(*request, p_pipeline);
+	delete request;
+}
+
+void RdPipelineCache::Complete(const Request& p_request, WGPURenderPipeline p_pipeline) {
+	double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - p_request.start).count();
+	std::lock_guard lock(completedMutex);
+	completed.push_back({ p_request.hash, p_pipeline, elapsedMs });
+}
+
+void RdPipelineCache::Collect() {
+	ZoneScoped;
+	std::vector<Completion> finished;
+	{
+		std::lock_guard lock(completedMutex);
+		finished.swap(completed);
+	}
+
+	for (const Completion& completion : finished) {
+		pending.erase(completion.hash);
+		if (auto worker = workers.find(completion.hash); worker != workers.end()) {
+			worker->second.join();
+			workers.erase(worker);
+		}
+		if (completion.pipeline == nullptr) {
+			failures++;
+			continue;
+		}
+		misses++;
+		compileMs += completion.compileMs;
+		pipelines.emplace(completion.hash, completion.pipeline);
+		LOG_INFO("Pipeline %016llx compiled in %.2f ms", static_cast<unsigned long long>(completion.hash), completion.compileMs);
+	}
+	if (!finished.empty()) {
+		StatsPlot();
+	}
+}
+
+void RdPipelineCache::Release() {
+	ZoneScoped;
+	for (auto& [hash, worker] : workers) {
+		worker.join();
+	}
+	Collect();
+	for (auto& [hash, pipeline] : pipelines) {
+		wgpuRenderPipelineRelease(pipeline);
+	}
+	for (auto& [hash, module] : shaderModules) {
+		wgpuShaderModuleRelease(module);
+	}
+	LOG_TRACE("Pipeline cache released: %zu pipelines, %zu shader modules", pipelines.size(), shaderModules.size());
+	pipelines.clear();
+	shaderModules.clear();
+	sources.clear();
+}
+
+void RdPipelineCache::StatsPlot() const {
+	TracyPlot("Pipeline cache hits", static_cast<int64_t>(hits));
+	TracyPlot("Pipeline cache misses", static_cast<int64_t>(misses));
+	TracyPlot("Pipeline disk cache hits", static_cast<int64_t>(diskHits.load()));
+	TracyPlot("Pipeline compile ms", compileMs);
+	TracyPlot("Pipeline compiles pending", static_cast<int64_t>(pending.size()));
+}
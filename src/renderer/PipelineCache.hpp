@@ -0,0 +1,96 @@
+#pragma once
+
+#include <webgpu/webgpu.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Everything that goes into a render pipeline, two equal descriptions always produce the same pipeline.
+struct RdPipelineDesc {
+	std::string shader;
+	std::vector<WGPUVertexAttribute> attributes;
+	uint64_t vertexStride;
+	// Second buffer stepped per instance, none when instanceStride is 0.
+	std::vector<WGPUVertexAttribute> instanceAttributes;
+	uint64_t instanceStride;
+	WGPUPrimitiveTopology topology;
+	WGPUIndexFormat stripIndexFormat;
+	WGPUCullMode cullMode;
+	WGPUTextureFormat colorFormat;
+	bool blend;
+	WGPUTextureFormat depthFormat;
+	bool depthWrite;
+	WGPUCompareFunction depthCompare;
+};
+
+// @brief Shader modules and render pipelines deduplicated by a hash of their sources and full description.
+// On Dawn the device hands its compiled pipeline blobs to DiskLoad/DiskStore, which keep them in CACHE_DIR
+// so the next launch skips the backend compilation.
+struct RdPipelineCache {
+	// Userdata of one asynchronous compile, freed once it completed.
+	struct Request {
+		RdPipelineCache* cache;
+		uint64_t hash;
+		std::chrono::steady_clock::time_point start;
+	};
+
+	// A shader file as last read from disk.
+	struct Source {
+		std::string text;
+		uint64_t hash;
+	};
+
+	struct Completion {
+		uint64_t hash;
+		WGPURenderPipeline pipeline;
+		double compileMs;
+	};
+
+	static uint64_t Hash(const void* p_data, size_t p_size, uint64_t p_seed = 0xcbf29ce484222325ull);
+	static uint64_t DescHash(const RdPipelineDesc& p_desc, uint64_t p_sourceHash, WGPUPipelineLayout p_layout);
+
+	static size_t DiskLoad(const void* p_key, size_t p_keySize, void* p_value, size_t p_valueSize, void* p_userdata);
+	static void DiskStore(const void* p_key, size_t p_keySize, const void* p_value, size_t p_valueSize, void* p_userdata);
+
+	static void OnPipelineCreated(
+			WGPUCreatePipelineAsyncStatus p_status,
+			WGPURenderPipeline p_pipeline,
+			const char* p_message,
+			void* p_userdata
+	);
+
+	// @brief Hand a finished compile over from any thread, p_pipeline is nullptr when it failed
+	void Complete(const Request& p_request, WGPURenderPipeline p_pipeline);
+	// @brief Move finished compiles into the cache, on the thread that uses it
+	void Collect();
+	void Release();
+	void StatsPlot() const;
+
+	// Keyed by shader file name, an entry is dropped when the file changes on disk.
+	std::unordered_map<std::string, Source> sources;
+	std::unordered_map<uint64_t, WGPUShaderModule> shaderModules;
+	std::unordered_map<uint64_t, WGPURenderPipeline> pipelines;
+	std::filesystem::path directory;
+
+	// Hashes still compiling, and the worker threads of backends without asynchronous creation.
+	std::unordered_set<uint64_t> pending;
+	std::unordered_map<uint64_t, std::thread> workers;
+	std::mutex completedMutex;
+	std::vector<Completion> completed;
+
+	uint32_t hits = 0;
+	uint32_t misses = 0;
+	// Counted in the Dawn callbacks, which may run on its compile threads.
+	std::atomic<uint32_t> diskHits = 0;
+	std::atomic<uint32_t> diskStores = 0;
+	uint32_t failures = 0;
+	double compileMs = 0.0;
+};
@@ -0,0 +1,206 @@
+#include "StagingRing.hpp"
+
+#include "logging_macros.h"
+#include "tracy/Tracy.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+// Copies between buffers need 4 byte aligned offsets and sizes.
+static constexpr uint64_t COPY_ALIGNMENT = 4;
+
+static uint64_t AlignUp(uint64_t p_value, uint64_t p_alignment) {
+	return (p_value + p_alignment - 1) / p_alignment * p_alignment;
+}
+
+void RdStagingRing::Initialize(const WGPUDevice& p_device, const WGPUQueue& p_queue, uint64_t p_pageSize) {
+	ZoneScoped;
+	m_device = p_device;
+	m_queue = p_queue;
+	m_pageSize = AlignUp(p_pageSize, COPY_ALIGNMENT);
+	LOG_TRACE("Staging ring initialized, %llu byte pages", static_cast<unsigned long long>(m_pageSize));
+}
+
+// @brief Release every page, frames still in flight have to be waited for before
+void RdStagingRing::Terminate() {
+	ZoneScoped;
+	bool busy = Busy();
+	for (auto& page : m_pages) {
+		wgpuBufferRelease(page->buffer);
+	}
+	if (busy) {
+		// Callbacks may still fire with these as userdata, leak the bookkeeping instead of leaving them dangling.
+		LOG_WARN("Staging ring terminated with uploads in flight");
+		for (auto& page : m_pages) {
+			(void)page.release();
+		}
+		for (auto& frame : m_frames) {
+			(void)frame.release();
+		}
+	}
+	m_pages.clear();
+	m_frames.clear();
+	m_framePages.clear();
+	m_copies.clear();
+	LOG_TRACE("Staging ring destroyed");
+}
+
+// @brief True while a submitted frame or a page map has a callback outstanding
+bool RdStagingRing::Busy() const {
+	return std::any_of(m_frames.begin(), m_frames.end(), [](const auto& frame) { return !frame->done; })
+			|| std::any_of(m_pages.begin(), m_pages.end(), [](const auto& page) {
+				   return page->state == PageState::Mapping;
+			   });
+}
+
+// @brief Empty slices take no page, a page is only told apart from a free one by the bytes written to it
+RdStagingSlice RdStagingRing::Allocate(uint64_t p_size, uint64_t p_alignment) {
+	ZoneScoped;
+	if (p_size == 0) {
+		return {};
+	}
+	uint64_t size = AlignUp(p_size, COPY_ALIGNMENT);
+	uint64_t alignment = std::max(p_alignment, COPY_ALIGNMENT);
+
+	Page* page = m_framePages.empty() ? nullptr : m_framePages.back();
+	if (page == nullptr || AlignUp(page->head, alignment) + size > page->size) {
+		page = PageAcquire(size);
+		m_framePages.push_back(page);
+	}
+
+	uint64_t offset = AlignUp(page->head, alignment);
+	page->head = offset + size;
+	frameBytes += size;
+
+	return {
+		.data = page->mapped + offset,
+		.buffer = page->buffer,
+		.offset = offset,
+		.size = size,
+	};
+}
+
+void RdStagingRing::Upload(const WGPUBuffer& p_destination, uint64_t p_offset, const void* p_data, uint64_t p_size) {
+	if (p_size == 0) {
+		return;
+	}
+	RdStagingSlice slice = Allocate(p_size);
+	std::memcpy(slice.data, p_data, p_size);
+	CopyQueue(slice, p_destination, p_offset);
+}
+
+// @brief Queue the copy of p_slice into p_destination, copies that continue the previous one are merged into it
+void RdStagingRing::CopyQueue(const RdStagingSlice& p_slice, const WGPUBuffer& p_destination, uint64_t p_offset) {
+	if (p_slice.size == 0) {
+		return;
+	}
+	if (!m_copies.empty()) {
+		Copy& last = m_copies.back();
+		if (last.source == p_slice.buffer && last.destination == p_destination
+			&& last.sourceOffset + last.size == p_slice.offset && last.destinationOffset + last.size == p_offset) {
+			last.size += p_slice.size;
+			return;
+		}
+	}
+	m_copies.push_back({ p_slice.buffer, p_slice.offset, p_destination, p_offset, p_slice.size });
+}
+
+void RdStagingRing::Flush(const WGPUCommandEncoder& p_encoder) {
+	ZoneScoped;
+	for (Page* page : m_framePages) {
+		wgpuBufferUnmap(page->buffer);
+		page->mapped = nullptr;
+		page->state = PageState::InFlight;
+	}
+	for (const Copy& copy : m_copies) {
+		wgpuCommandEncoderCopyBufferToBuffer(
+				p_encoder, copy.source, copy.sourceOffset, copy.destination, copy.destinationOffset, copy.size
+		);
+	}
+	frameCopies = static_cast<uint32_t>(m_copies.size());
+
+	TracyPlot("Staging bytes per frame", static_cast<int64_t>(frameBytes));
+	TracyPlot("Staging copies per frame", static_cast<int64_t>(frameCopies));
+	TracyPlot("Staging pages", static_cast<int64_t>(m_pages.size()));
+
+	if (!m_framePages.empty()) {
+		m_frames.push_back(std::make_unique<Frame>(Frame{ std::move(m_framePages), false, false }));
+	}
+	m_framePages.clear();
+	m_copies.clear();
+}
+
+void RdStagingRing::FrameSubmitted() {
+	ZoneScoped;
+	frameBytes = 0;
+	for (auto& frame : m_frames) {
+		if (!frame->submitted) {
+			frame->submitted = true;
+			wgpuQueueOnSubmittedWorkDone(m_queue, OnFrameWorkDone, frame.get());
+		}
+	}
+}
+
+// @brief Start mapping the pages of every frame the GPU is done with.
+// Maps are requested here rather than from the work done callback so no WebGPU call happens inside one.
+void RdStagingRing::Reclaim() {
+	ZoneScoped;
+	std::erase_if(m_frames, [](const std::unique_ptr<Frame>& frame) {
+		if (!frame->done) {
+			return false;
+		}
+		for (Page* page : frame->pages) {
+			page->state = PageState::Mapping;
+			wgpuBufferMapAsync(page->buffer, WGPUMapMode_Write, 0, page->size, OnPageMapped, page);
+		}
+		return true;
+	});
+}
+
+RdStagingRing::Page* RdStagingRing::PageAcquire(uint64_t p_size) {
+	ZoneScoped;
+	Reclaim();
+
+	// Pages of the current frame are never empty, so a mapped page with nothing in it is free.
+	for (auto& page : m_pages) {
+		if (page->state == PageState::Mapped && page->head == 0 && page->size >= p_size) {
+			return page.get();
+		}
+	}
+
+	WGPUBufferDescriptor bufferDesc = {
+		.nextInChain = nullptr,
+		.label = "Staging Page",
+		.usage = WGPUBufferUsage_MapWrite | WGPUBufferUsage_CopySrc,
+		.size = std::max(m_pageSize, p_size),
+		.mappedAtCreation = true,
+	};
+	WGPUBuffer buffer = wgpuDeviceCreateBuffer(m_device, &bufferDesc);
+	Page* page = m_pages.emplace_back(std::make_unique<Page>(Page{
+		.buffer = buffer,
+		.size = bufferDesc.size,
+		.head = 0,
+		.mapped = static_cast<std::byte*>(wgpuBufferGetMappedRange(buffer, 0, bufferDesc.size)),
+		.state = PageState::Mapped,
+	})).get();
+
+	LOG_TRACE("Staging page created: %llu bytes, %zu pages", static_cast<unsigned long long>(page->size), m_pages.size());
+	return page;
+}
+
+void RdStagingRing::OnFrameWorkDone(WGPUQueueWorkDoneStatus p_status, void* p_userdata) {
+	(void)p_status;
+	reinterpret_cast<Frame*>(p_userdata)->done = true;
+}
+
+void RdStagingRing::OnPageMapped(WGPUBufferMapAsyncStatus p_status, void* p_userdata) {
+	Page& page = *reinterpret_cast<Page*>(p_userdata);
+	if (p_status != WGPUBufferMapAsyncStatus_Success) {
+		LOG_WARN("Staging page map failed: %d", static_cast<int>(p_status));
+		page.state = PageState::Lost;
+		return;
+	}
+	page.mapped = static_cast<std::byte*>(wgpuBufferGetMappedRange(page.buffer, 0, page.size));
+	page.head = 0;
+	page.state = PageState::Mapped;
+}
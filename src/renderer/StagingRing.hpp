@@ -0,0 +1,81 @@
+#pragma once
+
+#include <webgpu/webgpu.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// A sub-allocation of a staging page, write up to size bytes at data before the frame is flushed.
+struct RdStagingSlice {
+	void* data;
+	WGPUBuffer buffer;
+	uint64_t offset;
+	uint64_t size;
+};
+
+// @brief Per-frame upload allocator built on persistently mapped MapWrite | CopySrc pages.
+// Slices are written in place and turned into buffer to buffer copies when the frame is flushed, the pages
+// a frame used come back once wgpuQueueOnSubmittedWorkDone reports the frame done and they are mapped again.
+struct RdStagingRing {
+	void Initialize(const WGPUDevice& p_device, const WGPUQueue& p_queue, uint64_t p_pageSize = 1 << 20);
+	void Terminate();
+
+	RdStagingSlice Allocate(uint64_t p_size, uint64_t p_alignment = 4);
+	// @brief Stage p_size bytes of p_data and queue their copy to p_destination
+	void Upload(const WGPUBuffer& p_destination, uint64_t p_offset, const void* p_data, uint64_t p_size);
+	void CopyQueue(const RdStagingSlice& p_slice, const WGPUBuffer& p_destination, uint64_t p_offset);
+
+	// @brief Unmap the pages written this frame and record their queued copies into p_encoder
+	void Flush(const WGPUCommandEncoder& p_encoder);
+	// @brief Call once the command buffer holding the flushed copies was submitted
+	void FrameSubmitted();
+	bool Busy() const;
+
+	// Bytes staged and copy commands recorded by the last flushed frame.
+	uint64_t frameBytes = 0;
+	uint32_t frameCopies = 0;
+
+private:
+	enum class PageState : uint8_t {
+		Mapped,		// Writable, either free or filled by the current frame.
+		InFlight,	// Unmapped and referenced by a submitted frame.
+		Mapping,	// wgpuBufferMapAsync pending.
+		Lost,		// Mapping failed, never handed out again.
+	};
+
+	struct Page {
+		WGPUBuffer buffer;
+		uint64_t size;
+		uint64_t head;
+		std::byte* mapped;
+		PageState state;
+	};
+
+	struct Copy {
+		WGPUBuffer source;
+		uint64_t sourceOffset;
+		WGPUBuffer destination;
+		uint64_t destinationOffset;
+		uint64_t size;
+	};
+
+	struct Frame {
+		std::vector<Page*> pages;
+		bool submitted;
+		bool done;
+	};
+
+	Page* PageAcquire(uint64_t p_size);
+	void Reclaim();
+	static void OnFrameWorkDone(WGPUQueueWorkDoneStatus p_status, void* p_userdata);
+	static void OnPageMapped(WGPUBufferMapAsyncStatus p_status, void* p_userdata);
+
+	WGPUDevice m_device = nullptr;
+	WGPUQueue m_queue = nullptr;
+	uint64_t m_pageSize = 0;
+	std::vector<std::unique_ptr<Page>> m_pages;
+	std::vector<Page*> m_framePages;
+	std::vector<Copy> m_copies;
+	std::vector<std::unique_ptr<Frame>> m_frames;
+};
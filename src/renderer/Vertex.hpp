@@ -6,3 +6,12 @@ struct Vertex {
     glm::vec3 position;
     glm::vec3 color;
 };
+
+// Per-instance data, stepped once per instance from the second vertex buffer.
+// The world transform is a similarity, rotation holds a unit quaternion as xyzw.
+struct Instance {
+    glm::vec3 position;
+    float scale;
+    glm::vec4 rotation;
+    glm::vec4 color;
+};
@@ -0,0 +1,29 @@
+#include "Aabb.hpp"
+
+void RdAabbSoA::Resize(size_t p_count) {
+	m_count = p_count;
+	size_t padded = (p_count + 2 * LANES - 1) / LANES * LANES;
+	for (std::vector<float>* component : { &minX, &minY, &minZ, &maxX, &maxY, &maxZ }) {
+		component->resize(padded, 0.0f);
+	}
+}
+
+void RdAabbSoA::Set(size_t p_index, const RdAabb& p_box) {
+	minX[p_index] = p_box.min.x;
+	minY[p_index] = p_box.min.y;
+	minZ[p_index] = p_box.min.z;
+	maxX[p_index] = p_box.max.x;
+	maxY[p_index] = p_box.max.y;
+	maxZ[p_index] = p_box.max.z;
+}
+
+RdAabb RdAabbSoA::Get(size_t p_index) const {
+	return {
+		.min = { minX[p_index], minY[p_index], minZ[p_index] },
+		.max = { maxX[p_index], maxY[p_index], maxZ[p_index] },
+	};
+}
+
+size_t RdAabbSoA::Size() const {
+	return m_count;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <glm.hpp>
+
+#include <cstddef>
+#include <vector>
+
+struct RdAabb {
+	glm::vec3 min;
+	glm::vec3 max;
+};
+
+// @brief Boxes stored one component per array, so SIMD code loads the same component of several boxes at once.
+// The arrays hold LANES more entries than boxes, a full vector load starting at any box stays in bounds.
+struct RdAabbSoA {
+	static constexpr size_t LANES = 8;
+
+	void Resize(size_t p_count);
+	void Set(size_t p_index, const RdAabb& p_box);
+	RdAabb Get(size_t p_index) const;
+	size_t Size() const;
+
+	std::vector<float> minX, minY, minZ;
+	std::vector<float> maxX, maxY, maxZ;
+
+private:
+	size_t m_count = 0;
+};
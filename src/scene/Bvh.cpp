@@ -0,0 +1,194 @@
+#include "Bvh.hpp"
+
+#include "tracy/Tracy.hpp"
+
+#include <algorithm>
+#include <limits>
+
+static RdAabb BoxEmpty() {
+	constexpr float inf = std::numeric_limits<float>::infinity();
+	return { .min = glm::vec3(inf), .max = glm::vec3(-inf) };
+}
+
+static RdAabb BoxUnion(const RdAabb& p_a, const RdAabb& p_b) {
+	return { .min = glm::min(p_a.min, p_b.min), .max = glm::max(p_a.max, p_b.max) };
+}
+
+static float BoxArea(const RdAabb& p_box) {
+	glm::vec3 size = glm::max(p_box.max - p_box.min, glm::vec3(0.0f));
+	return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+void RdBvh::Build(const RdAabbSoA& p_boxes) {
+	ZoneScoped;
+	uint32_t count = static_cast<uint32_t>(p_boxes.Size());
+	nodes.clear();
+	nodes.reserve(2 * (count / LEAF_SIZE) + 1);
+	slotIds.resize(count);
+	for (uint32_t i = 0; i < count; ++i) {
+		slotIds[i] = i;
+	}
+	slotLeaves.resize(count);
+
+	nodes.push_back({});
+	NodeBuild(0, 0, 0, count, p_boxes);
+
+	idSlots.resize(count);
+	slotBoxes.Resize(count);
+	for (uint32_t slot = 0; slot < count; ++slot) {
+		idSlots[slotIds[slot]] = slot;
+		slotBoxes.Set(slot, p_boxes.Get(slotIds[slot]));
+	}
+
+	area = 0.0f;
+	for (const RdBvhNode& node : nodes) {
+		area += BoxArea(node.bounds);
+	}
+	builtArea = area;
+	++builds;
+	TracyPlot("BVH nodes", static_cast<int64_t>(nodes.size()));
+}
+
+// @brief Fill node p_index with slots [p_first, p_first + p_count), splitting at the median of the longest centroid axis
+void RdBvh::NodeBuild(uint32_t p_index, uint32_t p_parent, uint32_t p_first, uint32_t p_count, const RdAabbSoA& p_boxes) {
+	RdAabb bounds = BoxEmpty();
+	RdAabb centroids = BoxEmpty();
+	for (uint32_t slot = p_first; slot < p_first + p_count; ++slot) {
+		RdAabb box = p_boxes.Get(slotIds[slot]);
+		glm::vec3 centroid = 0.5f * (box.min + box.max);
+		bounds = BoxUnion(bounds, box);
+		centroids = BoxUnion(centroids, { .min = centroid, .max = centroid });
+	}
+	nodes[p_index] = { .bounds = bounds, .first = p_first, .count = p_count, .left = 0, .parent = p_parent };
+
+	if (p_count <= LEAF_SIZE) {
+		for (uint32_t slot = p_first; slot < p_first + p_count; ++slot) {
+			slotLeaves[slot] = p_index;
+		}
+		return;
+	}
+
+	glm::vec3 extent = centroids.max - centroids.min;
+	int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+	const float* minimum = axis == 0 ? p_boxes.minX.data() : (axis == 1 ? p_boxes.minY.data() : p_boxes.minZ.data());
+	const float* maximum = axis == 0 ? p_boxes.maxX.data() : (axis == 1 ? p_boxes.maxY.data() : p_boxes.maxZ.data());
+
+	uint32_t half = p_count / 2;
+	std::nth_element(
+			slotIds.begin() + p_first,
+			slotIds.begin() + p_first + half,
+			slotIds.begin() + p_first + p_count,
+			[minimum, maximum](uint32_t a, uint32_t b) { return minimum[a] + maximum[a] < minimum[b] + maximum[b]; }
+	);
+
+	uint32_t left = static_cast<uint32_t>(nodes.size());
+	nodes.push_back({});
+	nodes.push_back({});
+	nodes[p_index].left = left;
+	NodeBuild(left, p_index, p_first, half, p_boxes);
+	NodeBuild(left + 1, p_index, p_first + half, p_count - half, p_boxes);
+}
+
+// @brief Recompute the bounds of one node from its slots or children and track the change in area
+void RdBvh::NodeFit(uint32_t p_index) {
+	RdBvhNode& node = nodes[p_index];
+	RdAabb bounds = BoxEmpty();
+	if (node.left == 0) {
+		for (uint32_t slot = node.first; slot < node.first + node.count; ++slot) {
+			bounds = BoxUnion(bounds, slotBoxes.Get(slot));
+		}
+	} else {
+		bounds = BoxUnion(nodes[node.left].bounds, nodes[node.left + 1].bounds);
+	}
+	area += BoxArea(bounds) - BoxArea(node.bounds);
+	node.bounds = bounds;
+}
+
+// @brief Children always come after their parent, so one backwards pass refits bottom-up
+void RdBvh::RefitAll() {
+	for (size_t i = nodes.size(); i-- > 0;) {
+		NodeFit(static_cast<uint32_t>(i));
+	}
+}
+
+bool RdBvh::Update(const RdAabbSoA& p_boxes, std::span<const uint32_t> p_moved) {
+	ZoneScoped;
+	if (nodes.empty() || p_boxes.Size() != slotIds.size()) {
+		Build(p_boxes);
+		return true;
+	}
+
+	for (uint32_t id : p_moved) {
+		slotBoxes.Set(idSlots[id], p_boxes.Get(id));
+	}
+
+	// Walking up from every moved box only pays off while few of them moved.
+	if (p_moved.size() * 4 > slotIds.size()) {
+		RefitAll();
+	} else {
+		for (uint32_t id : p_moved) {
+			uint32_t index = slotLeaves[idSlots[id]];
+			while (true) {
+				RdAabb before = nodes[index].bounds;
+				NodeFit(index);
+				bool unchanged = before.min == nodes[index].bounds.min && before.max == nodes[index].bounds.max;
+				if (index == 0 || unchanged) {
+					break;
+				}
+				index = nodes[index].parent;
+			}
+		}
+	}
+
+	TracyPlot("BVH area ratio", static_cast<double>(builtArea > 0.0f ? area / builtArea : 1.0f));
+	if (area > builtArea * REBUILD_RATIO) {
+		Build(p_boxes);
+		return true;
+	}
+	return false;
+}
+
+bool RdBvh::UpdateAll(const RdAabbSoA& p_boxes) {
+	ZoneScoped;
+	if (nodes.empty() || p_boxes.Size() != slotIds.size()) {
+		Build(p_boxes);
+		return true;
+	}
+	for (uint32_t slot = 0; slot < slotIds.size(); ++slot) {
+		slotBoxes.Set(slot, p_boxes.Get(slotIds[slot]));
+	}
+	RefitAll();
+	if (area > builtArea * REBUILD_RATIO) {
+		Build(p_boxes);
+		return true;
+	}
+	return false;
+}
+
+// @brief Skip nodes outside the frustum, take nodes inside whole and test the boxes of straddling leaves
+void RdBvh::Cull(const RdFrustum& p_frustum, std::vector<uint32_t>& p_visible) const {
+	ZoneScoped;
+	if (nodes.empty() || nodes[0].count == 0) {
+		return;
+	}
+
+	// The median split keeps the tree balanced, 64 levels are out of reach.
+	uint32_t stack[64];
+	uint32_t depth = 0;
+	stack[depth++] = 0;
+	while (depth > 0) {
+		const RdBvhNode& node = nodes[stack[--depth]];
+		RdContainment containment = p_frustum.Classify(node.bounds);
+		if (containment == RdContainment::Outside) {
+			continue;
+		}
+		if (containment == RdContainment::Inside) {
+			p_visible.insert(p_visible.end(), slotIds.begin() + node.first, slotIds.begin() + node.first + node.count);
+		} else if (node.left == 0) {
+			FrustumCull(path, p_frustum, slotBoxes, node.first, node.first + node.count, slotIds.data(), p_visible);
+		} else {
+			stack[depth++] = node.left;
+			stack[depth++] = node.left + 1;
+		}
+	}
+}
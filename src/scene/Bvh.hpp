@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Aabb.hpp"
+#include "Frustum.hpp"
+#include "FrustumCull.hpp"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Nodes cover a contiguous range of slots, inner nodes store their children next to each other.
+struct RdBvhNode {
+	RdAabb bounds;
+	uint32_t first;
+	uint32_t count;
+	// Index of the left child, the right one follows it, 0 for leaves.
+	uint32_t left;
+	uint32_t parent;
+};
+
+// @brief Bounding volume hierarchy over a set of boxes, rejecting whole groups of them against a frustum.
+// Boxes are copied into slots in tree order so leaves test a contiguous run with the SIMD culling paths.
+// Moving boxes refits the nodes above them, the tree is rebuilt once refitting degraded it too much.
+struct RdBvh {
+	static constexpr uint32_t LEAF_SIZE = 16;
+	// Rebuild when the summed node surface grew by this factor since the last build.
+	static constexpr float REBUILD_RATIO = 1.5f;
+
+	void Build(const RdAabbSoA& p_boxes);
+	// @brief Pick up the new bounds of the boxes in p_moved, returns true when that triggered a rebuild
+	bool Update(const RdAabbSoA& p_boxes, std::span<const uint32_t> p_moved);
+	// @brief Same as Update with every box moved
+	bool UpdateAll(const RdAabbSoA& p_boxes);
+	void Cull(const RdFrustum& p_frustum, std::vector<uint32_t>& p_visible) const;
+
+	std::vector<RdBvhNode> nodes;
+	// Box id of each slot, the slot of each box id and the leaf holding each slot.
+	std::vector<uint32_t> slotIds;
+	std::vector<uint32_t> idSlots;
+	std::vector<uint32_t> slotLeaves;
+	RdAabbSoA slotBoxes;
+	RdCullPath path = FrustumCullBestPath();
+
+	// Summed surface area of all nodes, now and right after the last build.
+	float area = 0.0f;
+	float builtArea = 0.0f;
+	uint32_t builds = 0;
+
+private:
+	void NodeBuild(uint32_t p_index, uint32_t p_parent, uint32_t p_first, uint32_t p_count, const RdAabbSoA& p_boxes);
+	void NodeFit(uint32_t p_index);
+	void RefitAll();
+};
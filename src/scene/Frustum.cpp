@@ -0,0 +1,38 @@
+#include "Frustum.hpp"
+
+RdFrustum RdFrustum::FromMatrix(const glm::mat4& p_viewProjection) {
+	// glm is column major, row i of the matrix is (m[0][i], m[1][i], m[2][i], m[3][i]).
+	auto row = [&p_viewProjection](int i) {
+		return glm::vec4(p_viewProjection[0][i], p_viewProjection[1][i], p_viewProjection[2][i], p_viewProjection[3][i]);
+	};
+	glm::vec4 x = row(0);
+	glm::vec4 y = row(1);
+	glm::vec4 z = row(2);
+	glm::vec4 w = row(3);
+
+	// Left, right, bottom, top, near (z >= 0) and far (z <= w).
+	glm::vec4 equations[6] = { w + x, w - x, w + y, w - y, z, w - z };
+
+	RdFrustum frustum;
+	for (int i = 0; i < 6; ++i) {
+		float length = glm::length(glm::vec3(equations[i]));
+		frustum.planes[i] = { glm::vec3(equations[i]) / length, equations[i].w / length };
+	}
+	return frustum;
+}
+
+// @brief Test the box corner furthest along each plane normal, and the nearest one to tell inside from straddling
+RdContainment RdFrustum::Classify(const RdAabb& p_box) const {
+	RdContainment result = RdContainment::Inside;
+	for (const RdPlane& plane : planes) {
+		glm::vec3 positive = glm::mix(p_box.min, p_box.max, glm::greaterThanEqual(plane.normal, glm::vec3(0.0f)));
+		glm::vec3 negative = glm::mix(p_box.max, p_box.min, glm::greaterThanEqual(plane.normal, glm::vec3(0.0f)));
+		if (glm::dot(plane.normal, positive) + plane.d < 0.0f) {
+			return RdContainment::Outside;
+		}
+		if (glm::dot(plane.normal, negative) + plane.d < 0.0f) {
+			result = RdContainment::Intersects;
+		}
+	}
+	return result;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Aabb.hpp"
+
+#include <glm.hpp>
+
+// Points p with dot(normal, p) + d >= 0 are on the inner side.
+struct RdPlane {
+	glm::vec3 normal;
+	float d;
+};
+
+enum class RdContainment {
+	Outside,
+	Intersects,
+	Inside,
+};
+
+struct RdFrustum {
+	// @brief Extract the six planes of a view-projection matrix with WebGPU's [0, 1] clip depth
+	static RdFrustum FromMatrix(const glm::mat4& p_viewProjection);
+
+	RdContainment Classify(const RdAabb& p_box) const;
+
+	RdPlane planes[6];
+};
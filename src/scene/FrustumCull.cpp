@@ -0,0 +1,239 @@
+#include "FrustumCull.hpp"
+
+#include <bit>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RD_CULL_SSE 1
+#include <immintrin.h>
+#endif
+
+// MSVC only emits AVX for translation units built with /arch:AVX, GCC and Clang compile it per function.
+#if defined(RD_CULL_SSE) && (defined(__GNUC__) || defined(__clang__))
+#define RD_CULL_AVX 1
+#define RD_TARGET_AVX __attribute__((target("avx")))
+#endif
+
+// For every plane the box corner furthest along its normal, chosen once per call instead of once per box.
+struct PlaneCorner {
+	const float* x;
+	const float* y;
+	const float* z;
+	RdPlane plane;
+};
+
+static void PlaneCornersSelect(const RdFrustum& p_frustum, const RdAabbSoA& p_boxes, PlaneCorner p_corners[6]) {
+	for (int i = 0; i < 6; ++i) {
+		const RdPlane& plane = p_frustum.planes[i];
+		p_corners[i] = {
+			.x = plane.normal.x >= 0.0f ? p_boxes.maxX.data() : p_boxes.minX.data(),
+			.y = plane.normal.y >= 0.0f ? p_boxes.maxY.data() : p_boxes.minY.data(),
+			.z = plane.normal.z >= 0.0f ? p_boxes.maxZ.data() : p_boxes.minZ.data(),
+			.plane = plane,
+		};
+	}
+}
+
+// @brief Append the set bits of p_mask as indices relative to p_base
+static inline void VisibleAppend(uint32_t p_mask, size_t p_base, const uint32_t* p_ids, std::vector<uint32_t>& p_visible) {
+	while (p_mask != 0) {
+		size_t index = p_base + static_cast<size_t>(std::countr_zero(p_mask));
+		p_visible.push_back(p_ids != nullptr ? p_ids[index] : static_cast<uint32_t>(index));
+		p_mask &= p_mask - 1;
+	}
+}
+
+void FrustumCullScalar(
+		const RdFrustum& p_frustum,
+		const RdAabbSoA& p_boxes,
+		size_t p_begin,
+		size_t p_end,
+		const uint32_t* p_ids,
+		std::vector<uint32_t>& p_visible
+) {
+	PlaneCorner corners[6];
+	PlaneCornersSelect(p_frustum, p_boxes, corners);
+
+	for (size_t i = p_begin; i < p_end; ++i) {
+		bool outside = false;
+		for (const PlaneCorner& corner : corners) {
+			// Same association as the vector paths, so all of them agree on boxes touching a plane.
+			float distance = (corner.plane.normal.x * corner.x[i] + corner.plane.normal.y * corner.y[i])
+							 + (corner.plane.normal.z * corner.z[i] + corner.plane.d);
+			outside |= distance < 0.0f;
+		}
+		if (!outside) {
+			p_visible.push_back(p_ids != nullptr ? p_ids[i] : static_cast<uint32_t>(i));
+		}
+	}
+}
+
+void FrustumCullSse(
+		const RdFrustum& p_frustum,
+		const RdAabbSoA& p_boxes,
+		size_t p_begin,
+		size_t p_end,
+		const uint32_t* p_ids,
+		std::vector<uint32_t>& p_visible
+) {
+#if defined(RD_CULL_SSE)
+	PlaneCorner corners[6];
+	PlaneCornersSelect(p_frustum, p_boxes, corners);
+
+	__m128 normalX[6], normalY[6], normalZ[6], distance[6];
+	for (int p = 0; p < 6; ++p) {
+		normalX[p] = _mm_set1_ps(corners[p].plane.normal.x);
+		normalY[p] = _mm_set1_ps(corners[p].plane.normal.y);
+		normalZ[p] = _mm_set1_ps(corners[p].plane.normal.z);
+		distance[p] = _mm_set1_ps(corners[p].plane.d);
+	}
+	const __m128 zero = _mm_setzero_ps();
+
+	// The arrays are padded by a full vector, the lanes past p_end are read but masked off.
+	for (size_t i = p_begin; i < p_end; i += 4) {
+		__m128 outside = zero;
+		for (int p = 0; p < 6; ++p) {
+			__m128 d = _mm_add_ps(
+					_mm_add_ps(
+							_mm_mul_ps(normalX[p], _mm_loadu_ps(corners[p].x + i)),
+							_mm_mul_ps(normalY[p], _mm_loadu_ps(corners[p].y + i))
+					),
+					_mm_add_ps(_mm_mul_ps(normalZ[p], _mm_loadu_ps(corners[p].z + i)), distance[p])
+			);
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(d, zero));
+		}
+		uint32_t mask = ~static_cast<uint32_t>(_mm_movemask_ps(outside)) & 0xFu;
+		if (p_end - i < 4) {
+			mask &= (1u << (p_end - i)) - 1u;
+		}
+		VisibleAppend(mask, i, p_ids, p_visible);
+	}
+#else
+	FrustumCullScalar(p_frustum, p_boxes, p_begin, p_end, p_ids, p_visible);
+#endif	// RD_CULL_SSE
+}
+
+#if defined(RD_CULL_AVX)
+RD_TARGET_AVX static void FrustumCullAvxImpl(
+		const RdFrustum& p_frustum,
+		const RdAabbSoA& p_boxes,
+		size_t p_begin,
+		size_t p_end,
+		const uint32_t* p_ids,
+		std::vector<uint32_t>& p_visible
+) {
+	PlaneCorner corners[6];
+	PlaneCornersSelect(p_frustum, p_boxes, corners);
+
+	__m256 normalX[6], normalY[6], normalZ[6], distance[6];
+	for (int p = 0; p < 6; ++p) {
+		normalX[p] = _mm256_set1_ps(corners[p].plane.normal.x);
+		normalY[p] = _mm256_set1_ps(corners[p].plane.normal.y);
+		normalZ[p] = _mm256_set1_ps(corners[p].plane.normal.z);
+		distance[p] = _mm256_set1_ps(corners[p].plane.d);
+	}
+	const __m256 zero = _mm256_setzero_ps();
+
+	for (size_t i = p_begin; i < p_end; i += 8) {
+		__m256 outside = zero;
+		for (int p = 0; p < 6; ++p) {
+			__m256 d = _mm256_add_ps(
+					_mm256_add_ps(
+							_mm256_mul_ps(normalX[p], _mm256_loadu_ps(corners[p].x + i)),
+							_mm256_mul_ps(normalY[p], _mm256_loadu_ps(corners[p].y + i))
+					),
+					_mm256_add_ps(_mm256_mul_ps(normalZ[p], _mm256_loadu_ps(corners[p].z + i)), distance[p])
+			);
+			outside = _mm256_or_ps(outside, _mm256_cmp_ps(d, zero, _CMP_LT_OQ));
+		}
+		uint32_t mask = ~static_cast<uint32_t>(_mm256_movemask_ps(outside)) & 0xFFu;
+		if (p_end - i < 8) {
+			mask &= (1u << (p_end - i)) - 1u;
+		}
+		VisibleAppend(mask, i, p_ids, p_visible);
+	}
+}
+#endif	// RD_CULL_AVX
+
+void FrustumCullAvx(
+		const RdFrustum& p_frustum,
+		const RdAabbSoA& p_boxes,
+		size_t p_begin,
+		size_t p_end,
+		const uint32_t* p_ids,
+		std::vector<uint32_t>& p_visible
+) {
+#if defined(RD_CULL_AVX)
+	if (FrustumCullSupported(RdCullPath::Avx)) {
+		FrustumCullAvxImpl(p_frustum, p_boxes, p_begin, p_end, p_ids, p_visible);
+		return;
+	}
+#endif	// RD_CULL_AVX
+	FrustumCullSse(p_frustum, p_boxes, p_begin, p_end, p_ids, p_visible);
+}
+
+bool FrustumCullSupported(RdCullPath p_path) {
+	switch (p_path) {
+		case RdCullPath::Scalar:
+			return true;
+		case RdCullPath::Sse:
+#if defined(RD_CULL_SSE)
+			return true;
+#else
+			return false;
+#endif	// RD_CULL_SSE
+		case RdCullPath::Avx:
+#if defined(RD_CULL_AVX)
+		{
+			static const bool avx = __builtin_cpu_supports("avx");
+			return avx;
+		}
+#else
+			return false;
+#endif	// RD_CULL_AVX
+	}
+	return false;
+}
+
+RdCullPath FrustumCullBestPath() {
+	if (FrustumCullSupported(RdCullPath::Avx)) {
+		return RdCullPath::Avx;
+	}
+	if (FrustumCullSupported(RdCullPath::Sse)) {
+		return RdCullPath::Sse;
+	}
+	return RdCullPath::Scalar;
+}
+
+const char* FrustumCullPathName(RdCullPath p_path) {
+	switch (p_path) {
+		case RdCullPath::Scalar:
+			return "scalar";
+		case RdCullPath::Sse:
+			return "sse";
+		case RdCullPath::Avx:
+			return "avx";
+	}
+	return "unknown";
+}
+
+void FrustumCull(
+		RdCullPath p_path,
+		const RdFrustum& p_frustum,
+		const RdAabbSoA& p_boxes,
+		size_t p_begin,
+		size_t p_end,
+		const uint32_t* p_ids,
+		std::vector<uint32_t>& p_visible
+) {
+	switch (p_path) {
+		case RdCullPath::Avx:
+			FrustumCullAvx(p_frustum, p_boxes, p_begin, p_end, p_ids, p_visible);
+			break;
+		case RdCullPath::Sse:
+			FrustumCullSse(p_frustum, p_boxes, p_begin, p_end, p_ids, p_visible);
+			break;
+		case RdCullPath::Scalar:
+			FrustumCullScalar(p_frustum, p_boxes, p_begin, p_end, p_ids, p_visible);
+			break;
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Aabb.hpp"
+#include "Frustum.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class RdCullPath {
+	Scalar,
+	Sse,
+	Avx,
+};
+
+// @brief Append the boxes in [p_begin, p_end) that are not fully outside p_frustum to p_visible.
+// Indices are written through p_ids when given, so permuted boxes report the id of their owner.
+// All paths return the same boxes, they only differ in how many of them one test covers.
+void FrustumCullScalar(
+		const RdFrustum& p_frustum,
+		const RdAabbSoA& p_boxes,
+		size_t p_begin,
+		size_t p_end,
+		const uint32_t* p_ids,
+		std::vector<uint32_t>& p_visible
+);
+void FrustumCullSse(
+		const RdFrustum& p_frustum,
+		const RdAabbSoA& p_boxes,
+		size_t p_begin,
+		size_t p_end,
+		const uint32_t* p_ids,
+		std::vector<uint32_t>& p_visible
+);
+void FrustumCullAvx(
+		const RdFrustum& p_frustum,
+		const RdAabbSoA& p_boxes,
+		size_t p_begin,
+		size_t p_end,
+		const uint32_t* p_ids,
+		std::vector<uint32_t>& p_visible
+);
+
+// @brief Widest path this build and CPU support, SSE and AVX fall back to scalar outside x86
+RdCullPath FrustumCullBestPath();
+bool FrustumCullSupported(RdCullPath p_path);
+const char* FrustumCullPathName(RdCullPath p_path);
+
+void FrustumCull(
+		RdCullPath p_path,
+		const RdFrustum& p_frustum,
+		const RdAabbSoA& p_boxes,
+		size_t p_begin,
+		size_t p_end,
+		const uint32_t* p_ids,
+		std::vector<uint32_t>& p_visible
+);
@@ -0,0 +1,131 @@
+#include "Scene.hpp"
+
+#include "tracy/Tracy.hpp"
+
+#include <algorithm>
+
+uint32_t RdScene::Add(
+		uint32_t p_parent,
+		const glm::vec3& p_position,
+		const glm::quat& p_rotation,
+		float p_scale,
+		float p_spin,
+		const glm::vec4& p_color
+) {
+	uint32_t index = static_cast<uint32_t>(parents.size());
+	parents.push_back(p_parent);
+	positions.push_back(p_position);
+	rotations.push_back(p_rotation);
+	scales.push_back(p_scale);
+	spins.push_back(p_spin);
+	colors.push_back(p_color);
+	m_depths.push_back(p_parent == NO_PARENT ? 0 : m_depths[p_parent] + 1);
+	m_levelsDirty = true;
+	return index;
+}
+
+void RdScene::Clear() {
+	parents.clear();
+	positions.clear();
+	rotations.clear();
+	scales.clear();
+	spins.clear();
+	colors.clear();
+	m_depths.clear();
+	m_levelsDirty = true;
+}
+
+void RdScene::Reserve(size_t p_count) {
+	parents.reserve(p_count);
+	positions.reserve(p_count);
+	rotations.reserve(p_count);
+	scales.reserve(p_count);
+	spins.reserve(p_count);
+	colors.reserve(p_count);
+	m_depths.reserve(p_count);
+}
+
+size_t RdScene::Size() const {
+	return parents.size();
+}
+
+// @brief Counting sort of the entities by depth, stable so each level keeps walking memory forwards
+void RdScene::LevelsBuild() {
+	ZoneScoped;
+	uint32_t levels = m_depths.empty() ? 0 : *std::max_element(m_depths.begin(), m_depths.end()) + 1;
+	m_levelEnds.assign(levels, 0);
+	for (uint32_t depth : m_depths) {
+		++m_levelEnds[depth];
+	}
+	for (size_t level = 1; level < levels; ++level) {
+		m_levelEnds[level] += m_levelEnds[level - 1];
+	}
+
+	std::vector<size_t> cursor(levels, 0);
+	for (size_t level = 1; level < levels; ++level) {
+		cursor[level] = m_levelEnds[level - 1];
+	}
+	m_levelOrder.resize(m_depths.size());
+	for (uint32_t i = 0; i < m_depths.size(); ++i) {
+		m_levelOrder[cursor[m_depths[i]]++] = i;
+	}
+
+	worldPositions.resize(m_depths.size());
+	worldRotations.resize(m_depths.size());
+	worldScales.resize(m_depths.size());
+	m_levelsDirty = false;
+}
+
+void RdScene::Update(float p_time, float p_radius, RdJobSystem& p_jobs, Instance* p_instances, RdAabbSoA* p_bounds) {
+	ZoneScoped;
+	if (m_levelsDirty) {
+		LevelsBuild();
+	}
+
+	// Parents are final before the level of their children starts.
+	size_t levelBegin = 0;
+	for (size_t levelEnd : m_levelEnds) {
+		const uint32_t* entities = m_levelOrder.data() + levelBegin;
+		p_jobs.ParallelFor(levelEnd - levelBegin, BATCH_SIZE, [&](size_t p_begin, size_t p_end) {
+			Compose(entities + p_begin, p_end - p_begin, p_time, p_radius, p_instances, p_bounds);
+		});
+		levelBegin = levelEnd;
+	}
+}
+
+void RdScene::Compose(
+		const uint32_t* p_entities,
+		size_t p_count,
+		float p_time,
+		float p_radius,
+		Instance* p_instances,
+		RdAabbSoA* p_bounds
+) {
+	for (size_t k = 0; k < p_count; ++k) {
+		uint32_t i = p_entities[k];
+		glm::quat rotation = rotations[i] * glm::angleAxis(spins[i] * p_time, glm::vec3(0.0f, 0.0f, 1.0f));
+
+		glm::vec3 position = positions[i];
+		float scale = scales[i];
+		uint32_t parent = parents[i];
+		if (parent != NO_PARENT) {
+			position = worldPositions[parent] + worldRotations[parent] * (position * worldScales[parent]);
+			rotation = worldRotations[parent] * rotation;
+			scale *= worldScales[parent];
+		}
+		worldPositions[i] = position;
+		worldRotations[i] = rotation;
+		worldScales[i] = scale;
+
+		p_instances[i] = {
+			.position = position,
+			.scale = scale,
+			.rotation = glm::vec4(rotation.x, rotation.y, rotation.z, rotation.w),
+			.color = colors[i],
+		};
+		if (p_bounds != nullptr) {
+			glm::vec3 extent = glm::vec3(p_radius * scale);
+			p_bounds->Set(i, { .min = position - extent, .max = position + extent });
+		}
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Aabb.hpp"
+#include "../jobs/JobSystem.hpp"
+#include "../renderer/Vertex.hpp"
+
+#include <glm.hpp>
+#include <gtc/quaternion.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// @brief Entity transforms, parents and bounds kept one field per array.
+// Every frame Update() composes local transforms with their parents level by level, each level split into jobs,
+// and writes the results straight into instance memory, so no pass ever follows a pointer.
+// Entity i draws instance i, parents have to be added before their children.
+struct RdScene {
+	static constexpr uint32_t NO_PARENT = UINT32_MAX;
+	// Entities one job updates.
+	static constexpr size_t BATCH_SIZE = 4096;
+
+	uint32_t Add(
+			uint32_t p_parent,
+			const glm::vec3& p_position,
+			const glm::quat& p_rotation,
+			float p_scale,
+			float p_spin,
+			const glm::vec4& p_color
+	);
+	void Clear();
+	void Reserve(size_t p_count);
+	size_t Size() const;
+
+	// @brief World transforms at p_time, written to p_instances and, when given, as world bounds of a sphere
+	// of p_radius around each entity into p_bounds
+	void Update(float p_time, float p_radius, RdJobSystem& p_jobs, Instance* p_instances, RdAabbSoA* p_bounds);
+
+	// Local state, relative to the parent.
+	std::vector<uint32_t> parents;
+	std::vector<glm::vec3> positions;
+	std::vector<glm::quat> rotations;
+	std::vector<float> scales;
+	// Rotation about the local z axis in radians per second.
+	std::vector<float> spins;
+	std::vector<glm::vec4> colors;
+
+	// Results of the last Update().
+	std::vector<glm::vec3> worldPositions;
+	std::vector<glm::quat> worldRotations;
+	std::vector<float> worldScales;
+
+private:
+	void LevelsBuild();
+	void Compose(const uint32_t* p_entities, size_t p_count, float p_time, float p_radius, Instance* p_instances,
+				 RdAabbSoA* p_bounds);
+
+	// Entities sorted by depth, level l spans [m_levelEnds[l - 1], m_levelEnds[l]) of m_levelOrder.
+	std::vector<uint32_t> m_depths;
+	std::vector<uint32_t> m_levelOrder;
+	std::vector<size_t> m_levelEnds;
+	bool m_levelsDirty = true;
+};
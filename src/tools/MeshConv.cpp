@@ -0,0 +1,59 @@
+#include "../asset/GeometryImport.hpp"
+#include "../asset/MeshFile.hpp"
+#include "../asset/MeshOptimize.hpp"
+#include "logging_macros.h"
+#include "tracy/Tracy.hpp"
+
+#include <cstring>
+#include <vector>
+
+// Offline converter from the `[points]`/`[indices]` text format, Wavefront OBJ or glTF 2.0 to the binary .rdmesh
+// container, see GeometryImport.hpp.
+// Meshes are optimized for the vertex cache, overdraw and vertex fetch on the way, see MeshOptimize.hpp, and get
+// their chain of simplified levels, see MeshLod.hpp.
+//
+// Usage: meshconv [--no-optimize] [--no-overdraw] [--no-lod] <input.txt|.obj|.gltf|.glb> <output.rdmesh>
+int main(int argc, char** argv) {
+	bool optimize = true;
+	bool lod = true;
+	RdMeshOptimizeOptions options;
+	int argi = 1;
+	for (; argi < argc && strncmp(argv[argi], "--", 2) == 0; ++argi) {
+		if (strcmp(argv[argi], "--no-optimize") == 0) {
+			optimize = false;
+		} else if (strcmp(argv[argi], "--no-overdraw") == 0) {
+			options.overdraw = false;
+		} else if (strcmp(argv[argi], "--no-lod") == 0) {
+			lod = false;
+		} else {
+			LOG_WARN("Ignoring unknown argument: %s", argv[argi]);
+		}
+	}
+	if (argc - argi != 2) {
+		LOG_ERROR("Usage: %s [--no-optimize] [--no-overdraw] [--no-lod] <input.txt|.obj|.gltf|.glb> <output.rdmesh>", argv[0]);
+		return 1;
+	}
+	const char* inputPath = argv[argi];
+	const char* outputPath = argv[argi + 1];
+
+	std::vector<Vertex> vertices;
+	std::vector<uint32_t> indices;
+	if (!GeometryImport(inputPath, vertices, indices)) {
+		LOG_ERROR("Failed to read %s", inputPath);
+		return 1;
+	}
+	if (optimize) {
+		MeshOptimize(vertices, indices, options);
+	}
+	std::vector<RdMeshLod> lods = { { 0, static_cast<uint32_t>(indices.size()), 0.0f } };
+	if (lod) {
+		lods = MeshLodChainBuild(vertices, indices);
+	}
+
+	RdIndexData indexData = IndexDataPack(indices);
+	LOG_INFO("Index format: %u-bit", static_cast<uint32_t>(indexData.format) * 8);
+	if (!MeshFileWrite(outputPath, vertices, indexData, lods)) {
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,484 @@
+#pragma once
+
+#include "tracy/Tracy.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+// ~~~~~~~~~~~~~
+// Asynchronous backend of the LOG_* macros. A call site only copies its arguments into a ring owned by the calling
+// thread, a logger thread formats them, sends them to Tracy and writes them out. Strings are copied, everything
+// else is passed to printf as it was. Records of one thread keep their order. Across threads they are ordered by
+// timestamp within each flush of the logger thread only: a record published after its ring was drained goes out
+// with the next flush, after newer records of other threads.
+// ~~~~~~~~~~~~~
+
+enum LogLevel {
+    LL_NONE = 0,
+    LL_ERROR,
+    LL_WARN,
+    LL_INFO,
+    LL_TRACE
+};
+
+// Human-readable strings for log levels (must match enum order).
+inline const char *LOG_LEVEL_STR[] = {
+    "NONE",
+    "ERROR",
+    "WARN",
+    "INFO",
+    "TRACE"
+};
+
+// ANSI colors per level (must match enum order).
+inline const char *LOG_COLORS[] = {
+    "\033[0m",     // LL_NONE  - no color
+    "\033[0;31m",  // LL_ERROR - red
+    "\033[0;33m",  // LL_WARN  - yellow
+    "\033[0;37m",  // LL_INFO  - white
+    "\033[0;90m",  // LL_TRACE - gray
+};
+inline const char *RESET_COLOR = "\033[0m";
+
+// Formatted messages are cut to this length, like the stack buffer the macros used to format into.
+inline constexpr size_t RD_LOG_MESSAGE_SIZE = 1024;
+// Per thread, a power of two. A full ring drops new records, errors and warnings wait for room instead.
+inline constexpr size_t RD_LOG_RING_CAPACITY = 256 << 10;
+
+// Everything known about a LOG_* call at compile time.
+struct RdLogSite {
+	int level;
+	const char* file;
+	int line;
+	const char* function;
+	const char* format;
+};
+
+// Formats the arguments a record carries, one instantiation per argument list.
+using RdLogFormatFn = int (*)(const RdLogSite& p_site, const std::byte* p_args, char* out, size_t p_size);
+
+// A record in a ring: this header, then the arguments, padded to RD_LOG_ALIGNMENT. A zero size marks the unused
+// end of the ring the next record wrapped around.
+struct RdLogRecord {
+	uint32_t size;
+	uint32_t padding;
+	uint64_t timestamp;
+	const RdLogSite* site;
+	FILE* stream;
+	RdLogFormatFn format;
+};
+inline constexpr size_t RD_LOG_ALIGNMENT = alignof(RdLogRecord);
+
+// ~~~~~~~~~~~~~
+// Arguments: strings are stored as a length and their characters up to the message size, anything else by value.
+// ~~~~~~~~~~~~~
+template <typename T>
+inline constexpr bool RD_LOG_IS_STRING = std::is_same_v<std::decay_t<T>, const char*> || std::is_same_v<std::decay_t<T>, char*>;
+
+// What an argument is stored as and read back as.
+template <typename T>
+using RdLogStored = std::conditional_t<RD_LOG_IS_STRING<T>, const char*, std::decay_t<T>>;
+
+// @brief A string argument as it is stored, char arrays included
+inline const char* RdLogString(const char* p_string) {
+	return p_string != nullptr ? p_string : "(null)";
+}
+
+template <typename T>
+size_t RdLogArgSize(const T& p_value) {
+	if constexpr (RD_LOG_IS_STRING<T>) {
+		return sizeof(uint32_t) + strnlen(RdLogString(p_value), RD_LOG_MESSAGE_SIZE) + 1;
+	} else {
+		static_assert(std::is_trivially_copyable_v<T>, "Log arguments have to be printf arguments");
+		return sizeof(T);
+	}
+}
+
+template <typename T>
+void RdLogArgWrite(std::byte*& p_cursor, const T& p_value) {
+	if constexpr (RD_LOG_IS_STRING<T>) {
+		const char* string = RdLogString(p_value);
+		uint32_t length = static_cast<uint32_t>(strnlen(string, RD_LOG_MESSAGE_SIZE));
+		std::memcpy(p_cursor, &length, sizeof(length));
+		std::memcpy(p_cursor + sizeof(length), string, length);
+		p_cursor[sizeof(length) + length] = std::byte{ 0 };
+		p_cursor += sizeof(length) + length + 1;
+	} else {
+		std::memcpy(p_cursor, &p_value, sizeof(T));
+		p_cursor += sizeof(T);
+	}
+}
+
+template <typename T>
+T RdLogArgRead(const std::byte*& p_cursor) {
+	if constexpr (std::is_same_v<T, const char*>) {
+		// Points into the ring, the record is released once it is formatted.
+		uint32_t length;
+		std::memcpy(&length, p_cursor, sizeof(length));
+		const char* string = reinterpret_cast<const char*>(p_cursor + sizeof(length));
+		p_cursor += sizeof(length) + length + 1;
+		return string;
+	} else {
+		T value;
+		std::memcpy(&value, p_cursor, sizeof(T));
+		p_cursor += sizeof(T);
+		return value;
+	}
+}
+
+// printf takes the format of the call site at run time here. The trailing 0 keeps formats without arguments from
+// being mistaken for a format injection, printf ignores arguments past the ones the format uses.
+template <typename... Stored>
+int RdLogFormat(const RdLogSite& p_site, [[maybe_unused]] const std::byte* p_args, char* out, size_t p_size) {
+	// Braced initialization reads the arguments in order.
+	std::tuple<Stored...> values{ RdLogArgRead<Stored>(p_args)... };
+	return std::apply(
+			[&](auto... p_values) { return std::snprintf(out, p_size, p_site.format, p_values..., 0); }, values
+	);
+}
+
+// Only checks the format against the arguments, at compile time.
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((format(printf, 1, 2)))
+#endif
+inline void RdLogFormatCheck(const char*, ...) {}
+
+// ~~~~~~~~~~~~~
+// Rings
+// ~~~~~~~~~~~~~
+
+// @brief Single-producer single-consumer byte ring: the owning thread reserves and publishes records, the logger
+// thread reads and releases them. Positions only grow, the offset in data is the position modulo the capacity.
+struct RdLogRing {
+	// @brief Owner only, room for p_size bytes or nullptr when the logger thread has not caught up yet
+	std::byte* Reserve(size_t p_size) {
+		uint64_t head = m_head.load(std::memory_order_relaxed);
+		size_t offset = static_cast<size_t>(head & (RD_LOG_RING_CAPACITY - 1));
+		// A record never wraps, the rest of the ring is skipped instead.
+		size_t skip = offset + p_size > RD_LOG_RING_CAPACITY ? RD_LOG_RING_CAPACITY - offset : 0;
+		if (head + skip + p_size - m_cachedTail > RD_LOG_RING_CAPACITY) {
+			m_cachedTail = m_tail.load(std::memory_order_acquire);
+			if (head + skip + p_size - m_cachedTail > RD_LOG_RING_CAPACITY) {
+				return nullptr;
+			}
+		}
+		if (skip > 0) {
+			uint32_t wrap = 0;
+			std::memcpy(data + offset, &wrap, sizeof(wrap));
+			m_reservedSkip = skip;
+			return data;
+		}
+		m_reservedSkip = 0;
+		return data + offset;
+	}
+
+	// @brief Owner only, hand the reserved record to the logger thread
+	void Publish(size_t p_size) {
+		m_head.store(m_head.load(std::memory_order_relaxed) + m_reservedSkip + p_size, std::memory_order_release);
+	}
+
+	// @brief Logger thread, call p_onRecord for every published record and release them
+	template <typename F>
+	size_t Drain(F&& p_onRecord) {
+		uint64_t head = m_head.load(std::memory_order_acquire);
+		uint64_t tail = m_tail.load(std::memory_order_relaxed);
+		size_t count = 0;
+		while (tail < head) {
+			size_t offset = static_cast<size_t>(tail & (RD_LOG_RING_CAPACITY - 1));
+			uint32_t size;
+			std::memcpy(&size, data + offset, sizeof(size));
+			if (size == 0) {
+				tail += RD_LOG_RING_CAPACITY - offset;
+				continue;
+			}
+			p_onRecord(data + offset);
+			tail += size;
+			count++;
+		}
+		m_tail.store(tail, std::memory_order_release);
+		return count;
+	}
+
+	bool Empty() const {
+		return m_tail.load(std::memory_order_acquire) == m_head.load(std::memory_order_acquire);
+	}
+
+	// Set when the owning thread exits, the logger thread frees the ring once it is drained.
+	std::atomic<bool> retired = false;
+
+private:
+	alignas(64) std::atomic<uint64_t> m_head = 0;
+	uint64_t m_cachedTail = 0;
+	size_t m_reservedSkip = 0;
+	alignas(64) std::atomic<uint64_t> m_tail = 0;
+
+public:
+	alignas(64) std::byte data[RD_LOG_RING_CAPACITY];
+};
+
+// ~~~~~~~~~~~~~
+// Backend
+// ~~~~~~~~~~~~~
+struct RdLogBackend {
+	static RdLogBackend& Get() {
+		// Never destroyed: threads may log until the process exits, after Stop they write synchronously.
+		static RdLogBackend* backend = []() {
+			auto* created = new RdLogBackend();
+			std::atexit([]() { Get().Stop(); });
+			return created;
+		}();
+		return *backend;
+	}
+
+	// @brief The ring of the calling thread, created on its first log call
+	RdLogRing* ThreadRing() {
+		struct Owner {
+			RdLogRing* ring = nullptr;
+			~Owner() {
+				if (ring != nullptr) {
+					ring->retired.store(true, std::memory_order_release);
+				}
+			}
+		};
+		thread_local Owner owner;
+		if (owner.ring == nullptr) {
+			owner.ring = new RdLogRing();
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_rings.push_back(owner.ring);
+		}
+		return owner.ring;
+	}
+
+	bool Running() const {
+		return m_running.load(std::memory_order_relaxed);
+	}
+
+	// @brief Wake the logger thread ahead of its next poll, for errors and filling rings
+	void Wake() {
+		m_wake.notify_one();
+	}
+
+	void Dropped() {
+		m_dropped.fetch_add(1, std::memory_order_relaxed);
+		m_droppedTotal.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	// @brief Records dropped on full rings since the start
+	uint64_t DroppedCount() const {
+		return m_droppedTotal.load(std::memory_order_relaxed);
+	}
+
+	// @brief Block until every record logged before the call is written
+	void Flush() {
+		if (!Running()) {
+			return;
+		}
+		std::unique_lock<std::mutex> lock(m_mutex);
+		uint64_t ticket = ++m_flushRequested;
+		m_wake.notify_one();
+		m_flushed.wait(lock, [this, ticket]() { return m_flushCompleted >= ticket || !Running(); });
+	}
+
+	// @brief Write what is left and log synchronously from now on
+	void Stop() {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (!m_running) {
+				return;
+			}
+			m_running = false;
+		}
+		m_wake.notify_one();
+		if (m_thread.joinable()) {
+			m_thread.join();
+		}
+		Drain();
+		m_flushed.notify_all();
+	}
+
+	// @brief Format one message and write it, the format and output of every path
+	static void Write(const RdLogSite& p_site, FILE* p_stream, const char* p_message, std::string* p_batch) {
+		TracyMessage(p_message, strlen(p_message));
+		char line[RD_LOG_MESSAGE_SIZE + 256];
+		int length = std::snprintf(line, sizeof(line), "%s[%s:%d %s()][%s]%s %s\n", LOG_COLORS[p_site.level], p_site.file,
+								   p_site.line, p_site.function, LOG_LEVEL_STR[p_site.level], RESET_COLOR, p_message);
+		size_t written = std::min(static_cast<size_t>(std::max(length, 0)), sizeof(line) - 1);
+		if (p_batch != nullptr) {
+			p_batch->append(line, written);
+		} else {
+			std::fwrite(line, 1, written, p_stream);
+		}
+	}
+
+private:
+	// Poll period of the logger thread, the latest a record shows up when nothing wakes it.
+	static constexpr std::chrono::milliseconds POLL_PERIOD{ 5 };
+
+	struct Pending {
+		uint64_t timestamp;
+		FILE* stream;
+		size_t begin;
+		size_t end;
+	};
+
+	RdLogBackend() {
+#ifndef __EMSCRIPTEN__
+		m_running = true;
+		m_thread = std::thread(&RdLogBackend::Worker, this);
+#endif	// __EMSCRIPTEN__
+	}
+
+	void Worker() {
+		tracy::SetThreadName("Logger");
+		for (;;) {
+			uint64_t ticket = 0;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_wake.wait_for(lock, POLL_PERIOD);
+				ticket = m_flushRequested;
+				if (!m_running) {
+					return;
+				}
+			}
+			Drain();
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_flushCompleted = std::max(m_flushCompleted, ticket);
+			}
+			m_flushed.notify_all();
+		}
+	}
+
+	// @brief Format the records of every ring, write them by timestamp and free the rings of exited threads
+	void Drain() {
+		ZoneScoped;
+		std::vector<RdLogRing*> rings;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			rings = m_rings;
+		}
+
+		m_text.clear();
+		m_pending.clear();
+		char message[RD_LOG_MESSAGE_SIZE];
+		for (RdLogRing* ring : rings) {
+			// Read before draining, a ring retired before its last records were drained is kept for one more pass.
+			bool retired = ring->retired.load(std::memory_order_acquire);
+			ring->Drain([&](const std::byte* p_record) {
+				RdLogRecord record;
+				std::memcpy(&record, p_record, sizeof(record));
+				record.format(*record.site, p_record + sizeof(RdLogRecord), message, sizeof(message));
+				size_t begin = m_text.size();
+				Write(*record.site, record.stream, message, &m_text);
+				m_pending.push_back({ record.timestamp, record.stream, begin, m_text.size() });
+			});
+			if (retired && ring->Empty()) {
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_rings.erase(std::find(m_rings.begin(), m_rings.end(), ring));
+				delete ring;
+			}
+		}
+
+		// Orders this pass only, records published after their ring was drained come with the next one.
+		std::stable_sort(m_pending.begin(), m_pending.end(), [](const Pending& a, const Pending& b) {
+			return a.timestamp < b.timestamp;
+		});
+		m_streams.clear();
+		for (const Pending& pending : m_pending) {
+			std::fwrite(m_text.data() + pending.begin, 1, pending.end - pending.begin, pending.stream);
+			if (std::find(m_streams.begin(), m_streams.end(), pending.stream) == m_streams.end()) {
+				m_streams.push_back(pending.stream);
+			}
+		}
+		for (FILE* stream : m_streams) {
+			std::fflush(stream);
+		}
+
+		uint64_t dropped = m_dropped.exchange(0, std::memory_order_relaxed);
+		if (dropped > 0) {
+			std::fprintf(stdout, "%s[Logger][WARN]%s %llu messages dropped, their threads outpaced the output\n",
+						 LOG_COLORS[LL_WARN], RESET_COLOR, static_cast<unsigned long long>(dropped));
+		}
+	}
+
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::condition_variable m_flushed;
+	std::atomic<bool> m_running = false;
+	uint64_t m_flushRequested = 0;
+	uint64_t m_flushCompleted = 0;
+	std::vector<RdLogRing*> m_rings;
+	std::atomic<uint64_t> m_dropped = 0;
+	std::atomic<uint64_t> m_droppedTotal = 0;
+	// Logger thread only.
+	std::string m_text;
+	std::vector<Pending> m_pending;
+	std::vector<FILE*> m_streams;
+};
+
+// @brief Everything a LOG_* call does at run time: copy the arguments into the ring of the calling thread, or
+// format and write right away when there is no logger thread
+template <typename... Args>
+void RdLogWrite(const RdLogSite& p_site, FILE* p_stream, const Args&... p_args) {
+	RdLogBackend& backend = RdLogBackend::Get();
+	size_t size = sizeof(RdLogRecord) + (size_t(0) + ... + RdLogArgSize(p_args));
+	size = (size + RD_LOG_ALIGNMENT - 1) & ~(RD_LOG_ALIGNMENT - 1);
+
+	// Records hold a fraction of a ring at most, only a call with several long strings goes past that.
+	if (backend.Running() && size <= RD_LOG_RING_CAPACITY / 4) {
+		RdLogRing* ring = backend.ThreadRing();
+		std::byte* out = ring->Reserve(size);
+		// Errors and warnings are not dropped, they wait for the logger thread to make room.
+		while (out == nullptr && p_site.level <= LL_WARN && backend.Running()) {
+			backend.Wake();
+			std::this_thread::yield();
+			out = ring->Reserve(size);
+		}
+		if (out == nullptr) {
+			backend.Dropped();
+			backend.Wake();
+			return;
+		}
+
+		RdLogRecord record = {
+			.size = static_cast<uint32_t>(size),
+			.padding = 0,
+			.timestamp = static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()),
+			.site = &p_site,
+			.stream = p_stream,
+			.format = &RdLogFormat<RdLogStored<Args>...>,
+		};
+		std::memcpy(out, &record, sizeof(record));
+		[[maybe_unused]] std::byte* cursor = out + sizeof(record);
+		(RdLogArgWrite(cursor, p_args), ...);
+		ring->Publish(size);
+		if (p_site.level <= LL_ERROR) {
+			backend.Wake();
+		}
+		return;
+	}
+
+	char message[RD_LOG_MESSAGE_SIZE];
+	std::snprintf(message, sizeof(message), p_site.format, static_cast<RdLogStored<Args>>(p_args)..., 0);
+	RdLogBackend::Write(p_site, p_stream, message, nullptr);
+}
+
+// @brief Block until everything logged so far is written, before handing stdout to something else or crashing on
+// purpose
+inline void RdLogFlush() {
+	RdLogBackend::Get().Flush();
+}
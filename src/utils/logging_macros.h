@@ -1,28 +1,20 @@
 #pragma once
 
+#include "LogBackend.hpp"
+
 #include <cstdio>
-#include <cstdarg>
-#include <cstring>
 
 // ---------------------------------------------------------------------
-// Log Levels
+// Compile-time minimum level: calls above it compile to nothing, their
+// arguments are still type checked. Release builds drop LL_TRACE.
 // ---------------------------------------------------------------------
-enum LogLevel {
-    LL_NONE = 0,
-    LL_ERROR,
-    LL_WARN,
-    LL_INFO,
-    LL_TRACE
-};
-
-// Human-readable strings for log levels (must match enum order).
-static const char *LOG_LEVEL_STR[] = {
-    "NONE",
-    "ERROR",
-    "WARN",
-    "INFO",
-    "TRACE"
-};
+#ifndef LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define LOG_MIN_LEVEL LL_INFO
+#else
+#define LOG_MIN_LEVEL LL_TRACE
+#endif
+#endif
 
 // ---------------------------------------------------------------------
 // Logger struct (holds output stream & minimum level)
@@ -32,26 +24,14 @@ struct Logger {
     int  level;    // e.g., LL_INFO, LL_WARN, etc.
 };
 
-// Default logger instance: writes to stdout at LL_TRACE level.
-static Logger DEFAULT_LOGGER = { stdout, LL_TRACE };
+// Default logger instance: writes to stdout at LL_TRACE level, shared by every translation unit.
+inline Logger DEFAULT_LOGGER = { stdout, LL_TRACE };
 
 // Helper: set the level of the default logger at runtime.
 inline void setLogLevel(int level) {
     DEFAULT_LOGGER.level = level;
 }
 
-// ---------------------------------------------------------------------
-// Optional ANSI color codes (customize as you like)
-// ---------------------------------------------------------------------
-static const char *LOG_COLORS[] = {
-    "\033[0m",     // LL_NONE  - no color
-    "\033[0;31m",  // LL_ERROR - red
-    "\033[0;33m",  // LL_WARN  - yellow
-    "\033[0;37m",  // LL_INFO  - white
-    "\033[0;90m",  // LL_TRACE - gray
-};
-static const char *RESET_COLOR = "\033[0m";
-
 // ---------------------------------------------------------------------
 // Macros for Logging
 // ---------------------------------------------------------------------
@@ -74,17 +54,19 @@ static const char *RESET_COLOR = "\033[0m";
 
 #else
 
+// Only the arguments are copied on the calling thread, formatting and output
+// happen on the logger thread, see LogBackend.hpp.
 #define LOG(logger, logLevel, fmt, ...)                                           \
     do {                                                                        \
-        if ((logLevel) <= (logger).level) {                                     \
-            constexpr int BUF_SIZE = 1024;                                      \
-            char _log_buf[BUF_SIZE];                                            \
-            std::snprintf(_log_buf, BUF_SIZE, fmt __VA_OPT__(, __VA_ARGS__));     \
-            TracyMessage(_log_buf, strlen(_log_buf));  /* Send message to Tracy */\
-            std::fprintf((logger).stream,                                     \
-                         "%s[%s:%d %s()][%s]%s %s\n",                         \
-                         LOG_COLORS[logLevel], __FILE__, __LINE__, __func__,    \
-                         LOG_LEVEL_STR[logLevel], RESET_COLOR, _log_buf);        \
+        if constexpr ((logLevel) <= LOG_MIN_LEVEL) {                            \
+            if ((logLevel) <= (logger).level) {                                 \
+                static constexpr RdLogSite _log_site = {                        \
+                    logLevel, __FILE__, __LINE__, __func__, fmt };              \
+                RdLogWrite(_log_site, (logger).stream __VA_OPT__(, __VA_ARGS__)); \
+            }                                                                   \
+            if (false) {                                                        \
+                RdLogFormatCheck(fmt __VA_OPT__(, __VA_ARGS__));                \
+            }                                                                   \
         }                                                                       \
     } while (0)
 